@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+
+namespace test_util
+{
+
+/**
+ * @brief   Initializes and runs the registered benchmarks.
+ *
+ * @details If the SPACE_BENCHMARK_RESULTS_DIR environment variable is set, the results are
+ *          also written as JSON to <dir>/<executable name>.json, which is the input of the
+ *          compareBenchmarks tool. The explicit --benchmark_out arguments take precedence.
+ *
+ * @return  The exit code of the benchmark executable.
+ */
+inline int runBenchmarks(int argc, char** argv)
+{
+    std::vector<std::string> arguments {argv, std::next(argv, argc)};
+    if (const auto* dir = std::getenv("SPACE_BENCHMARK_RESULTS_DIR"); nullptr != dir && 0 < argc)
+    {
+        std::filesystem::create_directories(dir);
+        const auto path = std::filesystem::path {dir} / std::filesystem::path {argv[0]}.filename();
+        arguments.insert(std::next(std::begin(arguments)), {"--benchmark_out=" + path.string() + ".json"
+                                                             , "--benchmark_out_format=json"});
+    }
+
+    std::vector<char*> pointers;
+    for (auto& argument : arguments)
+    {
+        pointers.push_back(argument.data());
+    }
+    auto count = static_cast<int>(std::size(pointers));
+    ::benchmark::Initialize(&count, pointers.data());
+    if (::benchmark::ReportUnrecognizedArguments(count, pointers.data()))
+    {
+        return 1;
+    }
+    ::benchmark::RunSpecifiedBenchmarks();
+    ::benchmark::Shutdown();
+    return 0;
+}
+
+}
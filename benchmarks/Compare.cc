@@ -0,0 +1,549 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace test_util
+{
+
+/**
+ * @brief   The parsed JSON value, only what is needed to read the benchmark results.
+ */
+struct JsonValue
+{
+    enum class Kind
+    {
+        Null
+        , Bool
+        , Number
+        , String
+        , Array
+        , Object
+    };
+
+    Kind kind {Kind::Null};
+    bool boolean {false};
+    double number {0.0};
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    [[nodiscard]]
+    const JsonValue* find(std::string_view key) const noexcept
+    {
+        const auto it = std::ranges::find_if(object, [key](const auto& member) { return member.first == key; });
+        return std::end(object) == it ? nullptr : &it->second;
+    }
+};
+
+/**
+ * @brief   The recursive descent JSON parser.
+ */
+class JsonParser
+{
+public:
+    explicit JsonParser(std::string_view text)
+        : m_text {text}
+    {
+    }
+
+    /**
+     * @brief   Parses the whole text.
+     *
+     * @throws  std::runtime_error if the text is not the valid JSON.
+     */
+    JsonValue parse()
+    {
+        auto value = parseValue();
+        skipSpaces();
+        if (m_pos != std::size(m_text))
+        {
+            fail("unexpected trailing characters");
+        }
+        return value;
+    }
+
+private:
+
+    [[noreturn]]
+    void fail(std::string_view message) const
+    {
+        throw std::runtime_error {"JSON error at " + std::to_string(m_pos) + ": " + std::string {message}};
+    }
+
+    void skipSpaces() noexcept
+    {
+        while (m_pos < std::size(m_text) && 0 != std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+        {
+            ++m_pos;
+        }
+    }
+
+    char peek()
+    {
+        skipSpaces();
+        if (m_pos == std::size(m_text))
+        {
+            fail("unexpected end of data");
+        }
+        return m_text[m_pos];
+    }
+
+    void expect(char c)
+    {
+        if (peek() != c)
+        {
+            fail(std::string {"expected '"} + c + "'");
+        }
+        ++m_pos;
+    }
+
+    bool consumeWord(std::string_view word) noexcept
+    {
+        if (m_text.substr(m_pos, std::size(word)) != word)
+        {
+            return false;
+        }
+        m_pos += std::size(word);
+        return true;
+    }
+
+    JsonValue parseValue()
+    {
+        JsonValue value;
+        switch (peek())
+        {
+            case '{':
+                value.kind = JsonValue::Kind::Object;
+                ++m_pos;
+                if ('}' != peek())
+                {
+                    do
+                    {
+                        auto key = parseString();
+                        expect(':');
+                        value.object.emplace_back(std::move(key), parseValue());
+                    }
+                    while (consume(','));
+                }
+                expect('}');
+                break;
+            case '[':
+                value.kind = JsonValue::Kind::Array;
+                ++m_pos;
+                if (']' != peek())
+                {
+                    do
+                    {
+                        value.array.push_back(parseValue());
+                    }
+                    while (consume(','));
+                }
+                expect(']');
+                break;
+            case '"':
+                value.kind = JsonValue::Kind::String;
+                value.string = parseString();
+                break;
+            default:
+                if (consumeWord("null"))
+                {
+                    break;
+                }
+                if (consumeWord("true") || consumeWord("false"))
+                {
+                    value.kind = JsonValue::Kind::Bool;
+                    value.boolean = 'u' == m_text[m_pos - 2];
+                    break;
+                }
+                value.kind = JsonValue::Kind::Number;
+                value.number = parseNumber();
+                break;
+        }
+        return value;
+    }
+
+    bool consume(char c)
+    {
+        if (peek() != c)
+        {
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+
+    std::string parseString()
+    {
+        expect('"');
+        std::string result;
+        while (m_pos < std::size(m_text) && '"' != m_text[m_pos])
+        {
+            auto c = m_text[m_pos++];
+            if ('\\' == c && m_pos < std::size(m_text))
+            {
+                // The benchmark names are ASCII, the unicode escapes are kept as they are.
+                switch (c = m_text[m_pos++])
+                {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'u': result += "\\"; break;
+                    default: break;
+                }
+            }
+            result += c;
+        }
+        expect('"');
+        return result;
+    }
+
+    double parseNumber()
+    {
+        const auto begin = m_pos;
+        while (m_pos < std::size(m_text) && std::string_view {"+-0123456789.eE"}.find(m_text[m_pos]) != std::string_view::npos)
+        {
+            ++m_pos;
+        }
+        if (begin == m_pos)
+        {
+            fail("unexpected character");
+        }
+        return std::stod(std::string {m_text.substr(begin, m_pos - begin)});
+    }
+
+private:
+    std::string_view m_text;
+    std::size_t m_pos {0};
+};
+
+/**
+ * @brief   The result of the two-sided Mann-Whitney U test.
+ */
+struct MannWhitneyResult
+{
+    double u;
+    double pValue;
+};
+
+/**
+ * @brief   Computes the two-sided Mann-Whitney U test of two samples.
+ *
+ * @details The exact distribution of U is used for the small samples without ties, otherwise
+ *          the normal approximation with the tie and continuity corrections.
+ */
+inline MannWhitneyResult mannWhitneyU(const std::vector<double>& first, const std::vector<double>& second)
+{
+    static constexpr std::size_t s_maxExactSize = 20;
+
+    const auto n1 = std::size(first);
+    const auto n2 = std::size(second);
+    std::vector<std::pair<double, bool>> all;
+    for (const auto value : first)
+    {
+        all.emplace_back(value, true);
+    }
+    for (const auto value : second)
+    {
+        all.emplace_back(value, false);
+    }
+    std::ranges::sort(all, {}, &std::pair<double, bool>::first);
+
+    // The tied values get the average rank.
+    double firstRankSum = 0.0;
+    double tieCorrection = 0.0;
+    for (std::size_t i = 0; i < std::size(all);)
+    {
+        auto j = i;
+        while (j < std::size(all) && all[j].first == all[i].first)
+        {
+            ++j;
+        }
+        const auto rank = static_cast<double>(i + j + 1) / 2.0;
+        for (auto k = i; k < j; ++k)
+        {
+            firstRankSum += all[k].second ? rank : 0.0;
+        }
+        const auto tied = static_cast<double>(j - i);
+        tieCorrection += tied * tied * tied - tied;
+        i = j;
+    }
+
+    const auto size1 = static_cast<double>(n1);
+    const auto size2 = static_cast<double>(n2);
+    const auto u = firstRankSum - size1 * (size1 + 1.0) / 2.0;
+
+    if (0.0 == tieCorrection && n1 <= s_maxExactSize && n2 <= s_maxExactSize)
+    {
+        // counts[i][j][k]: the number of orderings of i and j values with U = k.
+        const auto maxU = n1 * n2;
+        std::vector<std::vector<std::vector<double>>> counts(
+            n1 + 1, std::vector<std::vector<double>>(n2 + 1, std::vector<double>(maxU + 1, 0.0)));
+        for (std::size_t i = 0; i <= n1; ++i)
+        {
+            for (std::size_t j = 0; j <= n2; ++j)
+            {
+                if (0 == i || 0 == j)
+                {
+                    counts[i][j][0] = 1.0;
+                    continue;
+                }
+                for (std::size_t k = 0; k <= i * j; ++k)
+                {
+                    counts[i][j][k] = (k >= j ? counts[i - 1][j][k - j] : 0.0) + counts[i][j - 1][k];
+                }
+            }
+        }
+        const auto total = std::accumulate(std::begin(counts[n1][n2]), std::end(counts[n1][n2]), 0.0);
+        const auto observed = static_cast<std::size_t>(std::llround(u));
+        double lower = 0.0;
+        double upper = 0.0;
+        for (std::size_t k = 0; k <= maxU; ++k)
+        {
+            lower += k <= observed ? counts[n1][n2][k] : 0.0;
+            upper += k >= observed ? counts[n1][n2][k] : 0.0;
+        }
+        return {u, std::min(1.0, 2.0 * std::min(lower, upper) / total)};
+    }
+
+    const auto n = size1 + size2;
+    const auto mean = size1 * size2 / 2.0;
+    const auto variance = size1 * size2 / 12.0 * ((n + 1.0) - tieCorrection / (n * (n - 1.0)));
+    if (variance <= 0.0)
+    {
+        return {u, 1.0};
+    }
+    const auto z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return {u, std::erfc(z / std::sqrt(2.0))};
+}
+
+/**
+ * @brief   Reads the samples of the metric per benchmark run from the benchmark JSON output,
+ *          the aggregates (mean, median, ...) are skipped.
+ *
+ * @throws  std::runtime_error if the file cannot be read or is not the benchmark output.
+ */
+inline std::map<std::string, std::vector<double>> readSamples(const std::string& path, const std::string& metric)
+{
+    std::ifstream is {path};
+    if (!is)
+    {
+        throw std::runtime_error {"Failed to open " + path};
+    }
+    std::stringstream text;
+    text << is.rdbuf();
+    const auto root = JsonParser {text.str()}.parse();
+    const auto* benchmarks = root.find("benchmarks");
+    if (nullptr == benchmarks || JsonValue::Kind::Array != benchmarks->kind)
+    {
+        throw std::runtime_error {path + " is not the benchmark JSON output"};
+    }
+
+    static const std::map<std::string, double, std::less<>> s_nanosecondsPerUnit {
+        {"ns", 1.0}, {"us", 1e3}, {"ms", 1e6}, {"s", 1e9}};
+    const auto isTime = "real_time" == metric || "cpu_time" == metric;
+
+    std::map<std::string, std::vector<double>> samples;
+    for (const auto& run : benchmarks->array)
+    {
+        const auto* runType = run.find("run_type");
+        if (nullptr != runType && "aggregate" == runType->string)
+        {
+            continue;
+        }
+        const auto* runName = run.find("run_name");
+        if (nullptr == runName)
+        {
+            runName = run.find("name");
+        }
+        const auto* value = run.find(metric);
+        if (nullptr == runName || nullptr == value || JsonValue::Kind::Number != value->kind)
+        {
+            continue;
+        }
+        auto sample = value->number;
+        if (const auto* unit = run.find("time_unit"); isTime && nullptr != unit)
+        {
+            const auto it = s_nanosecondsPerUnit.find(unit->string);
+            sample *= std::end(s_nanosecondsPerUnit) == it ? 1.0 : it->second;
+        }
+        samples[runName->string].push_back(sample);
+    }
+    return samples;
+}
+
+inline double median(std::vector<double> values)
+{
+    std::ranges::sort(values);
+    const auto middle = std::size(values) / 2;
+    return 0 == std::size(values) % 2 ? (values[middle - 1] + values[middle]) / 2.0 : values[middle];
+}
+
+}
+
+namespace
+{
+
+struct Options
+{
+    std::string baseline;
+    std::string contender;
+    std::string metric {"real_time"};
+    std::optional<std::regex> filter;
+    double alpha {0.05};
+    double threshold {0.05};
+    bool higherIsBetter {false};
+};
+
+void printUsage()
+{
+    std::cerr << "Usage: compareBenchmarks [options] <baseline.json> <contender.json>\n"
+                 "\n"
+                 "Compares two outputs of the benchmark executables (--benchmark_out=<file>.json, run with\n"
+                 "--benchmark_repetitions=N, N >= 5 is needed for the significance at the default alpha).\n"
+                 "Exits with 1 if any benchmark is significantly slower than the threshold.\n"
+                 "\n"
+                 "Options:\n"
+                 "  --metric=<field>     The compared field, real_time (default), cpu_time or a counter.\n"
+                 "  --higher-is-better   The metric is a throughput (e.g. items_per_second).\n"
+                 "  --alpha=<p>          The significance level of the Mann-Whitney U test, 0.05 by default.\n"
+                 "  --threshold=<ratio>  The tolerated relative change of the median, 0.05 by default.\n"
+                 "  --filter=<regex>     Compares only the benchmarks with the matching names.\n";
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument {argv[i]};
+        auto valueOf = [argument](std::string_view option) -> std::optional<std::string>
+        {
+            if (!argument.starts_with(option))
+            {
+                return std::nullopt;
+            }
+            return std::string {argument.substr(std::size(option))};
+        };
+
+        if (const auto metric = valueOf("--metric="))
+        {
+            options.metric = *metric;
+        }
+        else if (const auto alpha = valueOf("--alpha="))
+        {
+            options.alpha = std::stod(*alpha);
+        }
+        else if (const auto threshold = valueOf("--threshold="))
+        {
+            options.threshold = std::stod(*threshold);
+        }
+        else if (const auto filter = valueOf("--filter="))
+        {
+            options.filter.emplace(*filter);
+        }
+        else if ("--higher-is-better" == argument)
+        {
+            options.higherIsBetter = true;
+        }
+        else if (argument.starts_with("--"))
+        {
+            throw std::invalid_argument {"Unknown option " + std::string {argument}};
+        }
+        else
+        {
+            files.emplace_back(argument);
+        }
+    }
+    if (2 != std::size(files))
+    {
+        throw std::invalid_argument {"Expected the baseline and the contender files"};
+    }
+    options.baseline = files[0];
+    options.contender = files[1];
+    return options;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    std::map<std::string, std::vector<double>> baseline;
+    std::map<std::string, std::vector<double>> contender;
+    try
+    {
+        options = parseOptions(argc, argv);
+        baseline = test_util::readSamples(options.baseline, options.metric);
+        contender = test_util::readSamples(options.contender, options.metric);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n\n";
+        printUsage();
+        return 2;
+    }
+
+    std::size_t regressions = 0;
+    std::size_t improvements = 0;
+    std::size_t compared = 0;
+    std::cout << std::left << std::setw(60) << "Benchmark" << std::right << std::setw(16) << "Baseline"
+              << std::setw(16) << "Contender" << std::setw(10) << "Change" << std::setw(10) << "p-value" << "  Verdict\n";
+    for (const auto& [name, baselineSamples] : baseline)
+    {
+        const auto it = contender.find(name);
+        if (std::end(contender) == it || (options.filter && !std::regex_search(name, *options.filter)))
+        {
+            continue;
+        }
+        ++compared;
+        const auto baselineMedian = test_util::median(baselineSamples);
+        const auto contenderMedian = test_util::median(it->second);
+        const auto change = 0.0 == baselineMedian ? 0.0 : (contenderMedian - baselineMedian) / baselineMedian;
+        const auto [u, pValue] = test_util::mannWhitneyU(baselineSamples, it->second);
+        static_cast<void>(u);
+
+        // The change is worse if the metric moved in the wrong direction.
+        const auto worse = options.higherIsBetter ? -change : change;
+        std::string_view verdict = "~";
+        if (pValue < options.alpha && std::abs(change) > options.threshold)
+        {
+            verdict = worse > 0.0 ? "REGRESSION" : "improvement";
+            ++(worse > 0.0 ? regressions : improvements);
+        }
+        std::cout << std::left << std::setw(60) << name << std::right << std::setprecision(6)
+                  << std::setw(16) << baselineMedian << std::setw(16) << contenderMedian
+                  << std::setw(9) << std::fixed << std::setprecision(1) << change * 100.0 << "%"
+                  << std::setw(10) << std::setprecision(4) << pValue << std::defaultfloat
+                  << "  " << verdict << '\n';
+    }
+
+    std::cout << "\nCompared " << compared << " benchmarks: " << regressions << " regressions, "
+              << improvements << " improvements (alpha " << options.alpha << ", threshold "
+              << options.threshold * 100.0 << "%).\n";
+    for (const auto& [name, samples] : contender)
+    {
+        if (!baseline.contains(name) && (!options.filter || std::regex_search(name, *options.filter)))
+        {
+            std::cout << "Not in the baseline: " << name << '\n';
+        }
+    }
+    return 0 == regressions ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include "Utils.h"
+#include "BenchmarkMain.h"
+#include "CompressedSimplePolygon.h"
+
+constexpr auto s_polygonCount = 8 << 7;
+constexpr auto s_pointCount = 8 << 10;
+
+using TCrt = int32_t;
+
+class DataStorage
+{
+    static constexpr auto s_maxPos = 1'000'000;
+    static constexpr auto s_maxStep = 64;
+public:
+    static DataStorage& Instance()
+    {
+        static DataStorage s_instance;
+        return s_instance;
+    }
+
+    DataStorage(DataStorage&&) = delete;
+    DataStorage(const DataStorage&) = delete;
+    DataStorage operator=(DataStorage&&) = delete;
+    DataStorage operator=(const DataStorage&) = delete;
+
+public:
+
+    const auto& Polygons() const noexcept
+    {
+        return m_polygons;
+    }
+
+    const auto& CompressedPolygons() const noexcept
+    {
+        return m_compressedPolygons;
+    }
+
+    const auto& Points() const noexcept
+    {
+        return m_points;
+    }
+
+private:
+
+    DataStorage()
+    {
+        // The random walks: the consecutive vertices are close to each other.
+        for (int i = 0; i < s_polygonCount; ++i)
+        {
+            std::vector<space::Point<TCrt>> curve;
+            auto point = test_util::getRandPoint(s_maxPos);
+            for (int j = test_util::rand(64, 4'096); j > 0; --j)
+            {
+                space::util::move(point, test_util::rand(-s_maxStep, s_maxStep), test_util::rand(-s_maxStep, s_maxStep));
+                curve.push_back(point);
+            }
+            m_polygons.emplace_back(std::move(curve));
+            m_compressedPolygons.emplace_back(m_polygons.back());
+        }
+
+        for (int i = 0; i < s_pointCount; ++i)
+        {
+            m_points.push_back(test_util::getRandPoint(s_maxPos));
+        }
+    }
+
+private:
+    std::vector<space::SimplePolygon<TCrt>> m_polygons;
+    std::vector<space::CompressedSimplePolygon<TCrt>> m_compressedPolygons;
+    std::vector<space::Point<TCrt>> m_points;
+};
+
+static void SpaceCompressedSimplePolygonDecode(benchmark::State& state)
+{
+    const auto& polygons = DataStorage::Instance().CompressedPolygons();
+
+    int64_t bytes = 0;
+    for (const auto& polygon : polygons)
+    {
+        bytes += static_cast<int64_t>(polygon.bytes().size());
+    }
+
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        for (const auto& polygon : polygons)
+        {
+            for (const auto point : polygon)
+            {
+                sum += point.x() + point.y();
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * bytes);
+
+    double rawBytes = 0;
+    for (const auto& polygon : polygons)
+    {
+        rawBytes += static_cast<double>(polygon.size() * sizeof(space::Point<TCrt>));
+    }
+    state.counters["compression_ratio"] = rawBytes / static_cast<double>(bytes);
+}
+
+BENCHMARK(SpaceCompressedSimplePolygonDecode);
+
+template <typename TPolygon>
+static void containsBenchmark(benchmark::State& state, const std::vector<TPolygon>& polygons)
+{
+    const auto& points = DataStorage::Instance().Points();
+
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < polygons.size(); ++i)
+        {
+            count += space::util::contains(polygons[i], points[i % points.size()]);
+        }
+        benchmark::DoNotOptimize(count);
+    }
+}
+
+static void SpaceSimplePolygonContains(benchmark::State& state)
+{
+    containsBenchmark(state, DataStorage::Instance().Polygons());
+}
+
+BENCHMARK(SpaceSimplePolygonContains);
+
+static void SpaceCompressedSimplePolygonContains(benchmark::State& state)
+{
+    containsBenchmark(state, DataStorage::Instance().CompressedPolygons());
+}
+
+BENCHMARK(SpaceCompressedSimplePolygonContains);
+
+int main(int argc, char** argv)
+{
+    auto& dataStorage = DataStorage::Instance();
+    benchmark::DoNotOptimize(dataStorage);
+    return test_util::runBenchmarks(argc, argv);
+}
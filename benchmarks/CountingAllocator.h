@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+
+namespace test_util
+{
+
+/**
+ * @brief   The allocator which counts the bytes currently allocated through it and its
+ *          rebound copies, used to measure the memory of third-party containers.
+ */
+template <typename T>
+class CountingAllocator
+{
+public:
+    using value_type = T;
+
+    explicit CountingAllocator(std::size_t* allocatedBytes) noexcept
+        : m_allocatedBytes {allocatedBytes}
+    {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : m_allocatedBytes {other.allocatedBytesCounter()}
+    {
+    }
+
+    T* allocate(std::size_t count)
+    {
+        *m_allocatedBytes += count * sizeof(T);
+        return std::allocator<T> {}.allocate(count);
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept
+    {
+        *m_allocatedBytes -= count * sizeof(T);
+        std::allocator<T> {}.deallocate(pointer, count);
+    }
+
+    [[nodiscard]]
+    std::size_t* allocatedBytesCounter() const noexcept
+    {
+        return m_allocatedBytes;
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept
+    {
+        return m_allocatedBytes == other.allocatedBytesCounter();
+    }
+
+private:
+    std::size_t* m_allocatedBytes;
+};
+
+}
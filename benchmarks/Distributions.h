@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include "Rect.h"
+
+
+namespace test_util
+{
+
+/**
+ * @brief   The distributions of the benchmark data.
+ */
+enum class Distribution : int64_t
+{
+    Uniform = 0
+    , Clustered         // Gaussian mixture, most rects are around a few centers.
+    , Zipf              // The cells of the grid are chosen with the Zipf-skewed frequencies.
+    , Line              // Small rects along the random segments (roads).
+    , Grid              // The positions and sizes are aligned to the grid.
+    , HeavyTailed       // Uniform positions, Pareto distributed sizes.
+    , SplitLine         // The rects crossing the quadtree split lines.
+};
+
+inline constexpr std::uint64_t s_defaultSeed = 0x5EED'5EED'5EED'5EEDull;
+
+/**
+ * @brief   Gets all distributions as the benchmark arguments.
+ */
+inline std::vector<int64_t> allDistributions()
+{
+    return {static_cast<int64_t>(Distribution::Uniform), static_cast<int64_t>(Distribution::Clustered)
+            , static_cast<int64_t>(Distribution::Zipf), static_cast<int64_t>(Distribution::Line)
+            , static_cast<int64_t>(Distribution::Grid), static_cast<int64_t>(Distribution::HeavyTailed)
+            , static_cast<int64_t>(Distribution::SplitLine)};
+}
+
+inline std::string_view nameOf(Distribution distribution)
+{
+    switch (distribution)
+    {
+        case Distribution::Uniform: return "uniform";
+        case Distribution::Clustered: return "clustered";
+        case Distribution::Zipf: return "zipf";
+        case Distribution::Line: return "line";
+        case Distribution::Grid: return "grid";
+        case Distribution::HeavyTailed: return "heavy_tailed";
+        case Distribution::SplitLine: return "split_line";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief   The generator of rects with the given distribution.
+ *
+ * @details All generators are deterministic for the given seed, the rects are within
+ *          [0, maxPos] and the sizes are at most maxRectSize (except HeavyTailed).
+ *
+ * @tparam  TCrt The type of coordinates.
+ */
+template <typename TCrt>
+class RectGenerator
+{
+    static constexpr std::size_t s_clusterCount = 16;
+    static constexpr std::size_t s_zipfCellsPerAxis = 64;
+    static constexpr double s_zipfExponent = 1.1;
+    static constexpr std::size_t s_lineCount = 64;
+    static constexpr TCrt s_gridStep = 64;
+    static constexpr double s_paretoAlpha = 1.2;
+    static constexpr int s_splitLineMaxLevel = 10;
+
+public:
+    RectGenerator(Distribution distribution, TCrt maxPos, TCrt maxRectSize, std::uint64_t seed = s_defaultSeed)
+        : m_distribution {distribution}
+        , m_maxPos {maxPos}
+        , m_maxRectSize {maxRectSize}
+        , m_engine {seed}
+    {
+        std::uniform_real_distribution<double> pos {0.0, static_cast<double>(m_maxPos)};
+        for (std::size_t i = 0; i < s_clusterCount; ++i)
+        {
+            m_clusterCenters.push_back({pos(m_engine), pos(m_engine)});
+        }
+        for (std::size_t i = 0; i < s_lineCount; ++i)
+        {
+            m_lines.push_back({pos(m_engine), pos(m_engine), pos(m_engine), pos(m_engine)});
+        }
+
+        std::vector<double> weights;
+        for (std::size_t rank = 1; rank <= s_zipfCellsPerAxis * s_zipfCellsPerAxis; ++rank)
+        {
+            weights.push_back(1.0 / std::pow(static_cast<double>(rank), s_zipfExponent));
+        }
+        // The ranks are assigned to the cells randomly, so the hot cells are scattered.
+        std::shuffle(std::begin(weights), std::end(weights), m_engine);
+        m_zipfCells = std::discrete_distribution<std::size_t> {std::begin(weights), std::end(weights)};
+    }
+
+    space::Rect<TCrt> operator()()
+    {
+        switch (m_distribution)
+        {
+            case Distribution::Uniform: return uniform();
+            case Distribution::Clustered: return clustered();
+            case Distribution::Zipf: return zipf();
+            case Distribution::Line: return line();
+            case Distribution::Grid: return grid();
+            case Distribution::HeavyTailed: return heavyTailed();
+            case Distribution::SplitLine: return splitLine();
+        }
+        return uniform();
+    }
+
+private:
+
+    TCrt randomSize()
+    {
+        return std::uniform_int_distribution<TCrt> {1, m_maxRectSize}(m_engine);
+    }
+
+    /**
+     * @brief   Makes the rect with the given center, clamped to [0, maxPos].
+     */
+    space::Rect<TCrt> makeRect(double centerX, double centerY, TCrt width, TCrt height) const
+    {
+        width = std::min(width, m_maxPos);
+        height = std::min(height, m_maxPos);
+        const auto x = std::clamp(static_cast<TCrt>(std::llround(centerX)) - width / 2, TCrt {0}, m_maxPos - width);
+        const auto y = std::clamp(static_cast<TCrt>(std::llround(centerY)) - height / 2, TCrt {0}, m_maxPos - height);
+        return space::Rect<TCrt> {space::Point<TCrt> {x, y}, width, height};
+    }
+
+    space::Rect<TCrt> uniform()
+    {
+        std::uniform_real_distribution<double> pos {0.0, static_cast<double>(m_maxPos)};
+        return makeRect(pos(m_engine), pos(m_engine), randomSize(), randomSize());
+    }
+
+    space::Rect<TCrt> clustered()
+    {
+        const auto& [centerX, centerY] = m_clusterCenters[std::uniform_int_distribution<std::size_t> {
+            0, s_clusterCount - 1}(m_engine)];
+        std::normal_distribution<double> offset {0.0, static_cast<double>(m_maxPos) / 100.0};
+        return makeRect(centerX + offset(m_engine), centerY + offset(m_engine), randomSize(), randomSize());
+    }
+
+    space::Rect<TCrt> zipf()
+    {
+        const auto cell = m_zipfCells(m_engine);
+        const auto cellSize = static_cast<double>(m_maxPos) / static_cast<double>(s_zipfCellsPerAxis);
+        std::uniform_real_distribution<double> offset {0.0, cellSize};
+        const auto x = static_cast<double>(cell % s_zipfCellsPerAxis) * cellSize + offset(m_engine);
+        const auto y = static_cast<double>(cell / s_zipfCellsPerAxis) * cellSize + offset(m_engine);
+        return makeRect(x, y, randomSize(), randomSize());
+    }
+
+    space::Rect<TCrt> line()
+    {
+        const auto& [x1, y1, x2, y2] = m_lines[std::uniform_int_distribution<std::size_t> {
+            0, s_lineCount - 1}(m_engine)];
+        const auto t = std::uniform_real_distribution<double> {0.0, 1.0}(m_engine);
+        std::normal_distribution<double> jitter {0.0, static_cast<double>(m_maxRectSize)};
+        // The road pieces are elongated along the dominant direction of the segment.
+        const auto length = randomSize();
+        const auto thickness = std::max(TCrt {1}, static_cast<TCrt>(length / 8));
+        const auto horizontal = std::abs(x2 - x1) > std::abs(y2 - y1);
+        return makeRect(x1 + t * (x2 - x1) + jitter(m_engine), y1 + t * (y2 - y1) + jitter(m_engine)
+                        , horizontal ? length : thickness, horizontal ? thickness : length);
+    }
+
+    space::Rect<TCrt> grid()
+    {
+        const auto cells = std::max(TCrt {1}, m_maxPos / s_gridStep);
+        std::uniform_int_distribution<TCrt> cell {0, cells - 1};
+        std::uniform_int_distribution<TCrt> cellsPerRect {1, std::max(TCrt {1}, m_maxRectSize / s_gridStep)};
+        const auto width = std::min(cellsPerRect(m_engine) * s_gridStep, m_maxPos);
+        const auto height = std::min(cellsPerRect(m_engine) * s_gridStep, m_maxPos);
+        const auto x = std::min(cell(m_engine) * s_gridStep, m_maxPos - width);
+        const auto y = std::min(cell(m_engine) * s_gridStep, m_maxPos - height);
+        return space::Rect<TCrt> {space::Point<TCrt> {x, y}, width, height};
+    }
+
+    space::Rect<TCrt> heavyTailed()
+    {
+        std::uniform_real_distribution<double> pos {0.0, static_cast<double>(m_maxPos)};
+        std::uniform_real_distribution<double> unit {0.0, 1.0};
+        auto pareto = [&]()
+        {
+            const auto size = std::pow(1.0 - unit(m_engine), -1.0 / s_paretoAlpha);
+            return static_cast<TCrt>(std::min(size, static_cast<double>(m_maxPos)));
+        };
+        return makeRect(pos(m_engine), pos(m_engine), pareto(), pareto());
+    }
+
+    /**
+     * @brief   Makes the rect crossing the split line of the quadtree region, such rects
+     *          stay in the upper nodes.
+     */
+    space::Rect<TCrt> splitLine()
+    {
+        const auto rootSize = std::bit_ceil(static_cast<std::uint64_t>(m_maxPos));
+        const auto level = std::uniform_int_distribution<int> {1, s_splitLineMaxLevel}(m_engine);
+        const auto step = rootSize >> level;
+        const auto index = std::uniform_int_distribution<std::uint64_t> {0, (rootSize / step - 1) / 2}(m_engine);
+        const auto splitLine = static_cast<double>((2 * index + 1) * step);
+        std::uniform_real_distribution<double> pos {0.0, static_cast<double>(m_maxPos)};
+        const auto vertical = std::bernoulli_distribution {0.5}(m_engine);
+        return makeRect(vertical ? splitLine : pos(m_engine), vertical ? pos(m_engine) : splitLine
+                        , randomSize(), randomSize());
+    }
+
+private:
+    Distribution m_distribution;
+    TCrt m_maxPos;
+    TCrt m_maxRectSize;
+    std::mt19937_64 m_engine;
+    std::vector<std::pair<double, double>> m_clusterCenters;
+    std::vector<std::array<double, 4>> m_lines;
+    std::discrete_distribution<std::size_t> m_zipfCells;
+};
+
+/**
+ * @brief   Generates the given number of unique rects with the given distribution.
+ */
+template <typename TCrt>
+std::vector<space::Rect<TCrt>> generateRects(Distribution distribution, std::size_t count
+    , TCrt maxPos, TCrt maxRectSize, std::uint64_t seed = s_defaultSeed)
+{
+    RectGenerator<TCrt> generator {distribution, maxPos, maxRectSize, seed};
+    std::set<space::Rect<TCrt>> unique;
+    std::vector<space::Rect<TCrt>> rects;
+    rects.reserve(count);
+    while (std::size(rects) != count)
+    {
+        const auto rect = generator();
+        if (unique.insert(rect).second)
+        {
+            rects.push_back(rect);
+        }
+    }
+    return rects;
+}
+
+}
@@ -0,0 +1,335 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <map>
+#include <numbers>
+#include <random>
+
+#include <boost/geometry.hpp>
+
+#include "Utils.h"
+#include "BenchmarkMain.h"
+#include "Distributions.h"
+#include "Segment.h"
+#include "SimplePolygon.h"
+
+constexpr auto s_segmentCount = 8 << 9;
+constexpr auto s_pointCount = 64;
+constexpr auto s_maxVertexCount = 1 << 20;
+
+// The separating axis test is quadratic, so the polygon intersection is limited.
+constexpr auto s_maxIntersectVertexCount = 1 << 12;
+
+using TCrt = int32_t;
+using point = boost::geometry::model::point<TCrt, 2, boost::geometry::cs::cartesian>;
+using box = boost::geometry::model::box<point>;
+using segment = boost::geometry::model::segment<point>;
+using polygon = boost::geometry::model::polygon<point, false, false>;
+
+class DataStorage
+{
+    static constexpr auto s_maxPos = 1'000'000;
+    static constexpr auto s_maxSegmentSize = 10'000;
+    static constexpr double s_radius = 100'000'000;
+
+    /**
+     * @brief   The pair of convex polygons with the same number of vertices, the second one
+     *          is shifted to overlap the half of the first one.
+     */
+    struct Polygons
+    {
+        space::SimplePolygon<TCrt> first;
+        space::SimplePolygon<TCrt> second;
+        polygon boostFirst;
+        polygon boostSecond;
+    };
+
+public:
+    static DataStorage& Instance()
+    {
+        static DataStorage s_instance;
+        return s_instance;
+    }
+
+    DataStorage(DataStorage&&) = delete;
+    DataStorage(const DataStorage&) = delete;
+    DataStorage operator=(DataStorage&&) = delete;
+    DataStorage operator=(const DataStorage&) = delete;
+
+public:
+
+    const auto& Segments() const noexcept
+    {
+        return m_segments;
+    }
+
+    const auto& BoostSegments() const noexcept
+    {
+        return m_boostSegments;
+    }
+
+    /**
+     * @brief   Gets the points around the polygons, about the half of them are inside.
+     */
+    const auto& Points() const noexcept
+    {
+        return m_points;
+    }
+
+    const auto& BoostPoints() const noexcept
+    {
+        return m_boostPoints;
+    }
+
+    const Polygons& PolygonsOf(std::size_t vertexCount)
+    {
+        auto it = m_polygons.find(vertexCount);
+        if (std::end(m_polygons) != it)
+        {
+            return it->second;
+        }
+
+        Polygons polygons;
+        polygons.first = makeConvexPolygon(vertexCount, 0);
+        polygons.second = makeConvexPolygon(vertexCount, static_cast<TCrt>(s_radius));
+        polygons.boostFirst = toBoostPolygon(polygons.first);
+        polygons.boostSecond = toBoostPolygon(polygons.second);
+        return m_polygons.emplace(vertexCount, std::move(polygons)).first->second;
+    }
+
+private:
+
+    DataStorage()
+    {
+        // The seeded engine, so every run measures the same segments and points.
+        std::mt19937_64 engine {test_util::s_defaultSeed};
+        std::uniform_int_distribution<TCrt> position {0, s_maxPos};
+        std::uniform_int_distribution<TCrt> shift {-s_maxSegmentSize, s_maxSegmentSize};
+        for (int i = 0; i < s_segmentCount; ++i)
+        {
+            const space::Point<TCrt> first {position(engine), position(engine)};
+            auto second = first;
+            space::util::move(second, shift(engine), shift(engine));
+            m_segments.emplace_back(first, second);
+            m_boostSegments.emplace_back(point {first.x(), first.y()}, point {second.x(), second.y()});
+        }
+
+        const auto maxPos = static_cast<TCrt>(s_radius * 1.2);
+        std::uniform_int_distribution<TCrt> pointPosition {-maxPos, maxPos};
+        for (int i = 0; i < s_pointCount; ++i)
+        {
+            const space::Point<TCrt> p {pointPosition(engine), pointPosition(engine)};
+            m_points.push_back(p);
+            m_boostPoints.emplace_back(p.x(), p.y());
+        }
+    }
+
+    /**
+     * @brief   Makes the polygon with the vertices on the circle in counterclockwise order.
+     */
+    static space::SimplePolygon<TCrt> makeConvexPolygon(std::size_t vertexCount, TCrt centerX)
+    {
+        space::SimplePolygon<TCrt>::TPiecewiseLinearCurve curve;
+        curve.reserve(vertexCount);
+        for (std::size_t i = 0; i < vertexCount; ++i)
+        {
+            const auto angle = 2 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(vertexCount);
+            curve.emplace_back(centerX + static_cast<TCrt>(std::lround(s_radius * std::cos(angle)))
+                               , static_cast<TCrt>(std::lround(s_radius * std::sin(angle))));
+        }
+        return space::SimplePolygon<TCrt> {std::move(curve)};
+    }
+
+    static polygon toBoostPolygon(const space::SimplePolygon<TCrt>& poly)
+    {
+        polygon result;
+        for (const auto& p : poly.boundaryCurve())
+        {
+            boost::geometry::append(result.outer(), point {p.x(), p.y()});
+        }
+        return result;
+    }
+
+private:
+    std::vector<space::Segment<TCrt>> m_segments;
+    std::vector<segment> m_boostSegments;
+    std::vector<space::Point<TCrt>> m_points;
+    std::vector<point> m_boostPoints;
+    std::map<std::size_t, Polygons> m_polygons;
+};
+
+static void SpaceSegmentHasIntersect(benchmark::State& state)
+{
+    const auto& segments = DataStorage::Instance().Segments();
+
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (size_t i = 1; i < segments.size(); ++i)
+        {
+            count += space::util::hasIntersect(segments[i - 1], segments[i]);
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (s_segmentCount - 1));
+}
+
+static void BoostSegmentIntersects(benchmark::State& state)
+{
+    const auto& segments = DataStorage::Instance().BoostSegments();
+
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (size_t i = 1; i < segments.size(); ++i)
+        {
+            count += boost::geometry::intersects(segments[i - 1], segments[i]);
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (s_segmentCount - 1));
+}
+
+BENCHMARK(SpaceSegmentHasIntersect);
+BENCHMARK(BoostSegmentIntersects);
+
+static void SpaceSimplePolygonContains(benchmark::State& state)
+{
+    const auto& poly = DataStorage::Instance().PolygonsOf(static_cast<std::size_t>(state.range(0))).first;
+    const auto& points = DataStorage::Instance().Points();
+
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (const auto& p : points)
+        {
+            count += space::util::contains(poly, p);
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_pointCount);
+    state.SetComplexityN(state.range(0));
+}
+
+static void BoostPolygonCoveredBy(benchmark::State& state)
+{
+    const auto& poly = DataStorage::Instance().PolygonsOf(static_cast<std::size_t>(state.range(0))).boostFirst;
+    const auto& points = DataStorage::Instance().BoostPoints();
+
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (const auto& p : points)
+        {
+            // The space::util::contains includes the boundary, so it is covered_by, not within.
+            count += boost::geometry::covered_by(p, poly);
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_pointCount);
+    state.SetComplexityN(state.range(0));
+}
+
+static void SpaceSimplePolygonHasIntersect(benchmark::State& state)
+{
+    const auto& polygons = DataStorage::Instance().PolygonsOf(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(space::util::hasIntersect(polygons.first, polygons.second));
+    }
+    state.SetComplexityN(state.range(0));
+}
+
+static void BoostPolygonIntersects(benchmark::State& state)
+{
+    const auto& polygons = DataStorage::Instance().PolygonsOf(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(boost::geometry::intersects(polygons.boostFirst, polygons.boostSecond));
+    }
+    state.SetComplexityN(state.range(0));
+}
+
+static void SpaceSimplePolygonBoundaryBox(benchmark::State& state)
+{
+    const auto& poly = DataStorage::Instance().PolygonsOf(static_cast<std::size_t>(state.range(0))).first;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(space::util::boundaryBoxOf(poly));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetComplexityN(state.range(0));
+}
+
+static void BoostPolygonEnvelope(benchmark::State& state)
+{
+    const auto& poly = DataStorage::Instance().PolygonsOf(static_cast<std::size_t>(state.range(0))).boostFirst;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(boost::geometry::return_envelope<box>(poly));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetComplexityN(state.range(0));
+}
+
+static void SpaceSimplePolygonMove(benchmark::State& state)
+{
+    auto poly = DataStorage::Instance().PolygonsOf(static_cast<std::size_t>(state.range(0))).first;
+
+    TCrt delta = 1;
+    for (auto _ : state)
+    {
+        // The polygon is moved back and forth, so the coordinates do not overflow.
+        space::util::move(poly, delta, delta);
+        delta = -delta;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetComplexityN(state.range(0));
+}
+
+static void BoostPolygonTranslate(benchmark::State& state)
+{
+    auto poly = DataStorage::Instance().PolygonsOf(static_cast<std::size_t>(state.range(0))).boostFirst;
+
+    TCrt delta = 1;
+    for (auto _ : state)
+    {
+        boost::geometry::for_each_point(poly, [delta](point& p)
+        {
+            boost::geometry::add_value(p, delta);
+        });
+        delta = -delta;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetComplexityN(state.range(0));
+}
+
+static void polygonSizes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgName("vertices")->RangeMultiplier(8)->Range(3, s_maxVertexCount)->Complexity();
+}
+
+static void intersectPolygonSizes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgName("vertices")->RangeMultiplier(8)->Range(3, s_maxIntersectVertexCount)->Complexity();
+}
+
+BENCHMARK(SpaceSimplePolygonContains)->Apply(polygonSizes);
+BENCHMARK(BoostPolygonCoveredBy)->Apply(polygonSizes);
+BENCHMARK(SpaceSimplePolygonHasIntersect)->Apply(intersectPolygonSizes);
+BENCHMARK(BoostPolygonIntersects)->Apply(intersectPolygonSizes);
+BENCHMARK(SpaceSimplePolygonBoundaryBox)->Apply(polygonSizes);
+BENCHMARK(BoostPolygonEnvelope)->Apply(polygonSizes);
+BENCHMARK(SpaceSimplePolygonMove)->Apply(polygonSizes);
+BENCHMARK(BoostPolygonTranslate)->Apply(polygonSizes);
+
+int main(int argc, char** argv)
+{
+    return test_util::runBenchmarks(argc, argv);
+}
@@ -1,8 +1,13 @@
 #include <benchmark/benchmark.h>
 
-#include <unordered_set>
+#include <map>
 
+#include "AllocationCounter.h"
 #include "Utils.h"
+#include "BenchmarkMain.h"
+#include "CountingAllocator.h"
+#include "Distributions.h"
+#include "PerfCounters.h"
 
 constexpr auto s_testCount = 8 << 17;
 
@@ -16,8 +21,14 @@ class DataStorage
 
     static constexpr auto s_count = s_testCount;
     static constexpr auto s_maxPos = 1'000'000;
-    static constexpr auto s_maxRectWidth = 1'000;
-    static constexpr auto s_maxRectHeight = 1'000;
+    static constexpr auto s_maxRectSize = 1'000;
+
+    struct Data
+    {
+        std::vector<box> boostBoxList;
+        std::vector<space::Rect<TCrt>> spaceBoxList;
+    };
+
 public:
     static DataStorage& Instance()
     {
@@ -32,88 +43,133 @@ public:
 
 public:
 
-    const auto& BoostBoxList() const noexcept
+    const auto& BoostBoxList(test_util::Distribution distribution)
     {
-        return m_boostBoxList;
+        return DataOf(distribution).boostBoxList;
     }
 
-    const auto& SpaceBoxList() const noexcept
+    const auto& SpaceBoxList(test_util::Distribution distribution)
     {
-        return m_spaceBoxList;
+        return DataOf(distribution).spaceBoxList;
     }
 
 private:
 
-    DataStorage()
-    {
-        std::set<space::Rect<TCrt>> initialRects;
+    DataStorage() = default;
 
-        while (initialRects.size() != s_count)
+    const Data& DataOf(test_util::Distribution distribution)
+    {
+        auto it = m_data.find(distribution);
+        if (std::end(m_data) != it)
         {
-            const auto rect = test_util::getRandRect(s_maxPos, s_maxRectWidth, s_maxRectHeight);
-            initialRects.insert(rect);
+            return it->second;
         }
 
-        m_spaceBoxList.reserve(std::size(initialRects));
-        m_boostBoxList.reserve(std::size(initialRects));
-        for (auto&& rect : initialRects)
+        Data data;
+        data.spaceBoxList = test_util::generateRects<TCrt>(distribution, s_count, s_maxPos, s_maxRectSize);
+        data.boostBoxList.reserve(std::size(data.spaceBoxList));
+        for (auto&& rect : data.spaceBoxList)
         {
-            m_spaceBoxList.push_back(rect);
-            const auto boostRect = test_util::spaceToBoostRect(rect);
-            m_boostBoxList.push_back(boostRect);
+            data.boostBoxList.push_back(test_util::spaceToBoostRect(rect));
         }
+        return m_data.emplace(distribution, std::move(data)).first->second;
     }
 
 private:
-    std::vector<box> m_boostBoxList;
-    std::vector<space::Rect<TCrt>> m_spaceBoxList;
+    std::map<test_util::Distribution, Data> m_data;
 };
 
-static void BoostSpaceIndexInsert(benchmark::State& state)
+/**
+ * @brief   Reports the heap allocations of the inserts as the benchmark user counters.
+ */
+static void reportAllocations(benchmark::State& state, const test_util::AllocationStatistics& allocations
+    , int64_t insertsPerIteration)
 {
-    const auto& boxList = DataStorage::Instance().BoostBoxList();
-    const auto count = state.range(0);
+    const auto inserts = static_cast<double>(state.iterations()) * static_cast<double>(insertsPerIteration);
+    state.counters["allocs_per_insert"] = static_cast<double>(allocations.allocations) / inserts;
+    state.counters["alloc_bytes_per_insert"] = static_cast<double>(allocations.allocatedBytes) / inserts;
+    state.counters["peak_bytes"] = static_cast<double>(allocations.peakBytes);
+}
 
-    boost::geometry::index::rtree<value, boost::geometry::index::quadratic<16>> rtree;
+static void BoostSpaceIndexInsert(benchmark::State& state)
+{
+    using allocator = test_util::CountingAllocator<value>;
+    using rtree_type = boost::geometry::index::rtree<value, boost::geometry::index::quadratic<16>
+                                                     , boost::geometry::index::indexable<value>
+                                                     , boost::geometry::index::equal_to<value>, allocator>;
+
+    const auto distribution = static_cast<test_util::Distribution>(state.range(0));
+    const auto& boxList = DataStorage::Instance().BoostBoxList(distribution);
+    const auto count = state.range(1);
+    state.SetLabel(std::string {test_util::nameOf(distribution)});
+
+    std::size_t allocatedBytes = 0;
+    rtree_type rtree {boost::geometry::index::quadratic<16> {}, boost::geometry::index::indexable<value> {}
+                      , boost::geometry::index::equal_to<value> {}, allocator {std::addressof(allocatedBytes)}};
+    test_util::PerfCounters perfCounters;
+    test_util::AllocationStatistics allocations;
     for (auto _ : state)
     {
+        const test_util::AllocationScope allocationScope;
+        perfCounters.start();
         for (int i = 0; i < count; ++i)
         {
             rtree.insert(std::make_pair(boxList[i], 0));
         }
+        perfCounters.stop();
+        allocations += allocationScope.statistics();
+        state.PauseTiming();
+        state.counters["bytes_per_element"] = static_cast<double>(allocatedBytes + sizeof(rtree))
+                                              / static_cast<double>(rtree.size());
+        rtree.clear();
+        state.ResumeTiming();
     }
+    perfCounters.report(state);
+    reportAllocations(state, allocations, count);
 }
 // Register the function as a benchmark
-BENCHMARK(BoostSpaceIndexInsert)->Range(512, s_testCount);
+BENCHMARK(BoostSpaceIndexInsert)->ArgsProduct({test_util::allDistributions()
+                                               , benchmark::CreateRange(512, s_testCount, 8)});
 
 static void SpaceQuadTreeInsert(benchmark::State& state)
 {
-    const auto& boxList = DataStorage::Instance().SpaceBoxList();
-    const auto count = state.range(0);
+    const auto distribution = static_cast<test_util::Distribution>(state.range(0));
+    const auto& boxList = DataStorage::Instance().SpaceBoxList(distribution);
+    const auto count = state.range(1);
+    state.SetLabel(std::string {test_util::nameOf(distribution)});
 
     space::QuadTree<space::Rect<TCrt>> quadTree;
+    test_util::PerfCounters perfCounters;
+    test_util::AllocationStatistics allocations;
     for (auto _ : state)
     {
+        const test_util::AllocationScope allocationScope;
+        perfCounters.start();
         for (int i = 0; i < count; ++i)
         {
             quadTree.insert(boxList[i]);
         }
+        perfCounters.stop();
+        allocations += allocationScope.statistics();
+        // Every iteration inserts into the empty index, otherwise all inserts fail as duplicates.
+        state.PauseTiming();
+        state.counters["bytes_per_element"] = static_cast<double>(quadTree.memoryUsage().total() + sizeof(quadTree))
+                                              / static_cast<double>(quadTree.size());
+        quadTree.clear();
+        state.ResumeTiming();
     }
+    perfCounters.report(state);
+    reportAllocations(state, allocations, count);
 }
 // Register the function as a benchmark
-BENCHMARK(SpaceQuadTreeInsert)->Range(512, s_testCount);
+BENCHMARK(SpaceQuadTreeInsert)->ArgsProduct({test_util::allDistributions()
+                                             , benchmark::CreateRange(512, s_testCount, 8)});
 
 
 
 int main(int argc, char** argv)
 {
-    auto& dataStorage = DataStorage::Instance();
-    ::benchmark::Initialize(&argc, argv);
-    if (::benchmark::ReportUnrecognizedArguments(argc, argv))
-    {
-        return 1;
-    }
-    ::benchmark::RunSpecifiedBenchmarks();
+    return test_util::runBenchmarks(argc, argv);
 }
 
 // BENCHMARK_MAIN();
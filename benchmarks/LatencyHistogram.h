@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace test_util
+{
+
+/**
+ * @brief   The log-linear histogram of latencies in nanoseconds, the relative error of
+ *          percentiles is below 2^-s_subBucketBits.
+ */
+class LatencyHistogram
+{
+    static constexpr std::size_t s_subBucketBits = 5;
+    static constexpr std::size_t s_subBucketCount = 1 << s_subBucketBits;
+    static constexpr std::size_t s_bucketCount = (64 - s_subBucketBits + 1) * s_subBucketCount;
+
+public:
+
+    void record(std::uint64_t nanoseconds) noexcept
+    {
+        ++m_counts[bucketOf(nanoseconds)];
+        ++m_total;
+    }
+
+    void merge(const LatencyHistogram& other) noexcept
+    {
+        for (std::size_t i = 0; i < s_bucketCount; ++i)
+        {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_total += other.m_total;
+    }
+
+    [[nodiscard]]
+    std::uint64_t count() const noexcept
+    {
+        return m_total;
+    }
+
+    /**
+     * @brief   Gets the upper bound of the bucket with the given quantile (0 if empty).
+     */
+    [[nodiscard]]
+    std::uint64_t percentile(double quantile) const noexcept
+    {
+        const auto rank = static_cast<std::uint64_t>(std::ceil(quantile * static_cast<double>(m_total)));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < s_bucketCount; ++i)
+        {
+            seen += m_counts[i];
+            if (0 != m_counts[i] && seen >= rank)
+            {
+                return upperBoundOf(i);
+            }
+        }
+        return 0;
+    }
+
+private:
+
+    /**
+     * @brief   The values below s_subBucketCount have own buckets, the others are split by
+     *          the most significant bit, then by the next s_subBucketBits bits.
+     */
+    static std::size_t bucketOf(std::uint64_t value) noexcept
+    {
+        if (value < s_subBucketCount)
+        {
+            return static_cast<std::size_t>(value);
+        }
+        const auto shift = static_cast<std::size_t>(std::bit_width(value)) - s_subBucketBits - 1;
+        const auto subBucket = static_cast<std::size_t>(value >> shift) - s_subBucketCount;
+        return (shift + 1) * s_subBucketCount + subBucket;
+    }
+
+    static std::uint64_t upperBoundOf(std::size_t bucket) noexcept
+    {
+        if (bucket < s_subBucketCount)
+        {
+            return bucket;
+        }
+        const auto shift = bucket / s_subBucketCount - 1;
+        const auto subBucket = bucket % s_subBucketCount + s_subBucketCount;
+        return ((std::uint64_t {subBucket} + 1) << shift) - 1;
+    }
+
+private:
+    std::array<std::uint64_t, s_bucketCount> m_counts {};
+    std::uint64_t m_total {0};
+};
+
+}
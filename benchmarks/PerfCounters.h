@@ -0,0 +1,182 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace test_util
+{
+
+/**
+ * @brief   The hardware performance counters read around the benchmark iterations.
+ *
+ * @details The counters are enabled by the SPACE_BENCHMARK_PERF_COUNTERS environment variable.
+ *          The events are opened as one group with Linux perf_event_open, so they are enabled
+ *          and disabled with one call and count the same code. The events which cannot be
+ *          opened (no permission, no PMU in VM) are skipped, if none is opened the counters
+ *          are not reported at all.
+ *
+ *          Usage: call start and stop around the measured part of every iteration, then
+ *          report after the benchmark loop.
+ */
+class PerfCounters
+{
+#if defined(__linux__)
+    struct Event
+    {
+        std::string_view name;
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    static constexpr std::array<Event, 5> s_events {
+        Event {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES}
+        , Event {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS}
+        , Event {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+        , Event {"l1d_misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                                                   | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                                   | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)}
+        , Event {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}};
+#endif
+
+public:
+    PerfCounters()
+    {
+#if defined(__linux__)
+        if (nullptr == std::getenv("SPACE_BENCHMARK_PERF_COUNTERS"))
+        {
+            return;
+        }
+        for (const auto& event : s_events)
+        {
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = event.type;
+            attr.config = event.config;
+            attr.disabled = m_fds.empty() ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader(), 0));
+            if (-1 == fd)
+            {
+                continue;
+            }
+            m_fds.push_back(fd);
+            m_names.push_back(event.name);
+        }
+        if (m_fds.empty())
+        {
+            static const auto s_reported = [error = errno]()
+            {
+                std::cerr << "The performance counters are unavailable: " << std::strerror(error) << std::endl;
+                return true;
+            }();
+            static_cast<void>(s_reported);
+            return;
+        }
+        m_values.assign(std::size(m_fds), 0);
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#if defined(__linux__)
+        for (const auto fd : m_fds)
+        {
+            close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    [[nodiscard]]
+    bool available() const noexcept
+    {
+        return !m_fds.empty();
+    }
+
+    void start() noexcept
+    {
+#if defined(__linux__)
+        if (available())
+        {
+            ioctl(leader(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    /**
+     * @brief   Stops the counters and adds the counted values, the values are scaled if the
+     *          events were multiplexed.
+     */
+    void stop() noexcept
+    {
+#if defined(__linux__)
+        if (!available())
+        {
+            return;
+        }
+        ioctl(leader(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // The layout: the number of events, time enabled, time running, the values.
+        std::array<std::uint64_t, 3 + std::size(s_events)> data {};
+        const auto size = static_cast<ssize_t>((3 + std::size(m_fds)) * sizeof(std::uint64_t));
+        if (size != read(leader(), data.data(), static_cast<std::size_t>(size)))
+        {
+            return;
+        }
+        const auto scale = 0 == data[2] ? 0.0 : static_cast<double>(data[1]) / static_cast<double>(data[2]);
+        for (std::size_t i = 0; i < std::size(m_values); ++i)
+        {
+            m_values[i] += static_cast<double>(data[3 + i]) * scale;
+        }
+#endif
+    }
+
+    /**
+     * @brief   Reports the counted values per iteration as the benchmark user counters.
+     */
+    void report(benchmark::State& state) const
+    {
+        for (std::size_t i = 0; i < std::size(m_values); ++i)
+        {
+            state.counters[std::string {m_names[i]}] = benchmark::Counter {
+                m_values[i], benchmark::Counter::kAvgIterations};
+        }
+    }
+
+private:
+
+    [[nodiscard]]
+    int leader() const noexcept
+    {
+        return m_fds.empty() ? -1 : m_fds.front();
+    }
+
+private:
+    std::vector<int> m_fds;
+    std::vector<std::string_view> m_names;
+    std::vector<double> m_values;
+};
+
+}
@@ -1,11 +1,17 @@
 #include <benchmark/benchmark.h>
 
-#include <unordered_set>
+#include <map>
 
+#include "AggregateQuadTree.h"
+#include "AllocationCounter.h"
 #include "Utils.h"
+#include "BenchmarkMain.h"
+#include "Distributions.h"
+#include "PerfCounters.h"
 
 constexpr auto s_shapeCount = 8 << 13;
-constexpr auto s_testCount = 8 << 20;
+constexpr auto s_queryCount = 8 << 10;
+constexpr auto s_queriesPerIteration = 512;
 
 using TCrt = int32_t;
 using point = boost::geometry::model::point<TCrt, 2, boost::geometry::cs::cartesian>;
@@ -15,8 +21,22 @@ using value = std::pair<box, bool>;
 class DataStorage
 {
     static constexpr auto s_maxPos = 1'000'000;
-    static constexpr auto s_maxRectWidth = 1'000;
-    static constexpr auto s_maxRectHeight = 1'000;
+    static constexpr auto s_maxRectSize = 1'000;
+    static constexpr auto s_querySeed = test_util::s_defaultSeed + 1;
+
+    struct Data
+    {
+        boost::geometry::index::rtree<value, boost::geometry::index::quadratic<16>> boostIndex;
+        space::QuadTree<space::Rect<TCrt>> spaceIndex;
+        space::CompactQuadTree<space::Rect<TCrt>> spaceCompactIndex;
+    };
+
+    struct Queries
+    {
+        std::vector<box> boostQueryBoxList;
+        std::vector<space::Rect<TCrt>> spaceQueryBoxList;
+    };
+
 public:
     static DataStorage& Instance()
     {
@@ -31,129 +51,383 @@ public:
 
 public:
 
-    const auto& BoostIndex() const noexcept
+    const auto& BoostIndex(test_util::Distribution distribution, int64_t count)
     {
-        return m_boostIndex;
+        return DataOf(distribution, count).boostIndex;
     }
 
-    const auto& SpaceIndex() const noexcept
+    const auto& SpaceIndex(test_util::Distribution distribution, int64_t count)
     {
-        return m_spaceIndex;
+        return DataOf(distribution, count).spaceIndex;
     }
 
-    const auto& BoostQueryBoxList() const noexcept
+    const auto& SpaceCompactIndex(test_util::Distribution distribution, int64_t count)
     {
-        return m_boostQueryBoxList;
+        return DataOf(distribution, count).spaceCompactIndex;
     }
 
-    const auto& SpaceQueryBoxList() const noexcept
+    const auto& BoostQueryBoxList(test_util::Distribution distribution)
     {
-        return m_spaceQueryBoxList;
+        return QueriesOf(distribution, s_maxRectSize).boostQueryBoxList;
+    }
+
+    /**
+     * @brief   The query windows up to the given size, by default as large as the data rects.
+     */
+    const auto& SpaceQueryBoxList(test_util::Distribution distribution, int64_t maxQuerySize = s_maxRectSize)
+    {
+        return QueriesOf(distribution, maxQuerySize).spaceQueryBoxList;
     }
 
 private:
 
-    DataStorage()
-    {
-        const auto initialRects = getRandomRectList(s_shapeCount);
+    DataStorage() = default;
 
-        for (auto&& rect : initialRects)
+    /**
+     * @brief   The index with the first count rects of the distribution.
+     */
+    const Data& DataOf(test_util::Distribution distribution, int64_t count)
+    {
+        const auto key = std::make_pair(distribution, count);
+        auto it = m_data.find(key);
+        if (std::end(m_data) != it)
         {
-            m_spaceIndex.insert(rect);
-            const auto boostRect = test_util::spaceToBoostRect(rect);
-            m_boostIndex.insert(std::make_pair(boostRect, false));
+            return it->second;
         }
 
-        m_spaceQueryBoxList.reserve(s_testCount);
-        m_boostQueryBoxList.reserve(s_testCount);
-
-        for (auto&& rect : getRandomRectList(s_testCount))
+        auto& data = m_data[key];
+        const auto rects = test_util::generateRects<TCrt>(
+            distribution, static_cast<std::size_t>(count), s_maxPos, s_maxRectSize);
+        for (auto&& rect : rects)
         {
-            m_spaceQueryBoxList.push_back(rect);
-            const auto boostRect = test_util::spaceToBoostRect(rect);
-            m_boostQueryBoxList.push_back(boostRect);
+            data.spaceIndex.insert(rect);
+            data.spaceCompactIndex.insert(rect);
+            data.boostIndex.insert(std::make_pair(test_util::spaceToBoostRect(rect), false));
         }
+        return data;
     }
 
-    std::set<space::Rect<TCrt>> getRandomRectList(size_t count)
+    /**
+     * @brief   The queries follow the data distribution, so the hot areas are queried more.
+     */
+    const Queries& QueriesOf(test_util::Distribution distribution, int64_t maxQuerySize)
     {
-        std::set<space::Rect<TCrt>> rects;
-
-        while (rects.size() != count)
+        const auto key = std::make_pair(distribution, maxQuerySize);
+        auto it = m_queries.find(key);
+        if (std::end(m_queries) != it)
         {
-            const auto rect = test_util::getRandRect(s_maxPos, s_maxRectWidth, s_maxRectHeight);
-            rects.insert(rect);
+            return it->second;
         }
 
-        return rects;
+        auto& queries = m_queries[key];
+        queries.spaceQueryBoxList = test_util::generateRects<TCrt>(
+            distribution, s_queryCount, s_maxPos, static_cast<TCrt>(maxQuerySize), s_querySeed);
+        for (auto&& rect : queries.spaceQueryBoxList)
+        {
+            queries.boostQueryBoxList.push_back(test_util::spaceToBoostRect(rect));
+        }
+        return queries;
     }
 
 private:
-    boost::geometry::index::rtree<value, boost::geometry::index::quadratic<16>> m_boostIndex;
-    space::QuadTree<space::Rect<TCrt>> m_spaceIndex;
-    std::vector<box> m_boostQueryBoxList;
-    std::vector<space::Rect<TCrt>> m_spaceQueryBoxList;
+    std::map<std::pair<test_util::Distribution, int64_t>, Data> m_data;
+    std::map<std::pair<test_util::Distribution, int64_t>, Queries> m_queries;
 };
 
 static void BoostSpaceIndexQuery(benchmark::State& state)
 {
-    const auto& index = DataStorage::Instance().BoostIndex();
-    const auto& queryList = DataStorage::Instance().BoostQueryBoxList();
-
-    const auto count = state.range(0);
+    const auto distribution = static_cast<test_util::Distribution>(state.range(0));
+    const auto& index = DataStorage::Instance().BoostIndex(distribution, state.range(1));
+    const auto& queryList = DataStorage::Instance().BoostQueryBoxList(distribution);
+    state.SetLabel(std::string {test_util::nameOf(distribution)});
 
     std::vector<value> rTreeQueryRes;
     rTreeQueryRes.reserve(s_shapeCount);
 
+    test_util::PerfCounters perfCounters;
+    test_util::AllocationStatistics allocations;
+    std::size_t next = 0;
     for (auto _ : state)
     {
-        for (int i = 0; i < count; ++i)
+        const test_util::AllocationScope allocationScope;
+        perfCounters.start();
+        for (int i = 0; i < s_queriesPerIteration; ++i)
         {
-            index.query(boost::geometry::index::intersects(queryList[i]), std::back_inserter(rTreeQueryRes));
-            state.PauseTiming();
+            index.query(boost::geometry::index::intersects(queryList[next]), std::back_inserter(rTreeQueryRes));
+            next = (next + 1) % std::size(queryList);
             rTreeQueryRes.clear();
-            state.ResumeTiming();
         }
+        perfCounters.stop();
+        allocations += allocationScope.statistics();
     }
+    perfCounters.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_queriesPerIteration);
+    state.counters["allocs_per_query"] = static_cast<double>(allocations.allocations)
+                                         / (static_cast<double>(state.iterations()) * s_queriesPerIteration);
     benchmark::DoNotOptimize(rTreeQueryRes);
 }
 
-BENCHMARK(BoostSpaceIndexQuery)->Range(512, s_testCount);
+BENCHMARK(BoostSpaceIndexQuery)->ArgsProduct({test_util::allDistributions()
+                                              , benchmark::CreateRange(1 << 10, s_shapeCount, 8)});
 
-static void SpaceQuadTreeQuery(benchmark::State& state)
+template <typename TIndexGetter>
+static void SpaceIndexQuery(benchmark::State& state, TIndexGetter indexGetter)
 {
-    const auto& index = DataStorage::Instance().SpaceIndex();
-    const auto& queryList = DataStorage::Instance().SpaceQueryBoxList();
-
-    const auto count = state.range(0);
+    const auto distribution = static_cast<test_util::Distribution>(state.range(0));
+    const auto& index = indexGetter(distribution, state.range(1));
+    const auto& queryList = DataStorage::Instance().SpaceQueryBoxList(distribution);
+    state.SetLabel(std::string {test_util::nameOf(distribution)});
 
     std::vector<space::Rect<TCrt>> quadTreeQueryRes;
     quadTreeQueryRes.reserve(s_shapeCount);
 
+    test_util::PerfCounters perfCounters;
+    test_util::AllocationStatistics allocations;
+    std::size_t next = 0;
     for (auto _ : state)
     {
-        for (int i = 0; i < count; ++i)
+        const test_util::AllocationScope allocationScope;
+        perfCounters.start();
+        for (int i = 0; i < s_queriesPerIteration; ++i)
         {
-            index.query(queryList[i], std::back_inserter(quadTreeQueryRes));
-            state.PauseTiming();
+            index.query(queryList[next], std::back_inserter(quadTreeQueryRes));
+            next = (next + 1) % std::size(queryList);
             quadTreeQueryRes.clear();
-            state.ResumeTiming();
         }
+        perfCounters.stop();
+        allocations += allocationScope.statistics();
     }
+    perfCounters.report(state);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_queriesPerIteration);
+    state.counters["allocs_per_query"] = static_cast<double>(allocations.allocations)
+                                         / (static_cast<double>(state.iterations()) * s_queriesPerIteration);
     benchmark::DoNotOptimize(quadTreeQueryRes);
 }
 
-BENCHMARK(SpaceQuadTreeQuery)->Range(512, s_testCount);
+static void SpaceQuadTreeQuery(benchmark::State& state)
+{
+    SpaceIndexQuery(state, [](test_util::Distribution distribution, int64_t count) -> const auto&
+    {
+        return DataStorage::Instance().SpaceIndex(distribution, count);
+    });
+}
 
-int main(int argc, char** argv)
+BENCHMARK(SpaceQuadTreeQuery)->ArgsProduct({test_util::allDistributions()
+                                            , benchmark::CreateRange(1 << 10, s_shapeCount, 8)});
+
+static void SpaceCompactQuadTreeQuery(benchmark::State& state)
+{
+    SpaceIndexQuery(state, [](test_util::Distribution distribution, int64_t count) -> const auto&
+    {
+        return DataStorage::Instance().SpaceCompactIndex(distribution, count);
+    });
+}
+
+BENCHMARK(SpaceCompactQuadTreeQuery)->ArgsProduct({test_util::allDistributions()
+                                                   , benchmark::CreateRange(1 << 10, s_shapeCount, 8)});
+
+/**
+ * @brief   Counts the traversal work of the queries: the visited and pruned nodes and the
+ *          tested values per query.
+ */
+static void SpaceQuadTreeQueryWork(benchmark::State& state)
+{
+    using instrumentation_type = space::CountingQueryInstrumentation;
+    using key_type = space::Rect<TCrt>;
+    using index_type = space::QuadTree<key_type, space::FlatNodeStorage<key_type>, instrumentation_type>;
+
+    const auto distribution = static_cast<test_util::Distribution>(state.range(0));
+    const auto count = state.range(1);
+    static std::map<std::pair<test_util::Distribution, int64_t>, index_type> s_indexes;
+    auto& index = s_indexes[std::make_pair(distribution, count)];
+    if (index.empty())
+    {
+        for (const auto& rect : test_util::generateRects<TCrt>(distribution, static_cast<std::size_t>(count), 1'000'000, 1'000))
+        {
+            index.insert(rect);
+        }
+    }
+    const auto& queryList = DataStorage::Instance().SpaceQueryBoxList(distribution);
+    state.SetLabel(std::string {test_util::nameOf(distribution)});
+
+    std::vector<key_type> quadTreeQueryRes;
+    quadTreeQueryRes.reserve(s_shapeCount);
+
+    instrumentation_type::reset();
+    std::size_t next = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < s_queriesPerIteration; ++i)
+        {
+            index.query(queryList[next], std::back_inserter(quadTreeQueryRes));
+            next = (next + 1) % std::size(queryList);
+            quadTreeQueryRes.clear();
+        }
+    }
+    const auto counters = instrumentation_type::threadCounters();
+    const auto queries = static_cast<double>(counters.queries);
+    state.counters["nodes_visited_per_query"] = static_cast<double>(counters.nodesVisited) / queries;
+    state.counters["nodes_pruned_per_query"] = static_cast<double>(counters.nodesPruned) / queries;
+    state.counters["values_tested_per_query"] = static_cast<double>(counters.valuesTested) / queries;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_queriesPerIteration);
+}
+
+BENCHMARK(SpaceQuadTreeQueryWork)->ArgsProduct({{static_cast<int64_t>(test_util::Distribution::Uniform)
+                                                 , static_cast<int64_t>(test_util::Distribution::Clustered)}
+                                                , benchmark::CreateRange(1 << 10, s_shapeCount, 8)});
+
+/**
+ * @brief   Counts the query results without reporting them: the second argument is the
+ *          maximum query window size, the large windows cover whole subtrees which are
+ *          counted without descending. The third argument is the estimation depth, 0 for the
+ *          exact count.
+ */
+static void SpaceQuadTreeCount(benchmark::State& state)
 {
-    auto& dataStorage = DataStorage::Instance();
-    ::benchmark::Initialize(&argc, argv);
-    if (::benchmark::ReportUnrecognizedArguments(argc, argv))
+    const auto distribution = static_cast<test_util::Distribution>(state.range(0));
+    const auto maxQuerySize = state.range(1);
+    const auto depth = static_cast<std::size_t>(state.range(2));
+    const auto& index = DataStorage::Instance().SpaceIndex(distribution, s_shapeCount);
+    const auto& queryList = DataStorage::Instance().SpaceQueryBoxList(distribution, maxQuerySize);
+    state.SetLabel(std::string {test_util::nameOf(distribution)});
+
+    double total = 0.0;
+    std::size_t next = 0;
+    for (auto _ : state)
     {
-        return 1;
+        for (int i = 0; i < s_queriesPerIteration; ++i)
+        {
+            total += 0 == depth ? static_cast<double>(index.count(queryList[next]))
+                                : index.estimateCount(queryList[next], depth);
+            next = (next + 1) % std::size(queryList);
+        }
     }
-    ::benchmark::RunSpecifiedBenchmarks();
+    benchmark::DoNotOptimize(total);
+
+    double relativeError = 0.0;
+    for (const auto& query : queryList)
+    {
+        const auto exact = static_cast<double>(index.count(query));
+        const auto estimate = 0 == depth ? exact : index.estimateCount(query, depth);
+        relativeError += std::abs(estimate - exact) / std::max(1.0, exact);
+    }
+    state.counters["mean_relative_error"] = relativeError / static_cast<double>(std::size(queryList));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_queriesPerIteration);
+}
+
+BENCHMARK(SpaceQuadTreeCount)->ArgsProduct({test_util::allDistributions(), {1'000, 10'000, 100'000}, {0, 2, 4, 8}});
+
+/**
+ * @brief   Sums the areas of the rects intersecting the queries: the second argument is the
+ *          maximum query window size, the large windows cover whole subtrees which summaries
+ *          are taken without descending. The third argument is 0 to query the rects and fold
+ *          them, 1 to aggregate the area summaries.
+ */
+static void SpaceQuadTreeSum(benchmark::State& state)
+{
+    using key_type = space::Rect<TCrt>;
+    using aggregate_index_type = space::AggregateQuadTree<key_type, int64_t>;
+    auto areaOf = [](const key_type& rect)
+    {
+        return static_cast<int64_t>(rect.width()) * rect.height();
+    };
+
+    const auto distribution = static_cast<test_util::Distribution>(state.range(0));
+    const auto maxQuerySize = state.range(1);
+    const auto aggregated = 1 == state.range(2);
+    const auto& index = DataStorage::Instance().SpaceIndex(distribution, s_shapeCount);
+    static std::map<test_util::Distribution, aggregate_index_type> s_aggregateIndexes;
+    auto& aggregateIndex = s_aggregateIndexes[distribution];
+    std::vector<key_type> quadTreeQueryRes;
+    if (aggregateIndex.empty())
+    {
+        index.query(key_type {{0, 0}, std::numeric_limits<TCrt>::max(), std::numeric_limits<TCrt>::max()}
+                    , std::back_inserter(quadTreeQueryRes));
+        for (const auto& rect : quadTreeQueryRes)
+        {
+            aggregateIndex.insert(rect, areaOf(rect));
+        }
+    }
+    const auto& queryList = DataStorage::Instance().SpaceQueryBoxList(distribution, maxQuerySize);
+    state.SetLabel(std::string {test_util::nameOf(distribution)} + (aggregated ? "/aggregate" : "/fold"));
+
+    int64_t total = 0;
+    std::size_t next = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < s_queriesPerIteration; ++i)
+        {
+            if (aggregated)
+            {
+                total += aggregateIndex.aggregate(queryList[next]);
+            }
+            else
+            {
+                quadTreeQueryRes.clear();
+                index.query(queryList[next], std::back_inserter(quadTreeQueryRes));
+                for (const auto& rect : quadTreeQueryRes)
+                {
+                    total += areaOf(rect);
+                }
+            }
+            next = (next + 1) % std::size(queryList);
+        }
+    }
+    benchmark::DoNotOptimize(total);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_queriesPerIteration);
+}
+
+BENCHMARK(SpaceQuadTreeSum)->ArgsProduct({test_util::allDistributions(), {1'000, 10'000, 100'000}, {0, 1}});
+
+/**
+ * @brief   Samples 16 values from the query windows: the second argument is the maximum query
+ *          window size, the large windows have more than twice the sample size matches, so
+ *          QuadTree::sample draws the indices with the rejection instead of the shuffle. The
+ *          third argument is 0 to query all matches and sample them, 1 to use QuadTree::sample.
+ */
+static void SpaceQuadTreeSample(benchmark::State& state)
+{
+    static constexpr std::size_t s_sampleSize = 16;
+
+    const auto distribution = static_cast<test_util::Distribution>(state.range(0));
+    const auto maxQuerySize = state.range(1);
+    const auto indexSample = 1 == state.range(2);
+    const auto& index = DataStorage::Instance().SpaceIndex(distribution, s_shapeCount);
+    const auto& queryList = DataStorage::Instance().SpaceQueryBoxList(distribution, maxQuerySize);
+    state.SetLabel(std::string {test_util::nameOf(distribution)} + (indexSample ? "/sample" : "/query"));
+
+    std::mt19937_64 engine {test_util::s_defaultSeed};
+    std::vector<space::Rect<TCrt>> quadTreeQueryRes;
+    std::vector<space::Rect<TCrt>> samples;
+    std::size_t next = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < s_queriesPerIteration; ++i)
+        {
+            samples.clear();
+            if (indexSample)
+            {
+                index.sample(queryList[next], s_sampleSize, engine, std::back_inserter(samples));
+            }
+            else
+            {
+                quadTreeQueryRes.clear();
+                index.query(queryList[next], std::back_inserter(quadTreeQueryRes));
+                std::sample(std::begin(quadTreeQueryRes), std::end(quadTreeQueryRes)
+                            , std::back_inserter(samples), s_sampleSize, engine);
+            }
+            next = (next + 1) % std::size(queryList);
+        }
+    }
+    benchmark::DoNotOptimize(samples);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_queriesPerIteration);
+}
+
+BENCHMARK(SpaceQuadTreeSample)->ArgsProduct({test_util::allDistributions(), {1'000, 10'000, 100'000}, {0, 1}});
+
+int main(int argc, char** argv)
+{
+    return test_util::runBenchmarks(argc, argv);
 }
 
 // BENCHMARK_MAIN();
@@ -0,0 +1,195 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "Utils.h"
+#include "BenchmarkMain.h"
+#include "Distributions.h"
+#include "LatencyHistogram.h"
+#include "QuadTreeTrace.h"
+
+using TCrt = int32_t;
+using key_type = space::Rect<TCrt>;
+using record_type = space::io::TraceRecord<key_type>;
+
+/**
+ * @brief   The replayed trace: the file from SPACE_TRACE_FILE environment variable, or the
+ *          trace recorded from the synthetic clustered workload if it is not set.
+ */
+class TraceStorage
+{
+    static constexpr auto s_keyCount = 8 << 13;
+    static constexpr auto s_queryCount = 8 << 13;
+    static constexpr auto s_maxPos = 1'000'000;
+    static constexpr auto s_maxRectSize = 1'000;
+
+public:
+    static TraceStorage& Instance()
+    {
+        static TraceStorage s_instance;
+        return s_instance;
+    }
+
+    TraceStorage(TraceStorage&&) = delete;
+    TraceStorage(const TraceStorage&) = delete;
+    TraceStorage operator=(TraceStorage&&) = delete;
+    TraceStorage operator=(const TraceStorage&) = delete;
+
+public:
+
+    const auto& Records() const noexcept
+    {
+        return m_records;
+    }
+
+private:
+
+    TraceStorage()
+    {
+        std::vector<std::byte> data;
+        if (const auto* path = std::getenv("SPACE_TRACE_FILE"); nullptr != path)
+        {
+            std::ifstream is {path, std::ios::binary};
+            if (!is)
+            {
+                throw std::runtime_error {std::string {"Failed to open the trace "} + path};
+            }
+            data = space::io::readAll(is);
+        }
+        else
+        {
+            data = recordSyntheticTrace();
+        }
+        space::io::forEachTraceRecord<key_type>(data, [this](const record_type& record)
+        {
+            m_records.push_back(record);
+        }, true);
+    }
+
+    static std::vector<std::byte> recordSyntheticTrace()
+    {
+        const auto keys = test_util::generateRects<TCrt>(
+            test_util::Distribution::Clustered, s_keyCount, s_maxPos, s_maxRectSize);
+        const auto queries = test_util::generateRects<TCrt>(
+            test_util::Distribution::Clustered, s_queryCount, s_maxPos, s_maxRectSize, test_util::s_defaultSeed + 1);
+
+        std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+        space::QuadTree<key_type> index;
+        space::IndexRecorder recorder {index, stream};
+        std::vector<key_type> result;
+        for (std::size_t i = 0; i < std::size(keys); ++i)
+        {
+            recorder.insert(keys[i]);
+            if (0 == i % 4)
+            {
+                result.clear();
+                recorder.query(queries[i], std::back_inserter(result));
+                static_cast<void>(recorder.contains(keys[i / 2]));
+            }
+            if (0 == i % 8)
+            {
+                recorder.remove(keys[i / 4]);
+            }
+        }
+        recorder.flush();
+        return space::io::readAll(stream);
+    }
+
+private:
+    std::vector<record_type> m_records;
+};
+
+/**
+ * @brief   Replays the trace against the new index in every iteration, the argument is 0 to
+ *          run at the full speed or 1 to keep the original timing between operations.
+ */
+template <typename TIndex>
+void replay(benchmark::State& state)
+{
+    const auto& records = TraceStorage::Instance().Records();
+    const auto originalTiming = 0 != state.range(0);
+    state.SetLabel(originalTiming ? "original_timing" : "full_speed");
+
+    std::array<test_util::LatencyHistogram, 4> histograms {};
+    std::vector<key_type> result;
+    std::size_t found = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto index = std::make_unique<TIndex>();
+        state.ResumeTiming();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& record : records)
+        {
+            if (originalTiming)
+            {
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds {record.timestamp});
+            }
+            const auto operationStart = std::chrono::steady_clock::now();
+            switch (record.operation)
+            {
+                case space::io::TraceOperation::Insert:
+                    index->insert(record.key);
+                    break;
+                case space::io::TraceOperation::Remove:
+                    index->remove(record.key);
+                    break;
+                case space::io::TraceOperation::Query:
+                    result.clear();
+                    index->query(record.key, std::back_inserter(result));
+                    found += std::size(result);
+                    break;
+                case space::io::TraceOperation::Contains:
+                    found += index->contains(record.key) ? 1 : 0;
+                    break;
+            }
+            const auto elapsed = std::chrono::steady_clock::now() - operationStart;
+            histograms[static_cast<std::size_t>(record.operation) - 1].record(
+                static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        state.PauseTiming();
+        index.reset();
+        state.ResumeTiming();
+    }
+    benchmark::DoNotOptimize(found);
+
+    static constexpr std::array<std::string_view, 4> s_names {"insert", "remove", "query", "contains"};
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(std::size(records)));
+    for (std::size_t i = 0; i < std::size(histograms); ++i)
+    {
+        if (0 == histograms[i].count())
+        {
+            continue;
+        }
+        const std::string name {s_names[i]};
+        state.counters[name + "_p50_ns"] = static_cast<double>(histograms[i].percentile(0.5));
+        state.counters[name + "_p99_ns"] = static_cast<double>(histograms[i].percentile(0.99));
+        state.counters[name + "_p999_ns"] = static_cast<double>(histograms[i].percentile(0.999));
+    }
+}
+
+static void ReplayQuadTree(benchmark::State& state)
+{
+    replay<space::QuadTree<key_type>>(state);
+}
+
+static void ReplayCompactQuadTree(benchmark::State& state)
+{
+    replay<space::CompactQuadTree<key_type>>(state);
+}
+
+BENCHMARK(ReplayQuadTree)->Arg(0)->UseRealTime();
+BENCHMARK(ReplayQuadTree)->Arg(1)->Iterations(1)->UseRealTime();
+BENCHMARK(ReplayCompactQuadTree)->Arg(0)->UseRealTime();
+BENCHMARK(ReplayCompactQuadTree)->Arg(1)->Iterations(1)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+    return test_util::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+
+#include "Utils.h"
+#include "BenchmarkMain.h"
+#include "Wkb.h"
+
+constexpr auto s_polygonCount = 8 << 10;
+
+using TCrt = double;
+
+class DataStorage
+{
+    static constexpr auto s_maxPos = 1'000'000;
+    static constexpr auto s_maxHoles = 4;
+public:
+    static DataStorage& Instance()
+    {
+        static DataStorage s_instance;
+        return s_instance;
+    }
+
+    DataStorage(DataStorage&&) = delete;
+    DataStorage(const DataStorage&) = delete;
+    DataStorage operator=(DataStorage&&) = delete;
+    DataStorage operator=(const DataStorage&) = delete;
+
+public:
+
+    const auto& Polygons() const noexcept
+    {
+        return m_polygons;
+    }
+
+    const auto& Buffer() const noexcept
+    {
+        return m_buffer;
+    }
+
+private:
+
+    DataStorage()
+    {
+        m_polygons.reserve(s_polygonCount);
+        for (int i = 0; i < s_polygonCount; ++i)
+        {
+            std::vector<space::SimplePolygon<TCrt>> holes;
+            for (int j = test_util::rand(0, s_maxHoles); j > 0; --j)
+            {
+                holes.push_back(getRandSimplePolygon(test_util::rand(3, 16)));
+            }
+            m_polygons.emplace_back(getRandSimplePolygon(test_util::rand(3, 256)), std::move(holes));
+            space::io::writeWkb(m_polygons.back(), m_buffer);
+        }
+    }
+
+    static space::SimplePolygon<TCrt> getRandSimplePolygon(int numOfPoints)
+    {
+        std::vector<space::Point<TCrt>> curve;
+        curve.reserve(static_cast<size_t>(numOfPoints));
+        for (int i = 0; i < numOfPoints; ++i)
+        {
+            curve.emplace_back(test_util::rand(0, s_maxPos), test_util::rand(0, s_maxPos));
+        }
+        return space::SimplePolygon<TCrt> {std::move(curve)};
+    }
+
+private:
+    std::vector<space::Polygon<TCrt>> m_polygons;
+    std::vector<std::byte> m_buffer;
+};
+
+static void SpaceWkbDecode(benchmark::State& state)
+{
+    const auto& buffer = DataStorage::Instance().Buffer();
+
+    for (auto _ : state)
+    {
+        size_t numOfPoints = 0;
+        space::io::forEachWkb<space::Polygon<TCrt>>(std::span {buffer}, [&numOfPoints](const auto& polygon)
+        {
+            numOfPoints += polygon.boundary().boundaryCurve().size();
+        });
+        benchmark::DoNotOptimize(numOfPoints);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(buffer.size()));
+}
+
+BENCHMARK(SpaceWkbDecode);
+
+static void SpaceWkbDecodeToNewPolygons(benchmark::State& state)
+{
+    const auto& buffer = DataStorage::Instance().Buffer();
+
+    std::vector<space::Polygon<TCrt>> polygons;
+    polygons.reserve(s_polygonCount);
+    for (auto _ : state)
+    {
+        std::span<const std::byte> data {buffer};
+        while (!data.empty())
+        {
+            data = data.subspan(space::io::readWkb(data, polygons.emplace_back()));
+        }
+        state.PauseTiming();
+        polygons.clear();
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(buffer.size()));
+}
+
+BENCHMARK(SpaceWkbDecodeToNewPolygons);
+
+static void SpaceWkbEncode(benchmark::State& state)
+{
+    const auto& polygons = DataStorage::Instance().Polygons();
+
+    std::vector<std::byte> buffer;
+    buffer.reserve(DataStorage::Instance().Buffer().size());
+    for (auto _ : state)
+    {
+        buffer.clear();
+        for (const auto& polygon : polygons)
+        {
+            space::io::writeWkb(polygon, buffer);
+        }
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(buffer.size()));
+}
+
+BENCHMARK(SpaceWkbEncode);
+
+int main(int argc, char** argv)
+{
+    auto& dataStorage = DataStorage::Instance();
+    benchmark::DoNotOptimize(dataStorage);
+    return test_util::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,391 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#include <boost/geometry.hpp>
+
+#include "Utils.h"
+#include "BenchmarkMain.h"
+#include "Distributions.h"
+#include "LatencyHistogram.h"
+
+constexpr auto s_initialSize = 8 << 13;
+constexpr auto s_operationCount = 8 << 13;
+
+using TCrt = int32_t;
+using point = boost::geometry::model::point<TCrt, 2, boost::geometry::cs::cartesian>;
+using box = boost::geometry::model::box<point>;
+using value = std::pair<box, bool>;
+
+enum class OperationType : std::size_t
+{
+    Insert = 0
+    , Remove
+    , Update
+    , Query
+};
+
+constexpr std::array<std::string_view, 4> s_operationNames {"insert", "remove", "update", "query"};
+
+struct Operation
+{
+    OperationType type;
+    space::Rect<TCrt> key;
+    space::Rect<TCrt> other; // The new key for Update, unused otherwise.
+};
+
+/**
+ * @brief   The ratios of operations in percents.
+ */
+struct OperationMix
+{
+    std::string_view name;
+    std::array<int, 4> percents;
+};
+
+constexpr std::array<OperationMix, 3> s_mixes {
+    OperationMix {"read_heavy", {5, 4, 1, 90}}
+    , OperationMix {"balanced", {20, 20, 10, 50}}
+    , OperationMix {"write_heavy", {40, 40, 10, 10}}};
+
+/**
+ * @brief   The workload: the initial keys and the sequences of operations of every thread
+ *          generated with the fixed seed. The threads own the disjoint sets of keys, so the
+ *          removed and updated keys of every thread are always present at that point of its
+ *          sequence, regardless of the interleaving with the other threads.
+ */
+struct Workload
+{
+    std::vector<space::Rect<TCrt>> initialKeys;
+    std::vector<std::vector<Operation>> threadOperations;
+};
+
+/**
+ * @brief   Generates the sequence of operations over the given live keys, the inserted keys
+ *          are taken from the fresh keys.
+ */
+template <typename TFreshIt>
+std::vector<Operation> makeOperations(const OperationMix& mix, std::vector<space::Rect<TCrt>> live
+    , TFreshIt nextFresh, std::size_t operationCount, TCrt queryWindowSize, std::mt19937_64& engine)
+{
+    std::discrete_distribution<std::size_t> type {std::begin(mix.percents), std::end(mix.percents)};
+    auto takeLive = [&]()
+    {
+        const auto index = std::uniform_int_distribution<std::size_t> {0, std::size(live) - 1}(engine);
+        std::swap(live[index], live.back());
+        const auto key = live.back();
+        live.pop_back();
+        return key;
+    };
+
+    std::vector<Operation> operations;
+    operations.reserve(operationCount);
+    while (std::size(operations) != operationCount)
+    {
+        auto operationType = static_cast<OperationType>(type(engine));
+        if (live.empty() && OperationType::Query != operationType)
+        {
+            operationType = OperationType::Insert;
+        }
+        switch (operationType)
+        {
+            case OperationType::Insert:
+                live.push_back(*nextFresh++);
+                operations.push_back({operationType, live.back(), {}});
+                break;
+            case OperationType::Remove:
+                operations.push_back({operationType, takeLive(), {}});
+                break;
+            case OperationType::Update:
+            {
+                const auto key = takeLive();
+                live.push_back(*nextFresh++);
+                operations.push_back({operationType, key, live.back()});
+                break;
+            }
+            case OperationType::Query:
+            {
+                // The windows are centered at the data, so the hot areas are queried more.
+                const auto center = live.empty() ? space::Point<TCrt> {0, 0} : live[
+                    std::uniform_int_distribution<std::size_t> {0, std::size(live) - 1}(engine)].pos();
+                const space::Point<TCrt> pos {std::max(0, center.x() - queryWindowSize / 2)
+                                              , std::max(0, center.y() - queryWindowSize / 2)};
+                operations.push_back({operationType, {pos, queryWindowSize, queryWindowSize}, {}});
+                break;
+            }
+        }
+    }
+    return operations;
+}
+
+/**
+ * @brief   Generates the workload, the initial keys and the operations are split between the
+ *          threads evenly.
+ */
+Workload makeWorkload(const OperationMix& mix, test_util::Distribution distribution, TCrt queryWindowSize
+    , std::size_t threadCount)
+{
+    static constexpr auto s_maxPos = 1'000'000;
+    static constexpr auto s_maxRectSize = 1'000;
+
+    auto keys = test_util::generateRects<TCrt>(
+        distribution, s_initialSize + s_operationCount, s_maxPos, s_maxRectSize);
+    Workload workload;
+    workload.initialKeys.assign(std::begin(keys), std::next(std::begin(keys), s_initialSize));
+
+    std::mt19937_64 engine {test_util::s_defaultSeed};
+    auto nextFresh = std::next(std::begin(keys), s_initialSize);
+    for (std::size_t thread = 0; thread < threadCount; ++thread)
+    {
+        std::vector<space::Rect<TCrt>> live;
+        for (auto i = thread; i < std::size(workload.initialKeys); i += threadCount)
+        {
+            live.push_back(workload.initialKeys[i]);
+        }
+        // Every operation inserts at most one fresh key.
+        const auto operationCount = s_operationCount / threadCount + (thread < s_operationCount % threadCount ? 1 : 0);
+        workload.threadOperations.push_back(
+            makeOperations(mix, std::move(live), nextFresh, operationCount, queryWindowSize, engine));
+        nextFresh = std::next(nextFresh, static_cast<std::ptrdiff_t>(operationCount));
+    }
+    return workload;
+}
+
+/**
+ * @brief   The lock of the shared index, does nothing for the single-threaded runs.
+ */
+class IndexLock
+{
+public:
+    explicit IndexLock(bool enabled)
+        : m_enabled {enabled}
+    {
+    }
+
+    template <typename TFunc>
+    void exclusive(TFunc&& func)
+    {
+        if (!m_enabled)
+        {
+            return func();
+        }
+        std::unique_lock lock {m_mutex};
+        func();
+    }
+
+    template <typename TFunc>
+    void shared(TFunc&& func)
+    {
+        if (!m_enabled)
+        {
+            return func();
+        }
+        std::shared_lock lock {m_mutex};
+        func();
+    }
+
+private:
+    bool m_enabled;
+    std::shared_mutex m_mutex;
+};
+
+class SpaceQuadTreeAdapter
+{
+public:
+    void insert(const space::Rect<TCrt>& key)
+    {
+        m_index.insert(key);
+    }
+
+    void remove(const space::Rect<TCrt>& key)
+    {
+        m_index.remove(key);
+    }
+
+    std::size_t query(const space::Rect<TCrt>& window, std::vector<space::Rect<TCrt>>& result) const
+    {
+        result.clear();
+        m_index.query(window, std::back_inserter(result));
+        return std::size(result);
+    }
+
+private:
+    space::QuadTree<space::Rect<TCrt>> m_index;
+};
+
+class BoostRTreeAdapter
+{
+    /**
+     * @brief   Compares the boxes by coordinates, boost::geometry::equals is not implemented
+     *          for the integral boxes.
+     */
+    struct ValueEqual
+    {
+        bool operator()(const value& first, const value& second) const noexcept
+        {
+            return test_util::boostToSpaceRect(first.first) == test_util::boostToSpaceRect(second.first)
+                   && first.second == second.second;
+        }
+    };
+
+public:
+    void insert(const space::Rect<TCrt>& key)
+    {
+        m_index.insert(std::make_pair(test_util::spaceToBoostRect(key), false));
+    }
+
+    void remove(const space::Rect<TCrt>& key)
+    {
+        m_index.remove(std::make_pair(test_util::spaceToBoostRect(key), false));
+    }
+
+    std::size_t query(const space::Rect<TCrt>& window, std::vector<value>& result) const
+    {
+        result.clear();
+        m_index.query(boost::geometry::index::intersects(test_util::spaceToBoostRect(window))
+                      , std::back_inserter(result));
+        return std::size(result);
+    }
+
+private:
+    boost::geometry::index::rtree<value, boost::geometry::index::quadratic<16>
+                                  , boost::geometry::index::indexable<value>, ValueEqual> m_index;
+};
+
+/**
+ * @brief   Runs the operations of one thread and records the latency of each operation.
+ */
+template <typename TAdapter, typename TResult>
+void runOperations(TAdapter& index, IndexLock& lock, const std::vector<Operation>& operations
+    , std::array<test_util::LatencyHistogram, 4>& histograms)
+{
+    TResult result;
+    std::size_t found = 0;
+    for (const auto& operation : operations)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        switch (operation.type)
+        {
+            case OperationType::Insert:
+                lock.exclusive([&]() { index.insert(operation.key); });
+                break;
+            case OperationType::Remove:
+                lock.exclusive([&]() { index.remove(operation.key); });
+                break;
+            case OperationType::Update:
+                lock.exclusive([&]()
+                {
+                    index.remove(operation.key);
+                    index.insert(operation.other);
+                });
+                break;
+            case OperationType::Query:
+                lock.shared([&]() { found += index.query(operation.key, result); });
+                break;
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        histograms[static_cast<std::size_t>(operation.type)].record(
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+    benchmark::DoNotOptimize(found);
+}
+
+/**
+ * @brief   Runs the workload: benchmark arguments are the mix, the distribution, the query
+ *          window size and the number of threads sharing the index under the reader-writer lock.
+ */
+template <typename TAdapter, typename TResult>
+void runWorkload(benchmark::State& state)
+{
+    const auto& mix = s_mixes[static_cast<std::size_t>(state.range(0))];
+    const auto distribution = static_cast<test_util::Distribution>(state.range(1));
+    const auto queryWindowSize = static_cast<TCrt>(state.range(2));
+    const auto threadCount = static_cast<std::size_t>(state.range(3));
+    const auto workload = makeWorkload(mix, distribution, queryWindowSize, threadCount);
+    state.SetLabel(std::string {mix.name} + "/" + std::string {test_util::nameOf(distribution)});
+
+    std::array<test_util::LatencyHistogram, 4> histograms {};
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto index = std::make_unique<TAdapter>();
+        for (const auto& key : workload.initialKeys)
+        {
+            index->insert(key);
+        }
+        IndexLock lock {threadCount > 1};
+        std::vector<std::array<test_util::LatencyHistogram, 4>> threadHistograms(threadCount);
+        state.ResumeTiming();
+
+        std::vector<std::thread> threads;
+        for (std::size_t thread = 1; thread < threadCount; ++thread)
+        {
+            threads.emplace_back([&, thread]()
+            {
+                runOperations<TAdapter, TResult>(*index, lock, workload.threadOperations[thread]
+                                                 , threadHistograms[thread]);
+            });
+        }
+        runOperations<TAdapter, TResult>(*index, lock, workload.threadOperations[0], threadHistograms[0]);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        state.PauseTiming();
+        for (const auto& threadHistogram : threadHistograms)
+        {
+            for (std::size_t i = 0; i < std::size(histograms); ++i)
+            {
+                histograms[i].merge(threadHistogram[i]);
+            }
+        }
+        index.reset();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * s_operationCount);
+    for (std::size_t i = 0; i < std::size(histograms); ++i)
+    {
+        if (0 == histograms[i].count())
+        {
+            continue;
+        }
+        const std::string name {s_operationNames[i]};
+        state.counters[name + "_p50_ns"] = static_cast<double>(histograms[i].percentile(0.5));
+        state.counters[name + "_p99_ns"] = static_cast<double>(histograms[i].percentile(0.99));
+        state.counters[name + "_p999_ns"] = static_cast<double>(histograms[i].percentile(0.999));
+    }
+}
+
+static void BoostRTreeWorkload(benchmark::State& state)
+{
+    runWorkload<BoostRTreeAdapter, std::vector<value>>(state);
+}
+
+static void SpaceQuadTreeWorkload(benchmark::State& state)
+{
+    runWorkload<SpaceQuadTreeAdapter, std::vector<space::Rect<TCrt>>>(state);
+}
+
+static void workloadArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({"mix", "distribution", "window", "threads"})
+        ->ArgsProduct({benchmark::CreateDenseRange(0, static_cast<int64_t>(std::size(s_mixes)) - 1, 1)
+                       , test_util::allDistributions()
+                       , {1'000, 20'000}
+                       , {1, 4}})
+        ->UseRealTime();
+}
+
+BENCHMARK(BoostRTreeWorkload)->Apply(workloadArguments);
+BENCHMARK(SpaceQuadTreeWorkload)->Apply(workloadArguments);
+
+int main(int argc, char** argv)
+{
+    return test_util::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,368 @@
+/**
+ * @file        AggregateQuadTree.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the AggregateQuadTree class and the summary monoids.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <optional>
+
+#include "Definitions.h"
+#include "QuadTree.h"
+#include "Rect.h"
+#include "Utility.h"
+
+namespace space
+{
+
+/**
+ * @brief   The summary monoid of the sum of payloads.
+ *
+ * @details The summary monoid is the static interface used by space::AggregateQuadTree:
+ *          value_type, identity() and combine(first, second). The combine must be
+ *          associative and commutative, identity() must be its neutral element.
+ *
+ * @tparam  TValue The type of payloads.
+ */
+template <typename TValue>
+struct SumMonoid
+{
+    using value_type = TValue;
+
+    static constexpr value_type identity() noexcept
+    {
+        return value_type {};
+    }
+
+    static constexpr value_type combine(const value_type& first, const value_type& second) noexcept
+    {
+        return first + second;
+    }
+};
+
+/**
+ * @brief   The summary monoid of the minimum of payloads, the identity is the maximum value.
+ *
+ * @tparam  TValue The type of payloads.
+ */
+template <typename TValue>
+struct MinMonoid
+{
+    using value_type = TValue;
+
+    static constexpr value_type identity() noexcept
+    {
+        return std::numeric_limits<value_type>::max();
+    }
+
+    static constexpr value_type combine(const value_type& first, const value_type& second) noexcept
+    {
+        return std::min(first, second);
+    }
+};
+
+/**
+ * @brief   The summary monoid of the maximum of payloads, the identity is the lowest value.
+ *
+ * @tparam  TValue The type of payloads.
+ */
+template <typename TValue>
+struct MaxMonoid
+{
+    using value_type = TValue;
+
+    static constexpr value_type identity() noexcept
+    {
+        return std::numeric_limits<value_type>::lowest();
+    }
+
+    static constexpr value_type combine(const value_type& first, const value_type& second) noexcept
+    {
+        return std::max(first, second);
+    }
+};
+
+/**
+ * @brief   The quadtree which maps the keys to the payloads and keeps the summary of the
+ *          payloads of every subtree.
+ *
+ * @details The tree is split as space::QuadTree. Every node keeps the summary of its subtree
+ *          payloads and the bounding box of its subtree keys, so the aggregation over a window
+ *          takes the summaries of the covered subtrees without visiting their values. The
+ *          summaries are updated along the path from the root on insert and recomputed along
+ *          that path on remove, since the monoid is not required to be invertible.
+ *
+ * @tparam  TKey The type of keys (space::Rect).
+ * @tparam  TValue The type of payloads.
+ * @tparam  TMonoid The summary monoid over the payloads (space::SumMonoid, space::MinMonoid,
+ *          space::MaxMonoid or user defined).
+ */
+template <typename TKey, typename TValue, typename TMonoid = SumMonoid<TValue>>
+class AggregateQuadTree
+{
+    using TSplit = impl::QuadTreeSplit<TKey>;
+    using TRegion = typename TSplit::TRegion;
+    using TBounds = space::Rect<typename TKey::TCoordinate>;
+
+    /**
+     * @internal
+     * @brief   The inline capacity of the root-to-node paths.
+     */
+    static constexpr std::size_t s_pathInlineSize = 32;
+
+    /**
+     * @internal
+     * @brief   The node of the aggregate quadtree.
+     */
+    struct Node
+    {
+        explicit Node(const TRegion& nodeRegion)
+            : m_region {nodeRegion}
+        {
+        }
+
+        [[nodiscard]]
+        const TRegion& region() const noexcept
+        {
+            return m_region;
+        }
+
+        [[nodiscard]]
+        std::unique_ptr<Node>& getChild(typename TSplit::ZOrderPos pos) noexcept
+        {
+            return children[static_cast<std::size_t>(pos)];
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept
+        {
+            return values.empty() && std::ranges::all_of(children, [](const auto& child)
+            {
+                return nullptr == child;
+            });
+        }
+
+        void extend(const TKey& key, const TValue& value)
+        {
+            bounds = TSplit::unite(bounds, key);
+            summary = TMonoid::combine(summary, value);
+        }
+
+        /**
+         * @brief   Recomputes the summary and the bounds from the node values and the children.
+         */
+        void recompute()
+        {
+            bounds.reset();
+            summary = TMonoid::identity();
+            for (const auto&[key, value] : values)
+            {
+                extend(key, value);
+            }
+            for (const auto& child : children)
+            {
+                if (nullptr != child && child->bounds.has_value())
+                {
+                    bounds = TSplit::unite(bounds, *child->bounds);
+                    summary = TMonoid::combine(summary, child->summary);
+                }
+            }
+        }
+
+        space::collections::Array<std::unique_ptr<Node>, 4> children;
+        space::collections::FlatMap<TKey, TValue> values;
+        std::optional<TBounds> bounds;
+        typename TMonoid::value_type summary {TMonoid::identity()};
+
+    private:
+        TRegion m_region;
+    };
+
+public:
+    using key_type = TKey;
+    using mapped_type = TValue;
+    using summary_type = typename TMonoid::value_type;
+    using size_type = std::size_t;
+
+    /**
+     * @brief   Inserts the key with the payload.
+     *
+     * @param   key The key.
+     * @param   value The payload.
+     * @return  true if inserted, false if the key is already in the tree (the payload is not changed).
+     * @throws  std::out_of_range if the key is out of the non-negative coordinate range.
+     */
+    bool insert(const TKey& key, const TValue& value)
+    {
+        TSplit::checkCoordinateRange(key);
+        if (nullptr == m_root)
+        {
+            m_root = std::make_unique<Node>(TSplit::makeRootRegion(key));
+        }
+        TSplit::growUp(m_root, key, [](Node& newRoot, const Node& oldRoot)
+        {
+            newRoot.bounds = oldRoot.bounds;
+            newRoot.summary = oldRoot.summary;
+        });
+
+        space::collections::SmallVector<Node*, s_pathInlineSize> path;
+        auto* node = TSplit::growDown(*m_root, key, [&path](Node& pathNode)
+        {
+            path.push_back(std::addressof(pathNode));
+        });
+        if (!node->values.emplace(key, value).second)
+        {
+            return false;
+        }
+        for (auto* pathNode : path)
+        {
+            pathNode->extend(key, value);
+        }
+        ++m_size;
+        return true;
+    }
+
+    /**
+     * @brief   Removes the key with its payload.
+     *
+     * @param   key The key.
+     * @return  true if removed, false if the key is not in the tree.
+     */
+    bool remove(const TKey& key)
+    {
+        space::collections::SmallVector<std::unique_ptr<Node>*, s_pathInlineSize> path;
+        auto* node = TSplit::findNode(m_root, key, [&path](std::unique_ptr<Node>* pathNode)
+        {
+            path.push_back(pathNode);
+        });
+        if (nullptr == node || 0 == (*node)->values.erase(key))
+        {
+            return false;
+        }
+        --m_size;
+
+        if ((*node)->empty())
+        {
+            node->reset();
+            path.pop_back();
+        }
+        for (auto it = std::rbegin(path); it != std::rend(path); ++it)
+        {
+            (**it)->recompute();
+        }
+        return true;
+    }
+
+    /**
+     * @brief   Gets the payload of the key.
+     *
+     * @param   key The key.
+     * @return  The pointer to payload if the key is in the tree, otherwise null.
+     */
+    [[nodiscard]]
+    const TValue* find(const TKey& key) const
+    {
+        const auto* node = TSplit::findNode(m_root, key, [](const std::unique_ptr<Node>*) noexcept {});
+        if (nullptr == node)
+        {
+            return nullptr;
+        }
+        const auto it = (*node)->values.find(key);
+        return std::end((*node)->values) == it ? nullptr : std::addressof(it->second);
+    }
+
+    /**
+     * @brief   Combines the payloads of the keys intersecting a given rectangle.
+     *
+     * @details The subtrees which bounding box lies entirely inside the rectangle add their
+     *          summaries, only the values of the partially overlapped nodes are tested.
+     *
+     * @param   window The rectangle.
+     * @return  The combined summary, TMonoid::identity() if no key intersects the rectangle.
+     */
+    [[nodiscard]]
+    summary_type aggregate(const TKey& window) const
+    {
+        auto summary = TMonoid::identity();
+        space::collections::SmallStack<const Node*, TSplit::s_queryStackInlineSize> nodeStack;
+        if (nullptr != m_root)
+        {
+            nodeStack.push(m_root.get());
+        }
+        while (!nodeStack.empty())
+        {
+            const auto* currentNode = nodeStack.top();
+            nodeStack.pop();
+            const auto& bounds = currentNode->bounds;
+            if (!bounds.has_value() || !space::util::hasIntersect(window, *bounds))
+            {
+                continue;
+            }
+            if (space::util::contains(window, *bounds))
+            {
+                summary = TMonoid::combine(summary, currentNode->summary);
+                continue;
+            }
+            for (const auto& child : currentNode->children)
+            {
+                if (nullptr != child)
+                {
+                    nodeStack.push(child.get());
+                }
+            }
+            for (const auto&[key, value] : currentNode->values)
+            {
+                if (space::util::hasIntersect(window, key))
+                {
+                    summary = TMonoid::combine(summary, value);
+                }
+            }
+        }
+        return summary;
+    }
+
+    /**
+     * @brief   Gets the summary of all payloads.
+     */
+    [[nodiscard]]
+    summary_type total() const noexcept
+    {
+        return nullptr == m_root ? TMonoid::identity() : m_root->summary;
+    }
+
+    [[nodiscard]]
+    bool contains(const TKey& key) const
+    {
+        return nullptr != find(key);
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return 0 == m_size;
+    }
+
+    [[nodiscard]]
+    size_type size() const noexcept
+    {
+        return m_size;
+    }
+
+    void clear() noexcept
+    {
+        m_root.reset();
+        m_size = 0;
+    }
+
+private:
+    std::unique_ptr<Node> m_root;
+    size_type m_size {0};
+};
+
+} // namespace space
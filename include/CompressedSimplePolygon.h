@@ -0,0 +1,390 @@
+/**
+ * @file        CompressedSimplePolygon.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the CompressedSimplePolygon class.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#include "Definitions.h"
+#include "Point.h"
+#include "Rect.h"
+#include "SimplePolygon.h"
+
+namespace space
+{
+
+namespace impl
+{
+
+/**
+ * @internal
+ * @brief   Maps the signed delta to the unsigned number, so the small deltas of both
+ *          signs have few significant bytes.
+ */
+[[nodiscard]]
+constexpr std::uint64_t zigZagEncode(std::uint64_t delta) noexcept
+{
+    return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+[[nodiscard]]
+constexpr std::uint64_t zigZagDecode(std::uint64_t value) noexcept
+{
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+/**
+ * @internal
+ * @brief   The number of readable bytes required after the last value by loadBytes, the
+ *          whole word is read even for the zero length value at the end of data.
+ */
+inline constexpr std::size_t s_bytesPadding = sizeof(std::uint64_t);
+
+/**
+ * @internal
+ * @brief   Gets the number of significant bytes of the value (0 for zero).
+ */
+[[nodiscard]]
+constexpr std::size_t significantBytesOf(std::uint64_t value) noexcept
+{
+    return (static_cast<std::size_t>(std::bit_width(value)) + 7) / 8;
+}
+
+/**
+ * @internal
+ * @brief   Appends the given number of the value low bytes in little-endian byte order.
+ */
+inline void appendBytes(space::collections::Vector<std::uint8_t>& bytes, std::uint64_t value, std::size_t length)
+{
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+/**
+ * @internal
+ * @brief   Loads the value stored in the given number of little-endian bytes.
+ *
+ * @details Reads the whole word and masks the extra bytes, so there is no branch on the
+ *          length. Requires s_bytesPadding readable bytes after the value.
+ */
+[[nodiscard]]
+inline std::uint64_t loadBytes(const std::uint8_t* pos, std::size_t length) noexcept
+{
+    static constexpr space::collections::Array<std::uint64_t, 9> s_masks {
+        0, 0xffull, 0xffffull, 0xffffffull, 0xffffffffull, 0xffffffffffull
+        , 0xffffffffffffull, 0xffffffffffffffull, ~0ull};
+
+    std::uint64_t word = 0;
+    if constexpr (std::endian::native == std::endian::little)
+    {
+        std::memcpy(&word, pos, sizeof(word));
+    }
+    else
+    {
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            word |= std::uint64_t {pos[i]} << (8 * i);
+        }
+    }
+    return word & s_masks[length];
+}
+
+} // namespace impl
+
+/**
+ * @class   CompressedSimplePolygon
+ * @brief   The compact read-only representation of the simple polygon.
+ *
+ * @details Every vertex is stored as the difference from the previous one (the first from
+ *          the origin), each coordinate delta is zig-zag mapped, so the small deltas of both
+ *          signs have few significant bytes. The deltas are computed modulo 2^64, so the
+ *          conversion is lossless for any integral coordinates.
+ *
+ *          The layout follows Stream VByte: the control stream has one byte per vertex with
+ *          the byte lengths of both deltas (4 bits each), the data stream has only the
+ *          significant bytes. Since the lengths are read from the separate stream, the
+ *          decoder does not wait for one value to find the next one and has no branches on
+ *          the lengths. The vertices close to each other take 2-3 bytes instead of
+ *          2 * sizeof(TCrt). The vertices are decoded on the fly by the iterator, so the
+ *          algorithms stream over the compressed data.
+ *
+ * @tparam  TCrt The type of coordinate (integral).
+ */
+template <typename TCrt>
+class CompressedSimplePolygon
+{
+    static_assert(std::is_integral_v<TCrt>, "Only integral coordinates can be compressed.");
+public:
+
+    /**
+     * @brief   The type of coordinate.
+     */
+    using TCoordinate = TCrt;
+
+    /**
+     * @brief   The iterator decoding the vertices.
+     */
+    class const_iterator
+    {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = space::Point<TCrt>;
+        using difference_type = std::ptrdiff_t;
+        using reference = space::Point<TCrt>;
+        using pointer = void;
+
+        const_iterator() = default;
+
+        [[nodiscard]]
+        reference operator*() const noexcept
+        {
+            return {static_cast<TCrt>(m_x), static_cast<TCrt>(m_y)};
+        }
+
+        const_iterator& operator++() noexcept
+        {
+            if (0 != --m_remaining)
+            {
+                decode();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        [[nodiscard]]
+        bool operator==(const const_iterator& other) const noexcept
+        {
+            return m_remaining == other.m_remaining;
+        }
+
+    private:
+        friend class CompressedSimplePolygon;
+
+        const_iterator(const std::uint8_t* control, const std::uint8_t* data, std::size_t remaining) noexcept
+            : m_control {control}
+            , m_data {data}
+            , m_remaining {remaining}
+        {
+            if (0 != m_remaining)
+            {
+                decode();
+            }
+        }
+
+        void decode() noexcept
+        {
+            const auto control = *m_control++;
+            const auto xLength = static_cast<std::size_t>(control & 0x0f);
+            const auto yLength = static_cast<std::size_t>(control >> 4);
+            m_x += impl::zigZagDecode(impl::loadBytes(m_data, xLength));
+            m_y += impl::zigZagDecode(impl::loadBytes(m_data + xLength, yLength));
+            m_data += xLength + yLength;
+        }
+
+    private:
+        const std::uint8_t* m_control {nullptr};
+        const std::uint8_t* m_data {nullptr};
+        std::size_t m_remaining {0};
+        std::uint64_t m_x {0};
+        std::uint64_t m_y {0};
+    };
+
+public:
+
+    CompressedSimplePolygon() = default;
+
+    /**
+     * @brief   Compresses the given simple polygon.
+     *
+     * @param   poly The simple polygon.
+     */
+    explicit CompressedSimplePolygon(const space::SimplePolygon<TCrt>& poly)
+    {
+        if (poly.empty())
+        {
+            return;
+        }
+
+        const auto& curve = poly.boundaryCurve();
+        m_numOfPoints = std::size(curve);
+        m_bytes.reserve(m_numOfPoints * 3 + impl::s_bytesPadding);
+        m_bytes.resize(m_numOfPoints);
+        std::uint64_t prevX = 0;
+        std::uint64_t prevY = 0;
+        for (std::size_t i = 0; i < m_numOfPoints; ++i)
+        {
+            const auto x = static_cast<std::uint64_t>(curve[i].x());
+            const auto y = static_cast<std::uint64_t>(curve[i].y());
+            const auto deltaX = impl::zigZagEncode(x - prevX);
+            const auto deltaY = impl::zigZagEncode(y - prevY);
+            const auto xLength = impl::significantBytesOf(deltaX);
+            const auto yLength = impl::significantBytesOf(deltaY);
+            m_bytes[i] = static_cast<std::uint8_t>(xLength | (yLength << 4));
+            impl::appendBytes(m_bytes, deltaX, xLength);
+            impl::appendBytes(m_bytes, deltaY, yLength);
+            prevX = x;
+            prevY = y;
+        }
+        m_bytes.resize(std::size(m_bytes) + impl::s_bytesPadding);
+        m_bytes.shrink_to_fit();
+    }
+
+    auto operator<=>(const CompressedSimplePolygon&) const noexcept = default;
+
+    /**
+     * @brief   Decompresses to the simple polygon.
+     *
+     * @return  The simple polygon with the same points.
+     */
+    [[nodiscard]]
+    space::SimplePolygon<TCrt> toSimplePolygon() const
+    {
+        typename space::SimplePolygon<TCrt>::TPiecewiseLinearCurve curve;
+        curve.reserve(m_numOfPoints);
+        std::ranges::copy(*this, std::back_inserter(curve));
+        return space::SimplePolygon<TCrt> {std::move(curve)};
+    }
+
+    [[nodiscard]]
+    const_iterator begin() const noexcept
+    {
+        return {m_bytes.data(), m_bytes.data() + m_numOfPoints, m_numOfPoints};
+    }
+
+    [[nodiscard]]
+    const_iterator end() const noexcept
+    {
+        return {};
+    }
+
+    /**
+     * @brief   Checks the polygon has points or not.
+     *
+     * @return  true if has, otherwise false.
+     */
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return 0 == m_numOfPoints;
+    }
+
+    /**
+     * @brief   Gets the number of vertices.
+     */
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return m_numOfPoints;
+    }
+
+    /**
+     * @brief   Gets the compressed vertices.
+     */
+    [[nodiscard]]
+    space::collections::Span<const std::uint8_t> bytes() const noexcept
+    {
+        if (m_bytes.empty())
+        {
+            return {};
+        }
+        return space::collections::Span<const std::uint8_t> {m_bytes}.first(std::size(m_bytes) - impl::s_bytesPadding);
+    }
+
+private:
+
+    /**
+     * @brief   The number of vertices.
+     */
+    std::size_t m_numOfPoints {0};
+
+    /**
+     * @brief   The control stream (one byte per vertex), then the data stream with the
+     *          significant bytes of the zig-zag deltas (x, y), then the padding for the
+     *          word-sized reads.
+     */
+    space::collections::Vector<std::uint8_t> m_bytes {};
+}; // class CompressedSimplePolygon
+
+namespace util
+{
+
+/**
+ * @brief       Gets the boundary box of the given compressed simple polygon.
+ *
+ * @details     The algorithm complexity is O(n), the vertices are decoded in one pass.
+ *
+ * @tparam TCrt The type of coordinates.
+ * @param poly  The given polygon.
+ * @throws      std::out_of_range if the polygon is empty.
+ * @return      The boundary box (space::Rect) of the given polygon.
+ */
+template <typename TCrt>
+space::Rect<TCrt> boundaryBoxOf(const CompressedSimplePolygon<TCrt>& poly)
+{
+    if (poly.empty())
+    {
+        throw std::out_of_range {"The Polygon is empty."};
+    }
+
+    auto it = std::begin(poly);
+    auto[minX, minY] = *it;
+    auto maxX = minX;
+    auto maxY = minY;
+    for (++it; it != std::end(poly); ++it)
+    {
+        const auto[x, y] = *it;
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+    return space::Rect<TCrt> {space::Point<TCrt> {minX, minY}, space::Point<TCrt> {maxX, maxY}};
+}
+
+/**
+ * @brief   Returns true if the given point is inside or on the edge of the compressed
+ *          simple polygon, otherwise returns false.
+ *
+ * @details Uses the even-odd rule as the SimplePolygon version, the vertices are decoded
+ *          on the fly (two passes, the first one finds the boundary box).
+ * @tparam  TCrt The type of coordinates.
+ * @param   poly The given compressed simple polygon.
+ * @param   point The given point.
+ * @return  true if contains, otherwise returns false.
+ */
+template <typename TCrt>
+[[nodiscard]]
+bool contains(const CompressedSimplePolygon<TCrt>& poly, const Point<TCrt>& point)
+{
+    if (std::size(poly) < 3)
+    {
+        return false;
+    }
+
+    const auto infinity = topRightOf(boundaryBoxOf(poly)).x() + 1;
+    return impl::containsByEvenOddRule(std::begin(poly), std::end(poly), point, infinity);
+}
+
+} // namespace util
+
+} // namespace space
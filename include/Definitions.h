@@ -14,7 +14,9 @@
 #include <stack>
 #include <span>
 #include <stdexcept>
+#include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
+#include <boost/container/small_vector.hpp>
 
 namespace space::collections
 {
@@ -27,9 +29,24 @@ using Array = std::array<T, N>;
 template <typename ... T>
 using FlatSet = boost::container::flat_set<T...>;
 
+template <typename ... T>
+using FlatMap = boost::container::flat_map<T...>;
+
 template <typename ... T>
 using Stack = std::stack<T...>;
 
+/**
+ * @brief   The vector which keeps up to N elements inline and allocates only beyond that.
+ */
+template <typename T, std::size_t N>
+using SmallVector = boost::container::small_vector<T, N>;
+
+/**
+ * @brief   The stack which keeps up to N elements inline and allocates only beyond that.
+ */
+template <typename T, std::size_t N>
+using SmallStack = std::stack<T, SmallVector<T, N>>;
+
 template <typename ... T>
 using Span = std::span<T...>;
 
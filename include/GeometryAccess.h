@@ -0,0 +1,86 @@
+/**
+ * @file        GeometryAccess.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the helpers shared by the geometry decoders.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "Polygon.h"
+#include "Serialization.h"
+#include "SimplePolygon.h"
+
+namespace space::io::impl
+{
+
+/**
+ * @internal
+ * @brief   Gives the decoders access to the geometry storage, so the records are decoded
+ *          in place and the already allocated memory is reused.
+ */
+struct GeometryAccess
+{
+    template <typename TCrt>
+    static auto& curveOf(space::SimplePolygon<TCrt>& poly) noexcept
+    {
+        return poly.m_piecewiseLinearCurve;
+    }
+
+    template <typename TCrt>
+    static const auto& curveOf(const space::SimplePolygon<TCrt>& poly) noexcept
+    {
+        return poly.m_piecewiseLinearCurve;
+    }
+
+    template <typename TCrt>
+    static auto& contoursOf(space::Polygon<TCrt>& poly) noexcept
+    {
+        return poly.m_arrContours;
+    }
+
+    template <typename TCrt>
+    static const auto& contoursOf(const space::Polygon<TCrt>& poly) noexcept
+    {
+        return poly.m_arrContours;
+    }
+};
+
+/**
+ * @internal
+ * @brief   Converts the decoded coordinate to the coordinate type, the integral
+ *          coordinates are rounded to the nearest.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   value The decoded coordinate.
+ * @throws  space::io::FormatError if the value is out of the coordinate type range.
+ * @return  The coordinate.
+ */
+template <typename TCrt>
+[[nodiscard]]
+TCrt toCoordinate(double value)
+{
+    if constexpr (std::is_integral_v<TCrt>)
+    {
+        // The bounds are powers of two, so they are exact as double unlike the maximum itself.
+        static constexpr auto s_lowest = static_cast<double>(std::numeric_limits<TCrt>::lowest());
+        static constexpr auto s_upperBound = 2.0 * static_cast<double>(std::numeric_limits<TCrt>::max() / 2 + 1);
+        const auto rounded = std::round(value);
+        if (!(rounded >= s_lowest && rounded < s_upperBound))
+        {
+            throw FormatError {"The coordinate is out of the coordinate type range."};
+        }
+        return static_cast<TCrt>(rounded);
+    }
+    else
+    {
+        return static_cast<TCrt>(value);
+    }
+}
+
+} // namespace space::io::impl
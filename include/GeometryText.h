@@ -0,0 +1,902 @@
+/**
+ * @file        GeometryText.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the WKT and GeoJSON readers and writers.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+
+#include "Definitions.h"
+#include "GeometryAccess.h"
+#include "Point.h"
+#include "Polygon.h"
+#include "Rect.h"
+#include "Serialization.h"
+#include "SimplePolygon.h"
+
+namespace space::io
+{
+
+namespace impl
+{
+
+/**
+ * @internal
+ * @brief   The cursor over the geometry text, shared by the WKT and GeoJSON readers.
+ */
+class TextCursor
+{
+public:
+
+    explicit TextCursor(std::string_view text) noexcept
+        : m_text {text}
+    {
+    }
+
+    void skipWhitespace() noexcept
+    {
+        while (m_pos < std::size(m_text) && isWhitespace(m_text[m_pos]))
+        {
+            ++m_pos;
+        }
+    }
+
+    /**
+     * @brief   Skips the whitespaces and consumes the given character if it is next.
+     */
+    [[nodiscard]]
+    bool consume(char ch) noexcept
+    {
+        skipWhitespace();
+        if (m_pos < std::size(m_text) && ch == m_text[m_pos])
+        {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char ch)
+    {
+        if (!consume(ch))
+        {
+            throw FormatError {std::string {"Expected '"} + ch + "' at position " + std::to_string(m_pos) + "."};
+        }
+    }
+
+    /**
+     * @brief   Skips the whitespaces and consumes the given keyword (case-insensitive) if it is next.
+     */
+    [[nodiscard]]
+    bool consumeKeyword(std::string_view keyword) noexcept
+    {
+        skipWhitespace();
+        if (std::size(m_text) - m_pos < std::size(keyword))
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < std::size(keyword); ++i)
+        {
+            if ((m_text[m_pos + i] | 0x20) != (keyword[i] | 0x20))
+            {
+                return false;
+            }
+        }
+        const auto end = m_pos + std::size(keyword);
+        if (end < std::size(m_text) && isIdentifier(m_text[end]))
+        {
+            return false;
+        }
+        m_pos = end;
+        return true;
+    }
+
+    void expectKeyword(std::string_view keyword)
+    {
+        if (!consumeKeyword(keyword))
+        {
+            throw FormatError {"Expected '" + std::string {keyword} + "' at position " + std::to_string(m_pos) + "."};
+        }
+    }
+
+    /**
+     * @brief   Reads the number with std::from_chars. The integral coordinates are parsed
+     *          directly, the numbers with fraction or exponent are rounded to the nearest.
+     */
+    template <typename TCrt>
+    [[nodiscard]]
+    TCrt readNumber()
+    {
+        skipWhitespace();
+        const auto* first = m_text.data() + m_pos;
+        const auto* last = m_text.data() + std::size(m_text);
+        if (first != last && '+' == *first)
+        {
+            ++first;
+        }
+
+        TCrt value {};
+        auto result = std::from_chars(first, last, value);
+        if constexpr (std::is_integral_v<TCrt>)
+        {
+            const auto* ptr = result.ptr;
+            if (std::errc {} == result.ec && (ptr == last || ('.' != *ptr && 'e' != *ptr && 'E' != *ptr)))
+            {
+                m_pos = static_cast<std::size_t>(ptr - m_text.data());
+                return value;
+            }
+            double real {};
+            result = std::from_chars(first, last, real);
+            if (std::errc {} == result.ec)
+            {
+                value = toCoordinate<TCrt>(real);
+            }
+        }
+        if (std::errc {} != result.ec)
+        {
+            throw FormatError {"Invalid number at position " + std::to_string(m_pos) + "."};
+        }
+        m_pos = static_cast<std::size_t>(result.ptr - m_text.data());
+        return value;
+    }
+
+    /**
+     * @brief   Reads the JSON string. The escape sequences are kept as is.
+     */
+    [[nodiscard]]
+    std::string_view readString()
+    {
+        expect('"');
+        const auto begin = m_pos;
+        while (m_pos < std::size(m_text) && '"' != m_text[m_pos])
+        {
+            m_pos += ('\\' == m_text[m_pos]) ? 2 : 1;
+        }
+        if (m_pos >= std::size(m_text))
+        {
+            throw FormatError {"Unterminated string."};
+        }
+        return m_text.substr(begin, m_pos++ - begin);
+    }
+
+    /**
+     * @brief   Skips the JSON value of any type.
+     *
+     * @param   depth The nesting depth of the value.
+     * @throws  space::io::FormatError if the value is malformed or nested deeper than
+     *          s_maxJsonDepth, so the untrusted text cannot overflow the stack.
+     */
+    void skipJsonValue(std::size_t depth = 0)
+    {
+        if (depth > s_maxJsonDepth)
+        {
+            throw FormatError {"The JSON value is nested too deep at position " + std::to_string(m_pos) + "."};
+        }
+        skipWhitespace();
+        if (m_pos >= std::size(m_text))
+        {
+            throw FormatError {"Unexpected end of the text."};
+        }
+
+        const auto ch = m_text[m_pos];
+        if ('"' == ch)
+        {
+            std::ignore = readString();
+        }
+        else if ('{' == ch || '[' == ch)
+        {
+            const auto close = ('{' == ch) ? '}' : ']';
+            ++m_pos;
+            if (consume(close))
+            {
+                return;
+            }
+            do
+            {
+                if ('}' == close)
+                {
+                    std::ignore = readString();
+                    expect(':');
+                }
+                skipJsonValue(depth + 1);
+            } while (consume(','));
+            expect(close);
+        }
+        else
+        {
+            // The number or literal.
+            const auto begin = m_pos;
+            while (m_pos < std::size(m_text) && !isWhitespace(m_text[m_pos])
+                   && ',' != m_text[m_pos] && '}' != m_text[m_pos] && ']' != m_text[m_pos])
+            {
+                ++m_pos;
+            }
+            if (begin == m_pos)
+            {
+                throw FormatError {"Invalid value at position " + std::to_string(m_pos) + "."};
+            }
+        }
+    }
+
+    [[nodiscard]]
+    std::size_t position() const noexcept
+    {
+        return m_pos;
+    }
+
+    void setPosition(std::size_t pos) noexcept
+    {
+        m_pos = pos;
+    }
+
+private:
+
+    /**
+     * @brief   The maximum nesting depth of the skipped JSON values.
+     */
+    static constexpr std::size_t s_maxJsonDepth = 256;
+
+    static constexpr bool isWhitespace(char ch) noexcept
+    {
+        return ' ' == ch || '\t' == ch || '\n' == ch || '\r' == ch;
+    }
+
+    static constexpr bool isIdentifier(char ch) noexcept
+    {
+        return ('a' <= (ch | 0x20) && (ch | 0x20) <= 'z') || ('0' <= ch && ch <= '9') || '_' == ch;
+    }
+
+private:
+    std::string_view m_text;
+    std::size_t m_pos {0};
+};
+
+/**
+ * @internal
+ * @brief   Appends the number formatted with std::to_chars (the shortest round-trip form).
+ */
+template <typename TCrt>
+void appendNumber(std::string& out, TCrt value)
+{
+    space::collections::Array<char, 32> buffer;
+    const auto[ptr, error] = std::to_chars(buffer.data(), buffer.data() + std::size(buffer), value);
+    out.append(buffer.data(), ptr);
+}
+
+/**
+ * @internal
+ * @brief   Reads the WKT ring "EMPTY" or "(x y, x y, ...)" and calls the function for every
+ *          point, the closing point is dropped.
+ */
+template <typename TCrt, typename TFunc>
+void readWktRing(TextCursor& cursor, TFunc func)
+{
+    if (cursor.consumeKeyword("EMPTY"))
+    {
+        return;
+    }
+    cursor.expect('(');
+    std::size_t count = 0;
+    space::Point<TCrt> first;
+    space::Point<TCrt> last;
+    do
+    {
+        const auto x = cursor.readNumber<TCrt>();
+        const auto y = cursor.readNumber<TCrt>();
+        if (0 == count)
+        {
+            first = {x, y};
+        }
+        else
+        {
+            // The previous point is not the closing one.
+            func(last);
+        }
+        last = {x, y};
+        ++count;
+    } while (cursor.consume(','));
+    cursor.expect(')');
+
+    if (1 == count || last != first)
+    {
+        func(last);
+    }
+}
+
+/**
+ * @internal
+ * @brief   Reads the WKT polygon body "EMPTY" or "((...), (...))" into the contours,
+ *          the contours memory is reused.
+ */
+template <typename TCrt>
+void readWktContours(TextCursor& cursor, space::collections::Vector<space::SimplePolygon<TCrt>>& contours)
+{
+    std::size_t numOfContours = 0;
+    if (!cursor.consumeKeyword("EMPTY"))
+    {
+        cursor.expect('(');
+        do
+        {
+            if (numOfContours == std::size(contours))
+            {
+                contours.emplace_back();
+            }
+            auto& curve = GeometryAccess::curveOf(contours[numOfContours++]);
+            curve.clear();
+            readWktRing<TCrt>(cursor, [&curve](const auto& point) { curve.push_back(point); });
+        } while (cursor.consume(','));
+        cursor.expect(')');
+    }
+    contours.resize(numOfContours);
+}
+
+/**
+ * @internal
+ * @brief   Reads the GeoJSON position "[x, y, ...]", the extra dimensions are ignored.
+ */
+template <typename TCrt>
+space::Point<TCrt> readGeoJsonPosition(TextCursor& cursor)
+{
+    cursor.expect('[');
+    const auto x = cursor.readNumber<TCrt>();
+    cursor.expect(',');
+    const auto y = cursor.readNumber<TCrt>();
+    while (cursor.consume(','))
+    {
+        cursor.skipJsonValue();
+    }
+    cursor.expect(']');
+    return {x, y};
+}
+
+/**
+ * @internal
+ * @brief   Reads the GeoJSON polygon coordinates "[[[x, y], ...], ...]" into the contours,
+ *          the closing points are dropped and the contours memory is reused.
+ */
+template <typename TCrt>
+void readGeoJsonContours(TextCursor& cursor, space::collections::Vector<space::SimplePolygon<TCrt>>& contours)
+{
+    std::size_t numOfContours = 0;
+    cursor.expect('[');
+    if (!cursor.consume(']'))
+    {
+        do
+        {
+            if (numOfContours == std::size(contours))
+            {
+                contours.emplace_back();
+            }
+            auto& curve = GeometryAccess::curveOf(contours[numOfContours++]);
+            curve.clear();
+            cursor.expect('[');
+            if (!cursor.consume(']'))
+            {
+                do
+                {
+                    curve.push_back(readGeoJsonPosition<TCrt>(cursor));
+                } while (cursor.consume(','));
+                cursor.expect(']');
+            }
+            if (std::size(curve) > 1 && curve.front() == curve.back())
+            {
+                curve.pop_back();
+            }
+        } while (cursor.consume(','));
+        cursor.expect(']');
+    }
+    contours.resize(numOfContours);
+}
+
+/**
+ * @internal
+ * @brief   Reads the GeoJSON geometry object, checks its type and reads the coordinates
+ *          with the given function. The object members may be in any order, the unknown
+ *          members are skipped.
+ *
+ * @return  The number of consumed characters.
+ */
+template <typename TFunc>
+std::size_t readGeoJsonGeometry(std::string_view text, std::string_view type, TFunc readCoordinates)
+{
+    TextCursor cursor {text};
+    std::string_view actualType;
+    std::size_t coordinatesPos = 0;
+    bool hasCoordinates = false;
+
+    cursor.expect('{');
+    if (!cursor.consume('}'))
+    {
+        do
+        {
+            const auto key = cursor.readString();
+            cursor.expect(':');
+            if ("type" == key)
+            {
+                actualType = cursor.readString();
+            }
+            else if ("coordinates" == key)
+            {
+                cursor.skipWhitespace();
+                coordinatesPos = cursor.position();
+                hasCoordinates = true;
+                cursor.skipJsonValue();
+            }
+            else
+            {
+                cursor.skipJsonValue();
+            }
+        } while (cursor.consume(','));
+        cursor.expect('}');
+    }
+
+    if (type != actualType)
+    {
+        throw FormatError {"Expected the GeoJSON " + std::string {type} + " geometry."};
+    }
+    if (!hasCoordinates)
+    {
+        throw FormatError {"The GeoJSON geometry has no coordinates."};
+    }
+
+    const auto end = cursor.position();
+    cursor.setPosition(coordinatesPos);
+    readCoordinates(cursor);
+    return end;
+}
+
+template <typename TCrt>
+void appendWktPoint(std::string& out, const space::Point<TCrt>& point)
+{
+    appendNumber(out, point.x());
+    out.push_back(' ');
+    appendNumber(out, point.y());
+}
+
+/**
+ * @internal
+ * @brief   Appends the closed WKT ring "(x y, ..., x y)", or "EMPTY" for the empty ring.
+ */
+template <typename TCrt>
+void appendWktRing(std::string& out, const space::collections::Vector<space::Point<TCrt>>& curve)
+{
+    if (curve.empty())
+    {
+        out.append("EMPTY");
+        return;
+    }
+    out.push_back('(');
+    for (const auto& point : curve)
+    {
+        appendWktPoint(out, point);
+        out.append(", ");
+    }
+    appendWktPoint(out, curve.front());
+    out.push_back(')');
+}
+
+template <typename TCrt>
+void appendGeoJsonPosition(std::string& out, const space::Point<TCrt>& point)
+{
+    out.push_back('[');
+    appendNumber(out, point.x());
+    out.push_back(',');
+    appendNumber(out, point.y());
+    out.push_back(']');
+}
+
+/**
+ * @internal
+ * @brief   Appends the closed GeoJSON ring "[[x,y],...,[x,y]]", or "[]" for the empty ring.
+ */
+template <typename TCrt>
+void appendGeoJsonRing(std::string& out, const space::collections::Vector<space::Point<TCrt>>& curve)
+{
+    if (curve.empty())
+    {
+        out.append("[]");
+        return;
+    }
+    out.push_back('[');
+    for (const auto& point : curve)
+    {
+        appendGeoJsonPosition(out, point);
+        out.push_back(',');
+    }
+    appendGeoJsonPosition(out, curve.front());
+    out.push_back(']');
+}
+
+/**
+ * @internal
+ * @brief   Returns the corners of the rectangle in the ring order.
+ */
+template <typename TCrt>
+space::collections::Vector<space::Point<TCrt>> ringOf(const space::Rect<TCrt>& rect)
+{
+    const auto[x1, y1] = space::util::bottomLeftOf(rect);
+    const auto[x2, y2] = space::util::topRightOf(rect);
+    return {{x1, y1}, {x1, y2}, {x2, y2}, {x2, y1}};
+}
+
+/**
+ * @internal
+ * @brief   Makes the rectangle from the ring points, checks the ring is the axis-aligned rectangle.
+ */
+template <typename TCrt>
+space::Rect<TCrt> rectOf(space::collections::Span<const space::Point<TCrt>> ring)
+{
+    if (4 != std::size(ring))
+    {
+        throw FormatError {"The rectangle ring must have four corners."};
+    }
+    const auto[minX, maxX] = std::ranges::minmax(ring, {}, [](const auto& point) { return point.x(); });
+    const auto[minY, maxY] = std::ranges::minmax(ring, {}, [](const auto& point) { return point.y(); });
+    const space::Rect<TCrt> rect {space::Point<TCrt> {minX.x(), minY.y()}, space::Point<TCrt> {maxX.x(), maxY.y()}};
+    for (const auto& corner : ringOf(rect))
+    {
+        if (std::ranges::find(ring, corner) == std::end(ring))
+        {
+            throw FormatError {"The ring is not an axis-aligned rectangle."};
+        }
+    }
+    return rect;
+}
+
+} // namespace impl
+
+/**
+ * @brief   Reads the WKT point "POINT (x y)".
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   text The text starting with the geometry.
+ * @param   point The parsed point.
+ * @throws  space::io::FormatError if the text is malformed.
+ * @return  The number of consumed characters.
+ */
+template <typename TCrt>
+std::size_t readWkt(std::string_view text, space::Point<TCrt>& point)
+{
+    impl::TextCursor cursor {text};
+    cursor.expectKeyword("POINT");
+    cursor.expect('(');
+    const auto x = cursor.readNumber<TCrt>();
+    const auto y = cursor.readNumber<TCrt>();
+    cursor.expect(')');
+    point = {x, y};
+    return cursor.position();
+}
+
+/**
+ * @brief   Reads the WKT polygon having the axis-aligned rectangle boundary and no holes.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   text The text starting with the geometry.
+ * @param   rect The parsed rectangle.
+ * @throws  space::io::FormatError if the text is malformed or is not a rectangle.
+ * @return  The number of consumed characters.
+ */
+template <typename TCrt>
+std::size_t readWkt(std::string_view text, space::Rect<TCrt>& rect)
+{
+    impl::TextCursor cursor {text};
+    cursor.expectKeyword("POLYGON");
+    cursor.expect('(');
+    space::collections::Array<space::Point<TCrt>, 4> corners;
+    std::size_t count = 0;
+    impl::readWktRing<TCrt>(cursor, [&corners, &count](const auto& point)
+    {
+        if (count == std::size(corners))
+        {
+            throw FormatError {"The rectangle ring must have four corners."};
+        }
+        corners[count++] = point;
+    });
+    cursor.expect(')');
+    rect = impl::rectOf<TCrt>({corners.data(), count});
+    return cursor.position();
+}
+
+/**
+ * @brief   Reads the WKT polygon without holes "POLYGON ((x y, ...))" or "POLYGON EMPTY".
+ *
+ * @details The closing point is dropped. The memory of the given polygon is reused.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   text The text starting with the geometry.
+ * @param   poly The parsed simple polygon.
+ * @throws  space::io::FormatError if the text is malformed or the polygon has holes.
+ * @return  The number of consumed characters.
+ */
+template <typename TCrt>
+std::size_t readWkt(std::string_view text, space::SimplePolygon<TCrt>& poly)
+{
+    impl::TextCursor cursor {text};
+    cursor.expectKeyword("POLYGON");
+    auto& curve = impl::GeometryAccess::curveOf(poly);
+    curve.clear();
+    if (!cursor.consumeKeyword("EMPTY"))
+    {
+        cursor.expect('(');
+        impl::readWktRing<TCrt>(cursor, [&curve](const auto& point) { curve.push_back(point); });
+        if (cursor.consume(','))
+        {
+            throw FormatError {"The simple polygon must not have holes."};
+        }
+        cursor.expect(')');
+    }
+    return cursor.position();
+}
+
+/**
+ * @brief   Reads the WKT polygon "POLYGON ((x y, ...), (x y, ...))" or "POLYGON EMPTY".
+ *
+ * @details The closing points are dropped. The memory of the given polygon is reused.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   text The text starting with the geometry.
+ * @param   poly The parsed polygon.
+ * @throws  space::io::FormatError if the text is malformed.
+ * @return  The number of consumed characters.
+ */
+template <typename TCrt>
+std::size_t readWkt(std::string_view text, space::Polygon<TCrt>& poly)
+{
+    impl::TextCursor cursor {text};
+    cursor.expectKeyword("POLYGON");
+    impl::readWktContours(cursor, impl::GeometryAccess::contoursOf(poly));
+    return cursor.position();
+}
+
+/**
+ * @brief   Reads the GeoJSON Point geometry object.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   text The text starting with the geometry object.
+ * @param   point The parsed point.
+ * @throws  space::io::FormatError if the text is malformed or has another geometry type.
+ * @return  The number of consumed characters.
+ */
+template <typename TCrt>
+std::size_t readGeoJson(std::string_view text, space::Point<TCrt>& point)
+{
+    return impl::readGeoJsonGeometry(text, "Point", [&point](impl::TextCursor& cursor)
+    {
+        point = impl::readGeoJsonPosition<TCrt>(cursor);
+    });
+}
+
+/**
+ * @brief   Reads the GeoJSON Polygon geometry object having the axis-aligned rectangle boundary.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   text The text starting with the geometry object.
+ * @param   rect The parsed rectangle.
+ * @throws  space::io::FormatError if the text is malformed or is not a rectangle.
+ * @return  The number of consumed characters.
+ */
+template <typename TCrt>
+std::size_t readGeoJson(std::string_view text, space::Rect<TCrt>& rect)
+{
+    return impl::readGeoJsonGeometry(text, "Polygon", [&rect](impl::TextCursor& cursor)
+    {
+        space::collections::Vector<space::SimplePolygon<TCrt>> contours;
+        impl::readGeoJsonContours(cursor, contours);
+        if (1 != std::size(contours))
+        {
+            throw FormatError {"The rectangle must have one ring."};
+        }
+        rect = impl::rectOf<TCrt>(impl::GeometryAccess::curveOf(contours.front()));
+    });
+}
+
+/**
+ * @brief   Reads the GeoJSON Polygon geometry object without holes.
+ *
+ * @details The closing point is dropped. The memory of the given polygon is reused.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   text The text starting with the geometry object.
+ * @param   poly The parsed simple polygon.
+ * @throws  space::io::FormatError if the text is malformed or the polygon has holes.
+ * @return  The number of consumed characters.
+ */
+template <typename TCrt>
+std::size_t readGeoJson(std::string_view text, space::SimplePolygon<TCrt>& poly)
+{
+    return impl::readGeoJsonGeometry(text, "Polygon", [&poly](impl::TextCursor& cursor)
+    {
+        space::collections::Vector<space::SimplePolygon<TCrt>> contours;
+        contours.push_back(std::move(poly));
+        impl::readGeoJsonContours(cursor, contours);
+        if (std::size(contours) > 1)
+        {
+            throw FormatError {"The simple polygon must not have holes."};
+        }
+        poly = contours.empty() ? space::SimplePolygon<TCrt> {} : std::move(contours.front());
+    });
+}
+
+/**
+ * @brief   Reads the GeoJSON Polygon geometry object.
+ *
+ * @details The closing points are dropped. The memory of the given polygon is reused.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   text The text starting with the geometry object.
+ * @param   poly The parsed polygon.
+ * @throws  space::io::FormatError if the text is malformed or has another geometry type.
+ * @return  The number of consumed characters.
+ */
+template <typename TCrt>
+std::size_t readGeoJson(std::string_view text, space::Polygon<TCrt>& poly)
+{
+    return impl::readGeoJsonGeometry(text, "Polygon", [&poly](impl::TextCursor& cursor)
+    {
+        impl::readGeoJsonContours(cursor, impl::GeometryAccess::contoursOf(poly));
+    });
+}
+
+/**
+ * @brief   Appends the WKT point "POINT (x y)" to the string.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   point The point.
+ * @param   out The output string.
+ */
+template <typename TCrt>
+void writeWkt(const space::Point<TCrt>& point, std::string& out)
+{
+    out.append("POINT (");
+    impl::appendWktPoint(out, point);
+    out.push_back(')');
+}
+
+/**
+ * @brief   Appends the rectangle as the WKT polygon to the string.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   rect The rectangle.
+ * @param   out The output string.
+ */
+template <typename TCrt>
+void writeWkt(const space::Rect<TCrt>& rect, std::string& out)
+{
+    out.append("POLYGON (");
+    impl::appendWktRing(out, impl::ringOf(rect));
+    out.push_back(')');
+}
+
+/**
+ * @brief   Appends the WKT polygon to the string, the ring is closed by repeating the first point.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   poly The simple polygon.
+ * @param   out The output string.
+ */
+template <typename TCrt>
+void writeWkt(const space::SimplePolygon<TCrt>& poly, std::string& out)
+{
+    if (poly.empty())
+    {
+        out.append("POLYGON EMPTY");
+        return;
+    }
+    out.append("POLYGON (");
+    impl::appendWktRing(out, poly.boundaryCurve());
+    out.push_back(')');
+}
+
+/**
+ * @brief   Appends the WKT polygon to the string, the rings are closed by repeating their first points.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   poly The polygon.
+ * @param   out The output string.
+ */
+template <typename TCrt>
+void writeWkt(const space::Polygon<TCrt>& poly, std::string& out)
+{
+    const auto& contours = impl::GeometryAccess::contoursOf(poly);
+    if (contours.empty())
+    {
+        out.append("POLYGON EMPTY");
+        return;
+    }
+    out.append("POLYGON (");
+    for (std::size_t i = 0; i < std::size(contours); ++i)
+    {
+        if (0 != i)
+        {
+            out.append(", ");
+        }
+        impl::appendWktRing(out, impl::GeometryAccess::curveOf(contours[i]));
+    }
+    out.push_back(')');
+}
+
+/**
+ * @brief   Appends the GeoJSON Point geometry object to the string.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   point The point.
+ * @param   out The output string.
+ */
+template <typename TCrt>
+void writeGeoJson(const space::Point<TCrt>& point, std::string& out)
+{
+    out.append(R"({"type":"Point","coordinates":)");
+    impl::appendGeoJsonPosition(out, point);
+    out.push_back('}');
+}
+
+/**
+ * @brief   Appends the rectangle as the GeoJSON Polygon geometry object to the string.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   rect The rectangle.
+ * @param   out The output string.
+ */
+template <typename TCrt>
+void writeGeoJson(const space::Rect<TCrt>& rect, std::string& out)
+{
+    out.append(R"({"type":"Polygon","coordinates":[)");
+    impl::appendGeoJsonRing(out, impl::ringOf(rect));
+    out.append("]}");
+}
+
+/**
+ * @brief   Appends the GeoJSON Polygon geometry object to the string,
+ *          the ring is closed by repeating the first point.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   poly The simple polygon.
+ * @param   out The output string.
+ */
+template <typename TCrt>
+void writeGeoJson(const space::SimplePolygon<TCrt>& poly, std::string& out)
+{
+    out.append(R"({"type":"Polygon","coordinates":[)");
+    if (!poly.empty())
+    {
+        impl::appendGeoJsonRing(out, poly.boundaryCurve());
+    }
+    out.append("]}");
+}
+
+/**
+ * @brief   Appends the GeoJSON Polygon geometry object to the string,
+ *          the rings are closed by repeating their first points.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   poly The polygon.
+ * @param   out The output string.
+ */
+template <typename TCrt>
+void writeGeoJson(const space::Polygon<TCrt>& poly, std::string& out)
+{
+    const auto& contours = impl::GeometryAccess::contoursOf(poly);
+    out.append(R"({"type":"Polygon","coordinates":[)");
+    for (std::size_t i = 0; i < std::size(contours); ++i)
+    {
+        if (0 != i)
+        {
+            out.push_back(',');
+        }
+        impl::appendGeoJsonRing(out, impl::GeometryAccess::curveOf(contours[i]));
+    }
+    out.append("]}");
+}
+
+} // namespace space::io
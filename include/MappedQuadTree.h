@@ -0,0 +1,418 @@
+/**
+ * @file        MappedQuadTree.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the MappedQuadTree class.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <queue>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Definitions.h"
+#include "QuadTree.h"
+#include "Serialization.h"
+
+namespace space
+{
+
+/**
+ * @brief   The read-only quadtree view over the memory-mapped file written by QuadTree::save.
+ *
+ * @details The file is not deserialized: the nodes are read in place and linked by file
+ *          offsets, so opening is almost instant and the pages are shared between all
+ *          processes mapping the same file. Requires POSIX mmap.
+ *
+ * @tparam  TKey The type of values.
+ */
+template <typename TKey>
+class MappedQuadTree
+{
+    using TLayout = space::io::QuadTreeLayout<TKey>;
+    using TSplit = impl::QuadTreeSplit<TKey>;
+    using TRegion = typename TLayout::TRegion;
+    using ZOrderPos = typename TSplit::ZOrderPos;
+    using TCoordinate = typename TKey::TCoordinate;
+public:
+
+    using size_type = std::size_t;
+
+    /**
+     * @brief   Maps the given file.
+     *
+     * @param   path The path to the serialized quadtree.
+     * @param   verifyChecksum Whether to verify the checksum of the whole file
+     *          (reads the whole file).
+     * @throws  std::system_error if the file cannot be mapped.
+     * @throws  space::io::FormatError if the file is malformed.
+     */
+    explicit MappedQuadTree(const std::filesystem::path& path, bool verifyChecksum = false)
+    {
+        const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw std::system_error {errno, std::generic_category(), "Failed to open " + path.string()};
+        }
+
+        struct stat fileStat {};
+        if (0 != ::fstat(fd, &fileStat))
+        {
+            const auto error = errno;
+            ::close(fd);
+            throw std::system_error {error, std::generic_category(), "Failed to stat " + path.string()};
+        }
+
+        m_size = static_cast<std::size_t>(fileStat.st_size);
+        if (0 != m_size)
+        {
+            auto* data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (MAP_FAILED == data)
+            {
+                const auto error = errno;
+                ::close(fd);
+                throw std::system_error {error, std::generic_category(), "Failed to map " + path.string()};
+            }
+            m_data = static_cast<const std::byte*>(data);
+        }
+        ::close(fd);
+
+        try
+        {
+            m_trailer = space::io::validateQuadTree<TKey>(bytes(), verifyChecksum);
+        }
+        catch (...)
+        {
+            unmap();
+            throw;
+        }
+    }
+
+    MappedQuadTree(const MappedQuadTree&) = delete;
+
+    MappedQuadTree& operator=(const MappedQuadTree&) = delete;
+
+    MappedQuadTree(MappedQuadTree&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+        , m_trailer(other.m_trailer)
+    {
+    }
+
+    MappedQuadTree& operator=(MappedQuadTree&& other) noexcept
+    {
+        if (this != std::addressof(other))
+        {
+            unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_trailer = other.m_trailer;
+        }
+        return *this;
+    }
+
+    ~MappedQuadTree()
+    {
+        unmap();
+    }
+
+    /**
+     * @brief   Finds values intersecting a given rectangle.
+     *
+     * @tparam  TOutIt The type of output iterator.
+     * @param   key The rectangle for query.
+     * @param   outIt The output iterator.
+     * @throws  space::io::FormatError if the file is malformed.
+     */
+    template <typename TOutIt>
+    void query(const TKey& key, TOutIt outIt) const
+    {
+        // The node offset and the region given by its parent.
+        space::collections::SmallStack<std::pair<std::uint64_t, TRegion>, TSplit::s_queryStackInlineSize> nodeStack;
+        if (0 != m_trailer.rootOffset)
+        {
+            nodeStack.emplace(m_trailer.rootOffset, readNodeFooter(m_trailer.rootOffset).region);
+        }
+
+        while (!nodeStack.empty())
+        {
+            const auto[offset, region] = nodeStack.top();
+            nodeStack.pop();
+            if (!space::util::hasIntersect(key, region))
+            {
+                continue;
+            }
+
+            const auto footer = readNodeFooter(offset, region);
+            pushChildren(footer, nodeStack);
+            const auto* values = valuesOf(offset, footer);
+            for (std::uint64_t i = 0; i < footer.valueCount; ++i)
+            {
+                const auto value = readValue(values, i, footer);
+                if (space::util::hasIntersect(key, value))
+                {
+                    outIt = value;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief   Determines whether the quadtree contains the specified key.
+     *
+     * @param   key The key to locate in the quadtree.
+     * @return  true if the quadtree contains an element with the specified key; otherwise, false.
+     * @throws  space::io::FormatError if the file is malformed.
+     */
+    [[nodiscard]]
+    bool contains(const TKey& key) const
+    {
+        if (0 == m_trailer.rootOffset)
+        {
+            return false;
+        }
+
+        auto offset = m_trailer.rootOffset;
+        auto footer = readNodeFooter(offset);
+        while (!TSplit::isAssociatedRegion(key, footer.region))
+        {
+            const auto childPosition = TSplit::getZOrderPos(footer.region, key);
+            offset = footer.children[static_cast<std::size_t>(childPosition)];
+            if (0 == offset)
+            {
+                return false;
+            }
+            footer = readNodeFooter(offset, TSplit::makeChildRegion(footer.region, childPosition));
+        }
+
+        // The node values are sorted.
+        const auto* values = valuesOf(offset, footer);
+        std::uint64_t first = 0;
+        std::uint64_t last = footer.valueCount;
+        while (first < last)
+        {
+            const auto middle = first + (last - first) / 2;
+            const auto value = readValue(values, middle, footer);
+            if (value == key)
+            {
+                return true;
+            }
+            if (value < key)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief   Finds the k values nearest to the given point, in the order of increasing distance.
+     *
+     * @details The best-first traversal: nodes and values are visited in the order of
+     *          the distance from the point to their boundary boxes.
+     *
+     * @tparam  TOutIt The type of output iterator.
+     * @param   point The point.
+     * @param   count The maximum number of values to find.
+     * @param   outIt The output iterator.
+     * @throws  space::io::FormatError if the file is malformed.
+     */
+    template <typename TOutIt>
+    void nearest(const space::Point<TCoordinate>& point, size_type count, TOutIt outIt) const
+    {
+        struct Candidate
+        {
+            double distance;
+            std::uint64_t nodeOffset;
+            TRegion region; // The region given by the parent, for the node candidates.
+            TKey value;
+
+            bool operator>(const Candidate& other) const noexcept
+            {
+                return distance > other.distance;
+            }
+        };
+
+        std::priority_queue<Candidate, space::collections::Vector<Candidate>, std::greater<>> candidates;
+        if (0 != m_trailer.rootOffset && 0 != count)
+        {
+            const auto footer = readNodeFooter(m_trailer.rootOffset);
+            candidates.push({squaredDistance(point, footer.region), m_trailer.rootOffset, footer.region, {}});
+        }
+
+        while (!candidates.empty())
+        {
+            const auto candidate = candidates.top();
+            candidates.pop();
+            if (0 == candidate.nodeOffset)
+            {
+                outIt = candidate.value;
+                if (0 == --count)
+                {
+                    return;
+                }
+                continue;
+            }
+
+            const auto footer = readNodeFooter(candidate.nodeOffset, candidate.region);
+            for (std::size_t i = 0; i < std::size(footer.children); ++i)
+            {
+                if (const auto child = footer.children[i]; 0 != child)
+                {
+                    const auto childRegion = TSplit::makeChildRegion(footer.region, static_cast<ZOrderPos>(i));
+                    candidates.push({squaredDistance(point, childRegion), child, childRegion, {}});
+                }
+            }
+            const auto* values = valuesOf(candidate.nodeOffset, footer);
+            for (std::uint64_t i = 0; i < footer.valueCount; ++i)
+            {
+                const auto value = readValue(values, i, footer);
+                candidates.push({squaredDistance(point, value), 0, {}, value});
+            }
+        }
+    }
+
+    /**
+     * @brief  Checks the container empty or not.
+     *
+     * @return true if the container is empty, otherwise false.
+     */
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return 0 == m_trailer.valueCount;
+    }
+
+    /**
+     * @brief   Get the number of values stored in the index.
+     *
+     * @return  The number of values stored in the index.
+     */
+    [[nodiscard]]
+    size_type size() const noexcept
+    {
+        return static_cast<size_type>(m_trailer.valueCount);
+    }
+
+private:
+
+    [[nodiscard]]
+    space::collections::Span<const std::byte> bytes() const noexcept
+    {
+        return {m_data, m_size};
+    }
+
+    [[nodiscard]]
+    typename TLayout::NodeFooter readNodeFooter(std::uint64_t offset) const
+    {
+        TLayout::validateNodeBounds(offset, 0, m_size);
+        auto footer = TLayout::readNodeFooter(m_data + offset);
+        TLayout::validateNodeBounds(offset, footer.valueCount, m_size);
+        TLayout::validateChildOffsets(offset, footer);
+        return footer;
+    }
+
+    /**
+     * @internal
+     * @brief   Reads the footer of the node which region is given by its parent.
+     */
+    [[nodiscard]]
+    typename TLayout::NodeFooter readNodeFooter(std::uint64_t offset, const TRegion& region) const
+    {
+        const auto footer = readNodeFooter(offset);
+        TLayout::validateChildRegion(footer, region);
+        return footer;
+    }
+
+    /**
+     * @internal
+     * @brief   Reads the node value, which must be placed at the node as the insertion does.
+     */
+    [[nodiscard]]
+    static TKey readValue(const std::byte* values, std::uint64_t index, const typename TLayout::NodeFooter& footer)
+    {
+        const auto value = TLayout::readKey(values + index * TLayout::s_keySize);
+        if (!TSplit::isValueOfRegion(value, footer.region))
+        {
+            throw space::io::FormatError {"The quadtree node value is out of its node."};
+        }
+        return value;
+    }
+
+    /**
+     * @internal
+     * @brief   Pushes the node children with their regions.
+     */
+    template <typename TStack>
+    static void pushChildren(const typename TLayout::NodeFooter& footer, TStack& nodeStack)
+    {
+        for (std::size_t i = 0; i < std::size(footer.children); ++i)
+        {
+            if (const auto child = footer.children[i]; 0 != child)
+            {
+                nodeStack.emplace(child, TSplit::makeChildRegion(footer.region, static_cast<ZOrderPos>(i)));
+            }
+        }
+    }
+
+    [[nodiscard]]
+    const std::byte* valuesOf(std::uint64_t offset, const typename TLayout::NodeFooter& footer) const noexcept
+    {
+        return m_data + (offset - footer.valueCount * TLayout::s_keySize);
+    }
+
+    /**
+     * @internal
+     * @brief   Returns the squared distance from the point to the orthogonal shape
+     *          (0 if the point is inside).
+     */
+    template <typename TOrthogonalShape>
+    static double squaredDistance(const space::Point<TCoordinate>& point, const TOrthogonalShape& shape) noexcept
+    {
+        const auto[x1, y1] = space::util::bottomLeftOf(shape);
+        const auto[x2, y2] = space::util::topRightOf(shape);
+        const auto px = static_cast<double>(point.x());
+        const auto py = static_cast<double>(point.y());
+        const auto dx = std::max({static_cast<double>(x1) - px, 0.0, px - static_cast<double>(x2)});
+        const auto dy = std::max({static_cast<double>(y1) - py, 0.0, py - static_cast<double>(y2)});
+        return dx * dx + dy * dy;
+    }
+
+    void unmap() noexcept
+    {
+        if (nullptr != m_data)
+        {
+            ::munmap(const_cast<std::byte*>(m_data), m_size);
+            m_data = nullptr;
+        }
+    }
+
+private:
+
+    /**
+     * @brief The mapped file.
+     */
+    const std::byte* m_data {nullptr};
+
+    /**
+     * @brief The size of the mapped file.
+     */
+    std::size_t m_size {0};
+
+    typename TLayout::Trailer m_trailer {};
+};
+
+} // namespace space
@@ -0,0 +1,525 @@
+/**
+ * @file        PagedQuadTree.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the PagedQuadTree class.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <list>
+#include <system_error>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Definitions.h"
+#include "QuadTree.h"
+#include "Serialization.h"
+
+namespace space
+{
+
+/**
+ * @brief   The read-only quadtree over the file written by QuadTree::save, which is read by
+ *          fixed-size pages through the bounded LRU page cache.
+ *
+ * @details The nodes are stored in the DFS post-order with children in the z-order, so every
+ *          subtree occupies a contiguous range of the file and the pages cluster the nodes by
+ *          the z-order. The missed pages are read with pread. Before descending, the pages of
+ *          the node children which intersect the query and are not resident are prefetched
+ *          with one advice per range of adjacent pages, so the kernel reads them in the
+ *          background.
+ *
+ *          The class is not thread-safe, even the const methods modify the page cache.
+ *          Requires POSIX.
+ *
+ * @tparam  TKey The type of values.
+ */
+template <typename TKey>
+class PagedQuadTree
+{
+    using TLayout = space::io::QuadTreeLayout<TKey>;
+    using TSplit = impl::QuadTreeSplit<TKey>;
+    using TNodeFooter = typename TLayout::NodeFooter;
+    using TRegion = typename TLayout::TRegion;
+    using ZOrderPos = typename TSplit::ZOrderPos;
+public:
+
+    using size_type = std::size_t;
+
+    /**
+     * @brief   The page cache configuration.
+     */
+    struct Config
+    {
+        /**
+         * @brief The page size in bytes.
+         */
+        std::size_t pageSize {64 << 10};
+
+        /**
+         * @brief The maximum number of resident pages.
+         */
+        std::size_t maxResidentPages {1024};
+
+        /**
+         * @brief Whether to prefetch the pages of node children.
+         */
+        bool prefetch {true};
+    };
+
+    /**
+     * @brief   The page cache counters.
+     */
+    struct CacheStatistics
+    {
+        std::uint64_t hits {0};
+        std::uint64_t misses {0};
+        std::uint64_t evictions {0};
+        std::uint64_t prefetchedPages {0};
+    };
+
+    /**
+     * @brief   Opens the given file.
+     *
+     * @param   path The path to the serialized quadtree.
+     * @param   config The page cache configuration.
+     * @throws  std::system_error if the file cannot be read.
+     * @throws  space::io::FormatError if the file is malformed.
+     */
+    explicit PagedQuadTree(const std::filesystem::path& path, Config config = {})
+        : m_config(config)
+    {
+        if (0 == m_config.pageSize || 0 == m_config.maxResidentPages)
+        {
+            throw std::invalid_argument {"The page size and the cache size must be positive."};
+        }
+
+        m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fd < 0)
+        {
+            throw std::system_error {errno, std::generic_category(), "Failed to open " + path.string()};
+        }
+
+        try
+        {
+            struct stat fileStat {};
+            if (0 != ::fstat(m_fd, &fileStat))
+            {
+                throw std::system_error {errno, std::generic_category(), "Failed to stat " + path.string()};
+            }
+            m_fileSize = static_cast<std::uint64_t>(fileStat.st_size);
+            if (m_fileSize < TLayout::s_headerSize + TLayout::s_trailerSize)
+            {
+                throw space::io::FormatError {"The serialized quadtree is truncated."};
+            }
+
+            space::collections::Array<std::byte, TLayout::s_headerSize> header {};
+            readBytes(0, std::size(header), header.data());
+            TLayout::validateHeader(header.data());
+
+            space::collections::Array<std::byte, TLayout::s_trailerSize> trailer {};
+            readBytes(m_fileSize - TLayout::s_trailerSize, std::size(trailer), trailer.data());
+            m_trailer = TLayout::readTrailer(trailer.data());
+            if (0 != m_trailer.rootOffset)
+            {
+                TLayout::validateNodeBounds(m_trailer.rootOffset, 0, m_fileSize);
+            }
+        }
+        catch (...)
+        {
+            ::close(m_fd);
+            throw;
+        }
+    }
+
+    PagedQuadTree(const PagedQuadTree&) = delete;
+
+    PagedQuadTree& operator=(const PagedQuadTree&) = delete;
+
+    ~PagedQuadTree()
+    {
+        ::close(m_fd);
+    }
+
+    /**
+     * @brief   Finds values intersecting a given rectangle.
+     *
+     * @tparam  TOutIt The type of output iterator.
+     * @param   key The rectangle for query.
+     * @param   outIt The output iterator.
+     */
+    template <typename TOutIt>
+    void query(const TKey& key, TOutIt outIt) const
+    {
+        if (0 == m_trailer.rootOffset)
+        {
+            return;
+        }
+        const auto rootRegion = readNodeFooter(m_trailer.rootOffset).region;
+        if (!space::util::hasIntersect(key, rootRegion))
+        {
+            return;
+        }
+
+        // The node offset and the region given by its parent, the pushed regions intersect the key.
+        space::collections::SmallStack<std::pair<std::uint64_t, TRegion>, TSplit::s_queryStackInlineSize> nodeStack;
+        nodeStack.emplace(m_trailer.rootOffset, rootRegion);
+        while (!nodeStack.empty())
+        {
+            const auto[offset, region] = nodeStack.top();
+            nodeStack.pop();
+
+            const auto footer = readNodeFooter(offset, region);
+            // The children are pruned by their regions, so the pages of the skipped children
+            // are neither prefetched nor read.
+            space::collections::Array<std::uint64_t, 4> children {};
+            for (std::size_t i = 0; i < std::size(footer.children); ++i)
+            {
+                if (const auto child = footer.children[i]; 0 != child)
+                {
+                    const auto childRegion = TSplit::makeChildRegion(footer.region, static_cast<ZOrderPos>(i));
+                    if (space::util::hasIntersect(key, childRegion))
+                    {
+                        children[i] = child;
+                        nodeStack.emplace(child, childRegion);
+                    }
+                }
+            }
+            prefetchChildren(children);
+            forEachValue(offset, footer, [&key, &outIt](const TKey& value)
+            {
+                if (space::util::hasIntersect(key, value))
+                {
+                    outIt = value;
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief   Determines whether the quadtree contains the specified key.
+     *
+     * @param   key The key to locate in the quadtree.
+     * @return  true if the quadtree contains an element with the specified key; otherwise, false.
+     */
+    [[nodiscard]]
+    bool contains(const TKey& key) const
+    {
+        if (0 == m_trailer.rootOffset)
+        {
+            return false;
+        }
+
+        auto offset = m_trailer.rootOffset;
+        auto footer = readNodeFooter(offset);
+        while (!TSplit::isAssociatedRegion(key, footer.region))
+        {
+            const auto childPosition = TSplit::getZOrderPos(footer.region, key);
+            offset = footer.children[static_cast<std::size_t>(childPosition)];
+            if (0 == offset)
+            {
+                return false;
+            }
+            footer = readNodeFooter(offset, TSplit::makeChildRegion(footer.region, childPosition));
+        }
+
+        // The node values are sorted, so only the probed values are read.
+        const auto valuesOffset = offset - footer.valueCount * TLayout::s_keySize;
+        std::uint64_t first = 0;
+        std::uint64_t last = footer.valueCount;
+        while (first < last)
+        {
+            const auto middle = first + (last - first) / 2;
+            space::collections::Array<std::byte, TLayout::s_keySize> buffer {};
+            readBytes(valuesOffset + middle * TLayout::s_keySize, std::size(buffer), buffer.data());
+            const auto value = readValue(buffer.data(), footer);
+            if (value == key)
+            {
+                return true;
+            }
+            if (value < key)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief  Checks the container empty or not.
+     *
+     * @return true if the container is empty, otherwise false.
+     */
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return 0 == m_trailer.valueCount;
+    }
+
+    /**
+     * @brief   Get the number of values stored in the index.
+     *
+     * @return  The number of values stored in the index.
+     */
+    [[nodiscard]]
+    size_type size() const noexcept
+    {
+        return static_cast<size_type>(m_trailer.valueCount);
+    }
+
+    /**
+     * @brief   Gets the page cache counters.
+     */
+    [[nodiscard]]
+    const CacheStatistics& cacheStatistics() const noexcept
+    {
+        return m_statistics;
+    }
+
+    /**
+     * @brief   Resets the page cache counters.
+     */
+    void resetCacheStatistics() noexcept
+    {
+        m_statistics = {};
+    }
+
+    /**
+     * @brief   Gets the number of resident pages.
+     */
+    [[nodiscard]]
+    std::size_t residentPages() const noexcept
+    {
+        return std::size(m_pages);
+    }
+
+private:
+
+    struct Page
+    {
+        space::collections::Vector<std::byte> data;
+        std::list<std::uint64_t>::iterator lruPos;
+    };
+
+    [[nodiscard]]
+    TNodeFooter readNodeFooter(std::uint64_t offset) const
+    {
+        TLayout::validateNodeBounds(offset, 0, m_fileSize);
+        space::collections::Array<std::byte, TLayout::s_nodeFooterSize> buffer {};
+        readBytes(offset, std::size(buffer), buffer.data());
+        auto footer = TLayout::readNodeFooter(buffer.data());
+        TLayout::validateNodeBounds(offset, footer.valueCount, m_fileSize);
+        TLayout::validateChildOffsets(offset, footer);
+        return footer;
+    }
+
+    /**
+     * @internal
+     * @brief   Reads the footer of the node which region is given by its parent.
+     */
+    [[nodiscard]]
+    TNodeFooter readNodeFooter(std::uint64_t offset, const TRegion& region) const
+    {
+        const auto footer = readNodeFooter(offset);
+        TLayout::validateChildRegion(footer, region);
+        return footer;
+    }
+
+    /**
+     * @internal
+     * @brief   Decodes the node value, which must be placed at the node as the insertion does.
+     */
+    [[nodiscard]]
+    static TKey readValue(const std::byte* src, const TNodeFooter& footer)
+    {
+        const auto value = TLayout::readKey(src);
+        if (!TSplit::isValueOfRegion(value, footer.region))
+        {
+            throw space::io::FormatError {"The quadtree node value is out of its node."};
+        }
+        return value;
+    }
+
+    /**
+     * @internal
+     * @brief   Decodes the node values page by page straight from the page cache, only the value
+     *          which crosses the page boundary is copied.
+     */
+    template <typename TFunc>
+    void forEachValue(std::uint64_t offset, const TNodeFooter& footer, TFunc func) const
+    {
+        auto position = offset - footer.valueCount * TLayout::s_keySize;
+        while (position < offset)
+        {
+            const auto pageOffset = position % m_config.pageSize;
+            const auto& data = page(position / m_config.pageSize);
+            if (pageOffset >= std::size(data))
+            {
+                throw space::io::FormatError {"Read out of the quadtree file bounds."};
+            }
+            const auto available = std::min<std::uint64_t>(offset - position, std::size(data) - pageOffset);
+            if (available < TLayout::s_keySize)
+            {
+                space::collections::Array<std::byte, TLayout::s_keySize> buffer {};
+                readBytes(position, std::size(buffer), buffer.data());
+                func(readValue(buffer.data(), footer));
+                position += TLayout::s_keySize;
+                continue;
+            }
+
+            const auto count = available / TLayout::s_keySize;
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                func(readValue(data.data() + pageOffset + i * TLayout::s_keySize, footer));
+            }
+            position += count * TLayout::s_keySize;
+        }
+    }
+
+    /**
+     * @internal
+     * @brief   Copies the file bytes to the given memory through the page cache.
+     */
+    void readBytes(std::uint64_t offset, std::uint64_t size, std::byte* dst) const
+    {
+        while (0 != size)
+        {
+            const auto pageIndex = offset / m_config.pageSize;
+            const auto pageOffset = offset % m_config.pageSize;
+            const auto& data = page(pageIndex);
+            if (pageOffset >= std::size(data))
+            {
+                throw space::io::FormatError {"Read out of the quadtree file bounds."};
+            }
+            const auto count = std::min<std::uint64_t>(size, std::size(data) - pageOffset);
+            std::memcpy(dst, data.data() + pageOffset, count);
+            dst += count;
+            offset += count;
+            size -= count;
+        }
+    }
+
+    /**
+     * @internal
+     * @brief   Returns the page data, reads the page if it is not resident.
+     */
+    const space::collections::Vector<std::byte>& page(std::uint64_t pageIndex) const
+    {
+        if (auto it = m_pages.find(pageIndex); m_pages.end() != it)
+        {
+            ++m_statistics.hits;
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+            return it->second.data;
+        }
+
+        ++m_statistics.misses;
+        space::collections::Vector<std::byte> data;
+        if (std::size(m_pages) >= m_config.maxResidentPages)
+        {
+            // Reuse the buffer of the least recently used page.
+            const auto victim = m_lru.back();
+            m_lru.pop_back();
+            auto victimIt = m_pages.find(victim);
+            data = std::move(victimIt->second.data);
+            m_pages.erase(victimIt);
+            ++m_statistics.evictions;
+        }
+
+        const auto offset = pageIndex * m_config.pageSize;
+        data.resize(static_cast<std::size_t>(std::min<std::uint64_t>(m_config.pageSize, m_fileSize - offset)));
+        readFromFile(offset, data);
+
+        m_lru.push_front(pageIndex);
+        auto& page = m_pages[pageIndex];
+        page.data = std::move(data);
+        page.lruPos = m_lru.begin();
+        return page.data;
+    }
+
+    void readFromFile(std::uint64_t offset, space::collections::Vector<std::byte>& data) const
+    {
+        std::size_t done = 0;
+        while (done < std::size(data))
+        {
+            const auto result = ::pread(m_fd, data.data() + done, std::size(data) - done
+                , static_cast<off_t>(offset + done));
+            if (result < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                throw std::system_error {errno, std::generic_category(), "Failed to read the quadtree page"};
+            }
+            if (0 == result)
+            {
+                throw space::io::FormatError {"The serialized quadtree is truncated."};
+            }
+            done += static_cast<std::size_t>(result);
+        }
+    }
+
+    /**
+     * @internal
+     * @brief   Advises the kernel to read the non-resident pages of the given node children,
+     *          the adjacent pages are requested by one call. The zero offsets are skipped.
+     */
+    void prefetchChildren(const space::collections::Array<std::uint64_t, 4>& children) const
+    {
+        if (!m_config.prefetch)
+        {
+            return;
+        }
+
+        space::collections::Array<std::uint64_t, 4> pages {};
+        std::size_t count = 0;
+        for (const auto child : children)
+        {
+            const auto pageIndex = child / m_config.pageSize;
+            if (0 != child && !m_pages.contains(pageIndex))
+            {
+                pages[count++] = pageIndex;
+            }
+        }
+        std::sort(pages.begin(), pages.begin() + static_cast<std::ptrdiff_t>(count));
+
+        for (std::size_t i = 0; i < count;)
+        {
+            auto last = i;
+            while (last + 1 < count && pages[last + 1] <= pages[last] + 1)
+            {
+                ++last;
+            }
+            const auto length = (pages[last] - pages[i] + 1) * m_config.pageSize;
+            ::posix_fadvise(m_fd, static_cast<off_t>(pages[i] * m_config.pageSize), static_cast<off_t>(length)
+                , POSIX_FADV_WILLNEED);
+            m_statistics.prefetchedPages += pages[last] - pages[i] + 1;
+            i = last + 1;
+        }
+    }
+
+private:
+    Config m_config;
+    int m_fd {-1};
+    std::uint64_t m_fileSize {0};
+    typename TLayout::Trailer m_trailer {};
+
+    mutable std::unordered_map<std::uint64_t, Page> m_pages {};
+    mutable std::list<std::uint64_t> m_lru {};
+    mutable CacheStatistics m_statistics {};
+};
+
+} // namespace space
@@ -160,6 +160,11 @@ public:
 
 private:
 
+    /**
+     * @brief   The decoders fill the contours in place.
+     */
+    friend struct space::io::impl::GeometryAccess;
+
     /**
      * @brief   The polygon representation by polygons. The first item represents
      *          the polygon outside boundaries the others represent holes.
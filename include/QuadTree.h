@@ -10,25 +10,47 @@
 
 #include <memory>
 #include <algorithm>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <bit>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
 
 #include "Definitions.h"
+#include "Serialization.h"
 
 #include "Point.h"
+#include "QuadTreeNodeStorage.h"
+#include "QueryInstrumentation.h"
 #include "Square.h"
 #include "Utility.h"
 
 namespace space
 {
 
+namespace impl
+{
+
 /**
- * @brief   Implementation of quadtree.
+ * @internal
+ * @brief   The rules of splitting the quadtree regions, shared by all quadtree representations.
  *
  * @tparam  TKey The type of values.
  */
 template <typename TKey>
-class QuadTree
+class QuadTreeSplit
 {
-private:
+public:
+    using TCoordinate = typename TKey::TCoordinate;
+    using TRegion = space::Square<TCoordinate>;
+    using TBounds = space::Rect<TCoordinate>;
 
     enum class ZOrderPos : size_t
     {
@@ -38,462 +60,1764 @@ private:
         , RightBottom = 3
     };
 
-    class Node
+    /**
+     * @internal
+     * @brief   The inline capacity of the query traversal stacks. The depth-first traversal
+     *          keeps at most 3 pending siblings per level, so the queries of trees up to 32
+     *          levels deep do not allocate.
+     */
+    static constexpr std::size_t s_queryStackInlineSize = 3 * 32 + 1;
+
+    /**
+     * @internal
+     * @brief       Return the middle x-axis coordinate for the given region.
+     *
+     * @param rect  The region.
+     * @return      The middle x-axis coordinate
+     */
+    static auto getRectMiddleX(const TRegion& rect)
     {
-    public:
-        using TValue = TKey;
-        using TRegion = space::Square<typename TKey::TCoordinate>;
-        using TChildContainer = space::collections::Array<std::unique_ptr<Node>, 4>;
-        using TValueContainer = space::collections::FlatSet<TValue>;
+        return (rect.pos().x() + (rect.size() / 2));
+    }
 
-        Node() = delete;
+    /**
+     * @internal
+     * @brief       Return the middle y-axis coordinate for the given region.
+     *
+     * @param rect  The region.
+     * @return      The middle y-axis coordinate
+     */
+    static auto getRectMiddleY(const TRegion& rect)
+    {
+        return (rect.pos().y() + (rect.size() / 2));
+    }
 
-        explicit Node(TRegion region)
-            : m_region(region)
-        {
-        }
+    /**
+     * @internal
+     * @brief           Checks the given rectangle has an intersection with region split lines.
+     *
+     * @param rect      The rectangle.
+     * @param region    The region.
+     * @return          true if has intersection, otherwise false.
+     */
+    static bool hasIntersectionWithRegionSplitLines(const TKey& rect, const TRegion& region)
+    {
+        const auto middleX = getRectMiddleX(region);
+        const auto middleY = getRectMiddleY(region);
+        return ((rect.pos().x() <= middleX) && (middleX <= rect.pos().x() + rect.width()))
+               || ((rect.pos().y() <= middleY) && (middleY <= rect.pos().y() + rect.height()));
+    }
 
-        bool addValue(const TValue& box)
-        {
-            const auto[it, success] = m_values.insert(box);
-            return success;
-        }
 
-        bool eraseValue(const TValue& box)
+    /**
+     * @internal
+     * @brief           Returns the z-order position for the given rectangle.
+     *
+     * @param region    The region.
+     * @param key       The key.
+     * @return          The z-order position.
+     */
+    static ZOrderPos getZOrderPos(const TRegion& region, const TKey& key)
+    {
+        const auto middleX = getRectMiddleX(region);
+        const auto middleY = getRectMiddleY(region);
+        const auto[x, y] = key.pos();
+        if (x < middleX)
         {
-            return m_values.erase(box);
+            if (y > middleY)
+            {
+                return ZOrderPos::LeftTop;
+            }
+            return ZOrderPos::LeftBottom;
         }
-
-        void setChild(ZOrderPos pos, std::unique_ptr<Node>&& child)
+        if (y > middleY)
         {
-            m_child[static_cast<std::size_t>(pos)] = std::move(child);
+            return ZOrderPos::RightTop;
         }
+        return ZOrderPos::RightBottom;
+    }
 
-        [[nodiscard]]
-        std::unique_ptr<Node>& getChild(ZOrderPos pos) noexcept
-        {
-            return m_child[static_cast<std::size_t>(pos)];
-        }
 
-        [[nodiscard]]
-        TChildContainer& getChildren() noexcept
-        {
-            return m_child;
-        }
+    /**
+     * @internal
+     * @brief           Makes this region for the child.
+     *
+     * @param region    The parent region.
+     * @param zOrderPos The z-order position.
+     * @return          The new region for child.
+     */
+    static TRegion makeChildRegion(const TRegion& region, ZOrderPos zOrderPos)
+    {
+        const auto middleX = getRectMiddleX(region);
+        const auto middleY = getRectMiddleY(region);
+        const auto size = static_cast<typename TRegion::TCoordinate>(std::round(region.size() / 2.0));
 
-        [[nodiscard]]
-        const TChildContainer& getChildren() const noexcept
+        switch (zOrderPos)
         {
-            return m_child;
+            case ZOrderPos::LeftTop:
+                return TRegion {{region.pos().x(), middleY}, size};
+            case ZOrderPos::LeftBottom:
+                return TRegion {region.pos(), size};
+            case ZOrderPos::RightTop:
+                return TRegion {{middleX, middleY}, size};
+            case ZOrderPos::RightBottom:
+                return TRegion {{middleX, region.pos().y()}, size};
+            default:
+                assert(false && "404");
         }
+    }
 
-        [[nodiscard]]
-        const TValueContainer& getValues() const noexcept
+    /**
+     * @internal
+     * @brief           Checks the given region belongs to the associated node of the key, the
+     *                  key intersects its split lines or the region cannot be split further.
+     *
+     * @param key       The key.
+     * @param region    The region.
+     * @return          true if the key is kept by the node of the region, otherwise false.
+     */
+    static bool isAssociatedRegion(const TKey& key, const TRegion& region)
+    {
+        return hasIntersectionWithRegionSplitLines(key, region) || 1 == region.size();
+    }
+
+    /**
+     * @internal
+     * @brief           Checks the value lies in the region and is kept by its node, as the
+     *                  insertion places it.
+     *
+     * @param value     The value.
+     * @param region    The node region.
+     * @return          true if the value belongs to the node of the region, otherwise false.
+     */
+    static bool isValueOfRegion(const TKey& value, const TRegion& region)
+    {
+        return space::util::contains(region, value) && isAssociatedRegion(value, region);
+    }
+
+    /**
+     * @internal
+     * @brief       Checks the key fits in the largest root region, the non-negative coordinate
+     *              range. Called before the tree is changed by the insertion.
+     *
+     * @param key   The key.
+     * @throws std::out_of_range if the key is out of the range.
+     */
+    static void checkCoordinateRange(const TKey& key)
+    {
+        if (!space::util::contains(TRegion {{0, 0}, std::numeric_limits<TCoordinate>::max()}, key))
         {
-            return m_values;
+            throw std::out_of_range {"The key is out of the quadtree coordinate range."};
         }
+    }
 
-        [[nodiscard]]
-        TValueContainer& getValues() noexcept
+    /**
+     * @internal
+     * @brief       Returns the root region for the first key, the smallest power of two square
+     *              at the origin which contains the key top-right corner.
+     *
+     * @details     The size is computed in the coordinate type, so it does not lose precision
+     *              for the 64-bit coordinates. It saturates at the largest coordinate.
+     *
+     * @param key   The key.
+     * @return      The root region.
+     */
+    static TRegion makeRootRegion(const TKey& key)
+    {
+        using TUnsigned = std::make_unsigned_t<TCoordinate>;
+        const auto[x, y] = space::util::topRightOf(key);
+        const auto maxCoordinate = std::max({x, y, TCoordinate {0}});
+        return TRegion {{0, 0}, doubledSize(static_cast<TCoordinate>(std::bit_floor(static_cast<TUnsigned>(maxCoordinate))))};
+    }
+
+    /**
+     * @internal
+     * @brief               Grows up the tree until the root region contains the key.
+     *
+     * @details             Every new root region is twice larger and keeps the old root as the
+     *                      left-bottom child.
+     *
+     * @tparam TNodePtr     The type of node unique_ptr.
+     * @tparam TOnGrown     The type of callback, invocable with (new root, old root).
+     * @param root          The root, not null.
+     * @param key           The key.
+     * @param onRootGrown   The callback for copying the subtree summaries to the new root.
+     */
+    template <typename TNodePtr, typename TOnGrown>
+    static void growUp(TNodePtr& root, const TKey& key, TOnGrown&& onRootGrown)
+    {
+        while (!space::util::contains(root->region(), key))
         {
-            return m_values;
+            auto newRoot = std::make_unique<typename TNodePtr::element_type>(
+                TRegion {{0, 0}, doubledSize(root->region().size())});
+            onRootGrown(*newRoot, *root);
+            newRoot->getChild(ZOrderPos::LeftBottom) = std::move(root);
+            root = std::move(newRoot);
         }
+    }
 
-        [[nodiscard]]
-        TRegion& region() noexcept
+    /**
+     * @internal
+     * @brief               Creates the missing nodes on the path to the associated node of the key.
+     *
+     * @tparam TNode        The type of node.
+     * @tparam TOnVisit     The type of callback, invocable with the node reference.
+     * @param root          The root, its region contains the key.
+     * @param key           The key.
+     * @param onNodeVisited The callback called for every node from the root to the associated node.
+     * @return              The associated node of the key.
+     */
+    template <typename TNode, typename TOnVisit>
+    static TNode* growDown(TNode& root, const TKey& key, TOnVisit&& onNodeVisited)
+    {
+        auto* currentNode = std::addressof(root);
+        onNodeVisited(*currentNode);
+        while (!isAssociatedRegion(key, currentNode->region()))
         {
-            return m_region;
+            const auto childPosition = getZOrderPos(currentNode->region(), key);
+            auto& child = currentNode->getChild(childPosition);
+            if (nullptr == child)
+            {
+                child = std::make_unique<TNode>(makeChildRegion(currentNode->region(), childPosition));
+            }
+            currentNode = child.get();
+            onNodeVisited(*currentNode);
         }
+        return currentNode;
+    }
 
-        [[nodiscard]]
-        const TRegion& region() const noexcept
+    /**
+     * @internal
+     * @brief               Finds the associated node of the key.
+     *
+     * @tparam TNodePtr     The type of node unique_ptr (const or not).
+     * @tparam TOnVisit     The type of callback, invocable with the node unique_ptr pointer.
+     * @param root          The root.
+     * @param key           The key.
+     * @param onNodeVisited The callback called for every node from the root to the associated node.
+     * @return              The pointer to node unique_ptr if that exists, otherwise null.
+     */
+    template <typename TNodePtr, typename TOnVisit>
+    static TNodePtr* findNode(TNodePtr& root, const TKey& key, TOnVisit&& onNodeVisited)
+    {
+        if (nullptr == root)
         {
-            return m_region;
+            return nullptr;
         }
-
-        [[nodiscard]]
-        bool empty() const noexcept
+        auto* currentNode = std::addressof(root);
+        onNodeVisited(currentNode);
+        while (!isAssociatedRegion(key, (*currentNode)->region()))
         {
-            if (!getValues().empty())
+            auto& child = (*currentNode)->getChild(getZOrderPos((*currentNode)->region(), key));
+            if (nullptr == child)
             {
-                return false;
+                return nullptr;
             }
-            return std::ranges::all_of(getChildren(), [](const auto& child)
-            {
-                return nullptr == child;
-            });
+            currentNode = std::addressof(child);
+            onNodeVisited(currentNode);
         }
-
-    private:
-        TRegion m_region;
-        TChildContainer m_child;
-        TValueContainer m_values;
-    };
-
-
-    using TRegion = typename Node::TRegion;
-private:
-
-    using TNodePtr = std::unique_ptr<Node>;
-public:
-
-    using size_type = std::size_t;
-
-    QuadTree()
-        : m_root(nullptr)
-        , m_size(0)
-    {
+        return currentNode;
     }
 
     /**
-     * @brief   Inserts a value to the quad tree.
+     * @internal
+     * @brief       Returns the bounding box of the bounds and the shape.
      *
-     * @param   key The new value.
-     * @return  true if value successfully inserted, otherwise false.
+     * @param bounds    The bounds, empty if nothing is bounded yet.
+     * @param shape     The shape.
+     * @return          The united bounds.
      */
-    bool insert(const TKey& key)
+    template <typename TShape>
+    static TBounds unite(const std::optional<TBounds>& bounds, const TShape& shape) noexcept
     {
-        if (nullptr == m_root)
+        if (!bounds.has_value())
         {
-            creatRoot(key);
+            return TBounds {space::util::bottomLeftOf(shape), space::util::topRightOf(shape)};
         }
+        const auto[x1, y1] = space::util::bottomLeftOf(*bounds);
+        const auto[x2, y2] = space::util::topRightOf(*bounds);
+        const auto[shapeX1, shapeY1] = space::util::bottomLeftOf(shape);
+        const auto[shapeX2, shapeY2] = space::util::topRightOf(shape);
+        using TPoint = space::Point<TCoordinate>;
+        return TBounds {TPoint {std::min(x1, shapeX1), std::min(y1, shapeY1)}
+                        , TPoint {std::max(x2, shapeX2), std::max(y2, shapeY2)}};
+    }
 
-        growUpIfNeeds(key);
+private:
 
-        auto* node = growDownIfNeedsAndReturnLastNode(key);
-        if (node->addValue(key))
+    /**
+     * @internal
+     * @brief       Doubles the region size, saturates at the largest coordinate.
+     *
+     * @param size  The region size, 0 gives 1.
+     * @return      The doubled size.
+     */
+    static TCoordinate doubledSize(TCoordinate size) noexcept
+    {
+        if (0 == size)
         {
-            ++m_size;
-            return true;
+            return 1;
         }
-        return false;
+        if (size > std::numeric_limits<TCoordinate>::max() / 2)
+        {
+            return std::numeric_limits<TCoordinate>::max();
+        }
+        return static_cast<TCoordinate>(size << 1);
     }
+}; // class QuadTreeSplit
+
+} // namespace impl
+
+/**
+ * @brief   The memory used by the index.
+ */
+struct MemoryUsage
+{
+    /**
+     * @brief   The bytes of the nodes themselves (including the inline part of value containers).
+     */
+    std::size_t nodeBytes {0};
+
+    /**
+     * @brief   The bytes occupied by the values.
+     */
+    std::size_t valueBytes {0};
+
+    /**
+     * @brief   The bytes allocated for the values but not used (the unused capacity).
+     */
+    std::size_t slackBytes {0};
+
+    /**
+     * @brief   Gets the total number of bytes.
+     */
+    [[nodiscard]]
+    constexpr std::size_t total() const noexcept
+    {
+        return nodeBytes + valueBytes + slackBytes;
+    }
+};
+
+/**
+ * @brief   The shape statistics of the quadtree.
+ */
+struct QuadTreeStatistics
+{
+    std::size_t nodeCount {0};
+
+    /**
+     * @brief   The number of nodes without values (the nodes kept only for the children).
+     */
+    std::size_t emptyNodeCount {0};
+
+    std::size_t valueCount {0};
+
+    /**
+     * @brief   The number of values stored in the root.
+     */
+    std::size_t rootValueCount {0};
+
+    /**
+     * @brief   The number of values kept in the upper nodes because they cross the split lines
+     *          of the node region (all values except the ones in the unit regions).
+     */
+    std::size_t straddlingValueCount {0};
+
+    /**
+     * @brief   The number of nodes at each depth (the root depth is 0).
+     */
+    space::collections::Vector<std::size_t> depthHistogram;
+
+    /**
+     * @brief   The number of nodes by the number of values: the bucket 0 is for the nodes
+     *          without values, the bucket i is for [2^(i-1), 2^i) values.
+     */
+    space::collections::Vector<std::size_t> valuesPerNodeHistogram;
+
+    /**
+     * @brief   The average number of children of the non-leaf nodes.
+     */
+    double averageFanOut {0.0};
+};
+
+/**
+ * @brief   Implementation of quadtree.
+ *
+ * @tparam  TKey The type of values.
+ * @tparam  TNodeStorage The type of node values storage (space::FlatNodeStorage or
+ *          space::QuantizedNodeStorage).
+ * @tparam  TInstrumentation The instrumentation policy of query and contains
+ *          (space::NoQueryInstrumentation or space::CountingQueryInstrumentation).
+ */
+template <typename TKey
+          , typename TNodeStorage = space::FlatNodeStorage<TKey>
+          , typename TInstrumentation = space::NoQueryInstrumentation>
+class QuadTree
+{
+private:
+
+    using TSplit = impl::QuadTreeSplit<TKey>;
+    using ZOrderPos = typename TSplit::ZOrderPos;
+
+    class Node
+    {
+    public:
+        using TValue = TKey;
+        using TRegion = space::Square<typename TKey::TCoordinate>;
+        using TChildContainer = space::collections::Array<std::unique_ptr<Node>, 4>;
+        using TValueContainer = TNodeStorage;
+        using TBounds = space::Rect<typename TKey::TCoordinate>;
+
+        Node() = delete;
+
+        explicit Node(TRegion region)
+            : m_region(region)
+            , m_values(region)
+        {
+        }
+
+        bool addValue(const TValue& box)
+        {
+            return m_values.insert(box);
+        }
+
+        bool eraseValue(const TValue& box)
+        {
+            return m_values.erase(box);
+        }
+
+        void adoptValues(typename TValueContainer::sequence_type&& values)
+        {
+            m_values.adopt(std::move(values));
+        }
+
+        void setChild(ZOrderPos pos, std::unique_ptr<Node>&& child)
+        {
+            m_child[static_cast<std::size_t>(pos)] = std::move(child);
+        }
+
+        [[nodiscard]]
+        std::unique_ptr<Node>& getChild(ZOrderPos pos) noexcept
+        {
+            return m_child[static_cast<std::size_t>(pos)];
+        }
+
+        [[nodiscard]]
+        TChildContainer& getChildren() noexcept
+        {
+            return m_child;
+        }
+
+        [[nodiscard]]
+        const TChildContainer& getChildren() const noexcept
+        {
+            return m_child;
+        }
+
+        [[nodiscard]]
+        const TValueContainer& getValues() const noexcept
+        {
+            return m_values;
+        }
+
+        [[nodiscard]]
+        TValueContainer& getValues() noexcept
+        {
+            return m_values;
+        }
+
+        [[nodiscard]]
+        TRegion& region() noexcept
+        {
+            return m_region;
+        }
+
+        [[nodiscard]]
+        const TRegion& region() const noexcept
+        {
+            return m_region;
+        }
+
+        [[nodiscard]]
+        bool empty() const noexcept
+        {
+            if (!getValues().empty())
+            {
+                return false;
+            }
+            return std::ranges::all_of(getChildren(), [](const auto& child)
+            {
+                return nullptr == child;
+            });
+        }
+
+        /**
+         * @brief   Gets the bounding box of all values in the subtree, empty if the subtree
+         *          has no values.
+         */
+        [[nodiscard]]
+        const std::optional<TBounds>& bounds() const noexcept
+        {
+            return m_bounds;
+        }
+
+        void setBounds(const std::optional<TBounds>& bounds) noexcept
+        {
+            m_bounds = bounds;
+        }
+
+        void extendBounds(const TKey& key) noexcept
+        {
+            m_bounds = TSplit::unite(m_bounds, key);
+        }
+
+        /**
+         * @brief   Recomputes the bounds from the node values and the children bounds.
+         *
+         * @return  true if the bounds are changed.
+         */
+        bool recomputeBounds()
+        {
+            std::optional<TBounds> bounds;
+            for (const TKey& value : getValues())
+            {
+                bounds = TSplit::unite(bounds, value);
+            }
+            for (const auto& child : getChildren())
+            {
+                if (nullptr != child && child->bounds().has_value())
+                {
+                    bounds = TSplit::unite(bounds, *child->bounds());
+                }
+            }
+            const auto changed = bounds != m_bounds;
+            m_bounds = bounds;
+            return changed;
+        }
+
+        /**
+         * @brief   Gets the number of values in the subtree.
+         */
+        [[nodiscard]]
+        std::size_t subtreeSize() const noexcept
+        {
+            return m_subtreeSize;
+        }
+
+        void setSubtreeSize(std::size_t size) noexcept
+        {
+            m_subtreeSize = size;
+        }
+
+        void increaseSubtreeSize() noexcept
+        {
+            ++m_subtreeSize;
+        }
+
+        void decreaseSubtreeSize() noexcept
+        {
+            --m_subtreeSize;
+        }
+
+        /**
+         * @brief   Recomputes the subtree size from the node values and the children subtree sizes.
+         */
+        void recomputeSubtreeSize() noexcept
+        {
+            m_subtreeSize = std::size(getValues());
+            for (const auto& child : getChildren())
+            {
+                if (nullptr != child)
+                {
+                    m_subtreeSize += child->subtreeSize();
+                }
+            }
+        }
+
+    private:
+        TRegion m_region;
+        TChildContainer m_child;
+        TValueContainer m_values;
+        std::optional<TBounds> m_bounds;
+        std::size_t m_subtreeSize {0};
+    };
+
+
+    using TRegion = typename Node::TRegion;
+private:
+
+    using TNodePtr = std::unique_ptr<Node>;
+
+    /**
+     * @internal
+     * @brief   The inline capacity of the root-to-node paths.
+     */
+    static constexpr std::size_t s_pathInlineSize = 32;
+
+    /**
+     * @internal
+     * @brief   The inline capacity of the covered subtrees and the boundary matches of sampling.
+     */
+    static constexpr std::size_t s_sampleInlineSize = 64;
+public:
+
+    using key_type = TKey;
+    using size_type = std::size_t;
+
+    QuadTree()
+        : m_root(nullptr)
+        , m_size(0)
+    {
+    }
+
+    /**
+     * @brief   Inserts a value to the quad tree.
+     *
+     * @param   key The new value.
+     * @return  true if value successfully inserted, otherwise false.
+     * @throws  std::out_of_range if the key is out of the non-negative coordinate range.
+     */
+    bool insert(const TKey& key)
+    {
+        TSplit::checkCoordinateRange(key);
+        if (nullptr == m_root)
+        {
+            creatRoot(key);
+        }
+
+        growUpIfNeeds(key);
+
+        space::collections::SmallVector<Node*, s_pathInlineSize> path;
+        auto* node = growDownIfNeedsAndReturnLastNode(key, path);
+        if (node->addValue(key))
+        {
+            for (auto* pathNode : path)
+            {
+                pathNode->increaseSubtreeSize();
+            }
+            ++m_size;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief   Finds values intersecting a given rectangle.
+     *
+     * @details The nodes are pruned by the bounding box of their subtree values. If the
+     *          bounding box lies entirely inside the query rectangle, every value of the
+     *          subtree is reported without the intersection tests.
+     *
+     * @tparam  TOutIt The type of output iterator.
+     * @param   key The rectangle for query.
+     * @param   outIt The output iterator.
+     */
+    template <typename TOutIt>
+    void query(const TKey& key, TOutIt outIt) const
+    {
+        TInstrumentation::queryStarted();
+        // The node and whether its region is covered by the query.
+        using TFrame = std::pair<const Node*, bool>;
+        space::collections::SmallStack<TFrame, TSplit::s_queryStackInlineSize> nodeStack;
+        auto pushNodeIfNotNull = [&nodeStack](const Node* node, bool covered)
+        {
+            if (nullptr == node)
+            {
+                return;
+            }
+            nodeStack.emplace(node, covered);
+            TInstrumentation::stackSize(nodeStack.size());
+        };
+        auto popNode = [&nodeStack]()
+        {
+            const auto frame = nodeStack.top();
+            nodeStack.pop();
+            return frame;
+        };
+        pushNodeIfNotNull(m_root.get(), false);
+
+        while (!nodeStack.empty())
+        {
+            auto[currentNode, covered] = popNode();
+            TInstrumentation::nodeVisited();
+            if (!covered)
+            {
+                const auto& bounds = currentNode->bounds();
+                if (!bounds.has_value() || !space::util::hasIntersect(key, *bounds))
+                {
+                    TInstrumentation::nodePruned();
+                    continue;
+                }
+                covered = space::util::contains(key, *bounds);
+            }
+            for (auto& child : currentNode->getChildren())
+            {
+                pushNodeIfNotNull(child.get(), covered);
+            }
+            if (covered)
+            {
+                for (const TKey& value : currentNode->getValues())
+                {
+                    TInstrumentation::valueMatched();
+                    outIt = value;
+                }
+                continue;
+            }
+            TInstrumentation::valuesTested(std::size(currentNode->getValues()));
+            currentNode->getValues().forEachIntersecting(key, [&outIt](const TKey& value)
+            {
+                TInstrumentation::valueMatched();
+                outIt = value;
+            });
+        }
+    }
+
+    /**
+     * @brief   Counts values intersecting a given rectangle.
+     *
+     * @details The subtrees which bounding box lies entirely inside the query rectangle are
+     *          counted by the subtree sizes, only the values of the partially overlapped nodes
+     *          are tested.
+     *
+     * @param   key The rectangle for query.
+     * @return  The number of values intersecting the rectangle.
+     */
+    [[nodiscard]]
+    size_type count(const TKey& key) const
+    {
+        return countIntersecting(key, std::numeric_limits<std::size_t>::max(), [](const Node&) noexcept {});
+    }
+
+    /**
+     * @brief   Estimates the number of values intersecting a given rectangle.
+     *
+     * @details Counts as count() down to the given depth. The partially overlapped subtrees at
+     *          that depth are not descended, their values are assumed to be uniformly spread
+     *          over the subtree bounding box, so they add the subtree size multiplied by the
+     *          overlapped fraction of the box.
+     *
+     * @param   key The rectangle for query.
+     * @param   maxDepth The depth of the deepest visited nodes, the root is at depth 0.
+     * @return  The estimated number of values intersecting the rectangle.
+     */
+    [[nodiscard]]
+    double estimateCount(const TKey& key, std::size_t maxDepth) const
+    {
+        double estimate = 0.0;
+        const auto exactCount = countIntersecting(key, maxDepth, [&key, &estimate](const Node& node) noexcept
+        {
+            estimate += static_cast<double>(node.subtreeSize()) * overlappedFraction(key, *node.bounds());
+        });
+        return static_cast<double>(exactCount) + estimate;
+    }
+
+    /**
+     * @brief   Reports the given number of distinct values chosen uniformly at random from the
+     *          values intersecting a given rectangle.
+     *
+     * @details The traversal counts the subtrees which bounding box lies inside the rectangle by
+     *          their subtree sizes and tests only the values of the partially overlapped nodes,
+     *          as count() does. Then every sampled match is found by descending the covered
+     *          subtree by the subtree sizes, so the complexity is O(k log n) plus the boundary
+     *          traversal instead of reporting all matches. The values are reported in random
+     *          order.
+     *
+     * @tparam  TRandomEngine The type of uniform random bit generator.
+     * @tparam  TOutIt The type of output iterator.
+     * @param   key The rectangle for query.
+     * @param   sampleSize The number of values to report.
+     * @param   engine The random engine.
+     * @param   outIt The output iterator.
+     * @return  The number of reported values, less than the sample size only if there are
+     *          less values intersecting the rectangle.
+     */
+    template <typename TRandomEngine, typename TOutIt>
+    size_type sample(const TKey& key, size_type sampleSize, TRandomEngine& engine, TOutIt outIt) const
+    {
+        TInstrumentation::queryStarted();
+        struct CoveredNode
+        {
+            const Node* node;
+            size_type cumulativeSize;
+        };
+        space::collections::SmallVector<CoveredNode, s_sampleInlineSize> coveredNodes;
+        space::collections::SmallVector<TKey, s_sampleInlineSize> boundaryMatches;
+        space::collections::SmallStack<const Node*, TSplit::s_queryStackInlineSize> nodeStack;
+        if (nullptr != m_root)
+        {
+            nodeStack.push(m_root.get());
+        }
+        size_type coveredSize = 0;
+        while (!nodeStack.empty())
+        {
+            const auto* currentNode = nodeStack.top();
+            nodeStack.pop();
+            TInstrumentation::nodeVisited();
+            const auto& bounds = currentNode->bounds();
+            if (!bounds.has_value() || !space::util::hasIntersect(key, *bounds))
+            {
+                TInstrumentation::nodePruned();
+                continue;
+            }
+            if (space::util::contains(key, *bounds))
+            {
+                coveredSize += currentNode->subtreeSize();
+                coveredNodes.push_back(CoveredNode {currentNode, coveredSize});
+                continue;
+            }
+            for (const auto& child : currentNode->getChildren())
+            {
+                if (nullptr != child)
+                {
+                    nodeStack.push(child.get());
+                }
+            }
+            TInstrumentation::valuesTested(std::size(currentNode->getValues()));
+            currentNode->getValues().forEachIntersecting(key, [&boundaryMatches](const TKey& value)
+            {
+                boundaryMatches.push_back(value);
+            });
+        }
+
+        // The matches are indexed as the boundary matches followed by the covered subtrees.
+        const auto matchCount = std::size(boundaryMatches) + coveredSize;
+        auto matchAt = [&boundaryMatches, &coveredNodes](size_type index)
+        {
+            if (index < std::size(boundaryMatches))
+            {
+                return boundaryMatches[index];
+            }
+            index -= std::size(boundaryMatches);
+            const auto& covered = *std::ranges::upper_bound(coveredNodes, index, {}, &CoveredNode::cumulativeSize);
+            return valueOfSubtree(*covered.node, index - (covered.cumulativeSize - covered.node->subtreeSize()));
+        };
+        auto report = [&outIt](const TKey& value)
+        {
+            TInstrumentation::valueMatched();
+            outIt = value;
+        };
+
+        if (matchCount <= 2 * sampleSize)
+        {
+            // The partial Fisher-Yates shuffle, the rejection of repeated indices is slow here.
+            space::collections::Vector<size_type> indices(matchCount);
+            std::iota(std::begin(indices), std::end(indices), size_type {0});
+            const auto reportedSize = std::min(sampleSize, matchCount);
+            for (size_type i = 0; i < reportedSize; ++i)
+            {
+                std::swap(indices[i], indices[std::uniform_int_distribution<size_type> {i, matchCount - 1}(engine)]);
+                report(matchAt(indices[i]));
+            }
+            return reportedSize;
+        }
+
+        // Every draw is a new index with the probability of at least 1/2. The indices are
+        // reported in the draw order, so any prefix of the result is a uniform sample too.
+        space::collections::FlatSet<size_type> sampled;
+        sampled.reserve(sampleSize);
+        std::uniform_int_distribution<size_type> distribution {0, matchCount - 1};
+        while (std::size(sampled) < sampleSize)
+        {
+            const auto index = distribution(engine);
+            if (sampled.insert(index).second)
+            {
+                report(matchAt(index));
+            }
+        }
+        return sampleSize;
+    }
+
+    /**
+     * @brief   Calls the callback for every pair of stored values which have an intersection.
+     *
+     * @details Each pair is reported exactly once. The values of every node are checked
+     *          against each other and against the values stored in the descendant nodes
+     *          only, so the upper nodes are visited once instead of once per value.
+     *
+     * @tparam  TCallback The type of callback, invocable with (const TKey&, const TKey&).
+     * @param   callback The callback.
+     */
+    template <typename TCallback>
+    void forEachOverlappingPair(TCallback callback) const
+    {
+        forEachOverlappingPair(std::execution::seq, std::move(callback));
+    }
+
+    /**
+     * @brief   Calls the callback for every pair of stored values which have an intersection.
+     *
+     * @details For the non-sequenced policies the upper levels of the tree are processed
+     *          first, then the remaining independent subtrees are processed with the given
+     *          execution policy. In that case the callback must be thread-safe.
+     *
+     * @tparam  TExecutionPolicy The type of execution policy.
+     * @tparam  TCallback The type of callback, invocable with (const TKey&, const TKey&).
+     * @param   policy The execution policy.
+     * @param   callback The callback.
+     */
+    template <typename TExecutionPolicy, typename TCallback>
+        requires std::is_execution_policy_v<std::remove_cvref_t<TExecutionPolicy>>
+    void forEachOverlappingPair(TExecutionPolicy&& policy, TCallback callback) const
+    {
+        if (nullptr == m_root)
+        {
+            return;
+        }
+
+        space::collections::Vector<OverlapTask> tasks {OverlapTask {m_root.get(), {}}};
+        if constexpr (!std::is_same_v<std::remove_cvref_t<TExecutionPolicy>, std::execution::sequenced_policy>)
+        {
+            const auto desiredTaskCount = std::max(1u, std::thread::hardware_concurrency()) * 4;
+            while (std::size(tasks) < desiredTaskCount)
+            {
+                space::collections::Vector<OverlapTask> nextTasks;
+                for (const auto& task : tasks)
+                {
+                    reportNodeOverlappingPairs(task, callback);
+                    pushChildOverlapTasks(task, nextTasks);
+                }
+                if (nextTasks.empty())
+                {
+                    return;
+                }
+                tasks = std::move(nextTasks);
+            }
+        }
+
+        std::for_each(std::forward<TExecutionPolicy>(policy), std::begin(tasks), std::end(tasks)
+            , [&callback](const OverlapTask& task)
+            {
+                reportSubtreeOverlappingPairs(task, callback);
+            });
+    }
+
+    /**
+     * @brief   Removes given rectangle form quadtree.
+     *
+     * @param   key the rectangle.
+     */
+    void remove(const TKey& key)
+    {
+        space::collections::SmallVector<TNodePtr*, s_pathInlineSize> path;
+        auto* node = findNode(key, [&path](TNodePtr* pathNode)
+        {
+            path.push_back(pathNode);
+        });
+        if (nullptr == node || !(*node)->eraseValue(key))
+        {
+            return;
+        }
+        --m_size;
+        for (auto* pathNode : path)
+        {
+            (*pathNode)->decreaseSubtreeSize();
+        }
+
+        // remove node if empty.
+        if ((*node)->empty())
+        {
+            node->reset(nullptr);
+            path.pop_back();
+        }
+        shrinkBounds(path, key);
+    }
+
+    /**
+     * @brief   Determines whether the quadtree contains the specified key.
+     *
+     * @param   key The key to locate in the quadtree.
+     * @return  true if the quadtree contains an element with the specified key; otherwise, false.
+     */
+    [[nodiscard]]
+    bool contains(const TKey& key) const
+    {
+        TInstrumentation::queryStarted();
+        const auto pNode = findNode(key, &TInstrumentation::nodeVisited);
+        if (nullptr == pNode)
+        {
+            return false;
+        }
+        TInstrumentation::valuesTested(1);
+        if (!(*pNode)->getValues().contains(key))
+        {
+            return false;
+        }
+        TInstrumentation::valueMatched();
+        return true;
+    }
+
+    /**
+     * @brief  Checks the container empty or not.
+     *
+     * @return true if the container is empty, otherwise false.
+     */
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return (nullptr == m_root) || m_root->empty();
+    }
+
+    /**
+     * @brief Removes all values stored in the container.
+     */
+    void clear()
+    {
+        m_root.reset();
+        m_size = 0;
+    }
+
+    /**
+     * @brief   Get the number of values stored in the index.
+     *
+     * @return  The number of values stored in the index.
+     */
+    [[nodiscard]]
+    size_type size() const noexcept
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief   Computes the memory used by the quadtree.
+     *
+     * @details The allocator overhead per allocation is not included. The complexity is
+     *          O(number of nodes).
+     *
+     * @return  The memory usage.
+     */
+    [[nodiscard]]
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage usage;
+        forEachNode([&usage](const Node& node, std::size_t)
+        {
+            const auto& values = node.getValues();
+            usage.nodeBytes += sizeof(Node);
+            usage.valueBytes += values.usedBytes();
+            usage.slackBytes += values.allocatedBytes() - values.usedBytes();
+        });
+        return usage;
+    }
+
+    /**
+     * @brief   Computes the shape statistics of the quadtree in one traversal.
+     *
+     * @return  The statistics.
+     */
+    [[nodiscard]]
+    QuadTreeStatistics stats() const
+    {
+        QuadTreeStatistics stats;
+        std::size_t innerNodeCount = 0;
+        std::size_t childCount = 0;
+        forEachNode([&](const Node& node, std::size_t depth)
+        {
+            const auto valueCount = std::size(node.getValues());
+            const auto bucket = static_cast<std::size_t>(std::bit_width(valueCount));
+            const auto nodeChildCount = static_cast<std::size_t>(std::ranges::count_if(node.getChildren()
+                , [](const auto& child)
+                {
+                    return nullptr != child;
+                }));
+
+            ++stats.nodeCount;
+            stats.valueCount += valueCount;
+            if (0 == valueCount)
+            {
+                ++stats.emptyNodeCount;
+            }
+            if (0 == depth)
+            {
+                stats.rootValueCount = valueCount;
+            }
+            if (1 != node.region().size())
+            {
+                stats.straddlingValueCount += valueCount;
+            }
+            if (0 != nodeChildCount)
+            {
+                ++innerNodeCount;
+                childCount += nodeChildCount;
+            }
+            if (std::size(stats.depthHistogram) <= depth)
+            {
+                stats.depthHistogram.resize(depth + 1);
+            }
+            ++stats.depthHistogram[depth];
+            if (std::size(stats.valuesPerNodeHistogram) <= bucket)
+            {
+                stats.valuesPerNodeHistogram.resize(bucket + 1);
+            }
+            ++stats.valuesPerNodeHistogram[bucket];
+        });
+        if (0 != innerNodeCount)
+        {
+            stats.averageFanOut = static_cast<double>(childCount) / static_cast<double>(innerNodeCount);
+        }
+        return stats;
+    }
+
+    /**
+     * @brief   Writes the node regions as the SVG image for the visual inspection.
+     *
+     * @details The y-axis is directed up as in the tree. The nodes are filled with the
+     *          opacity proportional to the number of values, the title of each rectangle
+     *          has the depth and the number of values.
+     *
+     * @param   os The output stream.
+     */
+    void writeSvg(std::ostream& os) const
+    {
+        if (nullptr == m_root)
+        {
+            os << R"(<svg xmlns="http://www.w3.org/2000/svg" viewBox="0 0 1 1"/>)" << '\n';
+            return;
+        }
+
+        std::size_t maxValueCount = 1;
+        forEachNode([&maxValueCount](const Node& node, std::size_t)
+        {
+            maxValueCount = std::max(maxValueCount, std::size(node.getValues()));
+        });
+
+        const auto& rootRegion = m_root->region();
+        const auto size = static_cast<double>(rootRegion.size());
+        os << R"(<svg xmlns="http://www.w3.org/2000/svg" viewBox=")" << rootRegion.pos().x() << ' '
+           << rootRegion.pos().y() << ' ' << size << ' ' << size << R"(">)" << '\n'
+           << R"(<g transform="matrix(1 0 0 -1 0 )" << (2.0 * static_cast<double>(rootRegion.pos().y()) + size)
+           << R"svg()" fill="red" stroke="black" stroke-width=")svg" << size / 1024.0 << R"(">)" << '\n';
+        forEachNode([&](const Node& node, std::size_t depth)
+        {
+            const auto& region = node.region();
+            const auto valueCount = std::size(node.getValues());
+            os << R"(<rect x=")" << region.pos().x() << R"(" y=")" << region.pos().y()
+               << R"(" width=")" << region.size() << R"(" height=")" << region.size()
+               << R"(" fill-opacity=")" << static_cast<double>(valueCount) / static_cast<double>(maxValueCount)
+               << R"("><title>depth )" << depth << ", values " << valueCount << "</title></rect>\n";
+        });
+        os << "</g>\n</svg>\n";
+    }
+
+    /**
+     * @brief   Writes the quadtree to the output stream in the binary format.
+     *
+     * @details The nodes are written in the DFS post-order, the values of each node are
+     *          written contiguously. See space::io::QuadTreeLayout for the format description.
+     *
+     * @param   os The output stream (must be opened in binary mode).
+     * @throws  std::runtime_error if writing failed.
+     */
+    void save(std::ostream& os) const
+    {
+        space::io::QuadTreeWriter<TKey> writer {os};
+        std::uint64_t rootOffset = 0;
+
+        struct SaveFrame
+        {
+            const Node* node;
+            std::size_t nextChild;
+            typename space::io::QuadTreeWriter<TKey>::TChildOffsets children;
+        };
+        space::collections::Vector<SaveFrame> frameStack;
+        if (nullptr != m_root)
+        {
+            frameStack.push_back({m_root.get(), 0, {}});
+        }
+
+        while (!frameStack.empty())
+        {
+            auto& frame = frameStack.back();
+            if (frame.nextChild < std::size(frame.children))
+            {
+                const auto* child = frame.node->getChildren()[frame.nextChild++].get();
+                if (nullptr != child)
+                {
+                    frameStack.push_back({child, 0, {}});
+                }
+                continue;
+            }
+
+            const auto offset = writer.writeNode(frame.node->region(), frame.children, frame.node->getValues());
+            frameStack.pop_back();
+            if (frameStack.empty())
+            {
+                rootOffset = offset;
+            }
+            else
+            {
+                auto& parent = frameStack.back();
+                parent.children[parent.nextChild - 1] = offset;
+            }
+        }
+
+        writer.finish(rootOffset);
+    }
+
+    /**
+     * @brief   Writes the quadtree to the file in the binary format.
+     *
+     * @param   path The file path.
+     * @throws  std::runtime_error if writing failed.
+     */
+    void save(const std::filesystem::path& path) const
+    {
+        std::ofstream os {path, std::ios::binary | std::ios::trunc};
+        if (!os)
+        {
+            throw std::runtime_error {"Failed to open the file " + path.string()};
+        }
+        save(os);
+    }
+
+    /**
+     * @brief   Reads the quadtree written by save from the input stream.
+     *
+     * @details The whole stream is read at once, the nodes are created directly from
+     *          the stored topology without inserting the values one by one.
+     *
+     * @param   is The input stream (must be opened in binary mode).
+     * @return  The loaded quadtree.
+     * @throws  space::io::FormatError if the data is malformed.
+     */
+    [[nodiscard]]
+    static QuadTree load(std::istream& is)
+    {
+        const auto data = space::io::readAll(is);
+        return load(space::collections::Span<const std::byte> {data});
+    }
+
+    /**
+     * @brief   Reads the quadtree written by save from the file.
+     *
+     * @param   path The file path.
+     * @return  The loaded quadtree.
+     * @throws  std::runtime_error if the file cannot be opened.
+     * @throws  space::io::FormatError if the data is malformed.
+     */
+    [[nodiscard]]
+    static QuadTree load(const std::filesystem::path& path)
+    {
+        std::ifstream is {path, std::ios::binary};
+        if (!is)
+        {
+            throw std::runtime_error {"Failed to open the file " + path.string()};
+        }
+        return load(is);
+    }
+
+    /**
+     * @brief   Reads the quadtree written by save from the memory.
+     *
+     * @param   data The serialized quadtree.
+     * @return  The loaded quadtree.
+     * @throws  space::io::FormatError if the data is malformed.
+     */
+    [[nodiscard]]
+    static QuadTree load(space::collections::Span<const std::byte> data)
+    {
+        using TLayout = space::io::QuadTreeLayout<TKey>;
+        const auto trailer = space::io::validateQuadTree<TKey>(data);
+
+        QuadTree tree;
+        if (0 == trailer.rootOffset)
+        {
+            return tree;
+        }
+
+        struct PendingNode
+        {
+            TNodePtr* node;
+            std::uint64_t offset;
+            std::optional<TRegion> region; // The region given by the parent, none for the root.
+        };
+
+        std::uint64_t nodeCount = 0;
+        std::unordered_set<std::uint64_t> childOffsets;
+        space::collections::Vector<PendingNode> nodeStack {{std::addressof(tree.m_root), trailer.rootOffset, {}}};
+        while (!nodeStack.empty())
+        {
+            const auto[pNode, offset, region] = nodeStack.back();
+            nodeStack.pop_back();
+
+            // The shared children could make the tree exponentially larger than the file.
+            if (++nodeCount > trailer.nodeCount)
+            {
+                throw space::io::FormatError {"The quadtree node or value count mismatch."};
+            }
+            TLayout::validateNodeBounds(offset, 0, std::size(data));
+            const auto footer = TLayout::readNodeFooter(data.data() + offset);
+            TLayout::validateNodeBounds(offset, footer.valueCount, std::size(data));
+            TLayout::validateChildOffsets(offset, footer);
+            if (region.has_value())
+            {
+                TLayout::validateChildRegion(footer, *region);
+            }
+            const auto valuesOffset = offset - footer.valueCount * TLayout::s_keySize;
+
+            auto node = std::make_unique<Node>(footer.region);
+            typename Node::TValueContainer::sequence_type values;
+            values.reserve(footer.valueCount);
+            for (std::uint64_t i = 0; i < footer.valueCount; ++i)
+            {
+                values.push_back(TLayout::readKey(data.data() + valuesOffset + i * TLayout::s_keySize));
+            }
+            // The values must be where the insertion places them, otherwise they are not found.
+            if (!std::ranges::all_of(values, [&footer](const auto& value)
+                    { return TSplit::isValueOfRegion(value, footer.region); }))
+            {
+                throw space::io::FormatError {"The quadtree node value is out of its node."};
+            }
+            if (std::end(values) != std::ranges::adjacent_find(values, std::greater_equal<> {}))
+            {
+                throw space::io::FormatError {"The quadtree node values are not ordered."};
+            }
+            node->adoptValues(std::move(values));
+
+            for (std::size_t i = 0; i < std::size(footer.children); ++i)
+            {
+                const auto childOffset = footer.children[i];
+                if (0 == childOffset)
+                {
+                    continue;
+                }
+                if (!childOffsets.insert(childOffset).second)
+                {
+                    throw space::io::FormatError {"The quadtree node topology is malformed."};
+                }
+                const auto childPosition = static_cast<ZOrderPos>(i);
+                nodeStack.push_back({std::addressof(node->getChild(childPosition)), childOffset
+                                     , TSplit::makeChildRegion(footer.region, childPosition)});
+            }
+
+            tree.m_size += footer.valueCount;
+            *pNode = std::move(node);
+        }
+
+        if (nodeCount != trailer.nodeCount || tree.m_size != trailer.valueCount)
+        {
+            throw space::io::FormatError {"The quadtree node or value count mismatch."};
+        }
+        tree.recomputeSubtreeSummaries();
+        return tree;
+    }
+
+private:
 
     /**
-     * @brief   Finds values intersecting a given rectangle.
+     * @internal
+     * @brief       Calls the function for every node in the DFS pre-order.
      *
-     * @tparam  TOutIt The type of output iterator.
-     * @param   key The rectangle for query.
-     * @param   outIt The output iterator.
+     * @tparam TFunc The type of function, invocable with (const Node&, std::size_t depth).
+     * @param func  The function.
      */
-    template <typename TOutIt>
-    void query(const TKey& key, TOutIt outIt) const
+    template <typename TFunc>
+    void forEachNode(TFunc&& func) const
     {
-        space::collections::Stack<const Node*> nodeStack;
-        auto pushNodeIfNotNull = [&nodeStack](const Node* node)
+        space::collections::Vector<std::pair<const Node*, std::size_t>> nodeStack;
+        if (nullptr != m_root)
         {
-            if (nullptr == node)
+            nodeStack.emplace_back(m_root.get(), 0);
+        }
+        while (!nodeStack.empty())
+        {
+            const auto[node, depth] = nodeStack.back();
+            nodeStack.pop_back();
+            func(*node, depth);
+            for (const auto& child : node->getChildren())
             {
-                return;
+                if (nullptr != child)
+                {
+                    nodeStack.emplace_back(child.get(), depth + 1);
+                }
             }
-            nodeStack.push(node);
-        };
-        auto popNode = [&nodeStack]()
+        }
+    }
+
+    /**
+     * @internal
+     * @brief                   Counts values intersecting a given rectangle down to the given depth.
+     *
+     * @tparam TOnDepthLimit    The type of callback, invocable with (const Node&).
+     * @param key               The rectangle for query.
+     * @param maxDepth          The depth of the deepest visited nodes.
+     * @param onDepthLimit      The callback for the partially overlapped nodes at the max depth,
+     *                          their values are not counted.
+     * @return                  The number of counted values.
+     */
+    template <typename TOnDepthLimit>
+    size_type countIntersecting(const TKey& key, std::size_t maxDepth, TOnDepthLimit onDepthLimit) const
+    {
+        TInstrumentation::queryStarted();
+        using TFrame = std::pair<const Node*, std::size_t>;
+        space::collections::SmallStack<TFrame, TSplit::s_queryStackInlineSize> nodeStack;
+        if (nullptr != m_root)
         {
-            auto* node = nodeStack.top();
-            nodeStack.pop();
-            return node;
-        };
-        pushNodeIfNotNull(m_root.get());
+            nodeStack.emplace(m_root.get(), 0);
+        }
 
+        size_type count = 0;
         while (!nodeStack.empty())
         {
-            const Node* currentNode = popNode();
-            if (!space::util::hasIntersect(key, currentNode->region()))
+            const auto[currentNode, depth] = nodeStack.top();
+            nodeStack.pop();
+            TInstrumentation::nodeVisited();
+            const auto& bounds = currentNode->bounds();
+            if (!bounds.has_value() || !space::util::hasIntersect(key, *bounds))
             {
+                TInstrumentation::nodePruned();
                 continue;
             }
-            for (auto& child : currentNode->getChildren())
+            if (space::util::contains(key, *bounds))
+            {
+                count += currentNode->subtreeSize();
+                continue;
+            }
+            if (depth >= maxDepth)
             {
-                pushNodeIfNotNull(child.get());
+                onDepthLimit(*currentNode);
+                continue;
             }
-            for (const auto& value : currentNode->getValues())
+            for (auto& child : currentNode->getChildren())
             {
-                if (!space::util::hasIntersect(key, value))
+                if (nullptr != child)
                 {
-                    continue;
+                    nodeStack.emplace(child.get(), depth + 1);
+                    TInstrumentation::stackSize(nodeStack.size());
                 }
-                outIt = value;
             }
+            TInstrumentation::valuesTested(std::size(currentNode->getValues()));
+            currentNode->getValues().forEachIntersecting(key, [&count](const TKey&) noexcept
+            {
+                ++count;
+            });
         }
+        return count;
     }
 
     /**
-     * @brief   Removes given rectangle form quadtree.
+     * @internal
+     * @brief           Gets the value of the subtree by its index, the node values are followed
+     *                  by the children subtrees in the z-order.
      *
-     * @param   key the rectangle.
+     * @param node      The subtree root.
+     * @param index     The index of value, less than the subtree size.
+     * @return          The value.
      */
-    void remove(const TKey& key)
+    static TKey valueOfSubtree(const Node& node, size_type index)
     {
-        auto* node = findNode(key);
-        if (nullptr == node)
-        {
-            return;
-        }
-        if ((*node)->eraseValue(key))
-        {
-            --m_size;
-        }
-
-        // remove node if empty.
-        if ((*node)->empty())
+        const auto* currentNode = std::addressof(node);
+        while (true)
         {
-            node->reset(nullptr);
+            const auto& values = currentNode->getValues();
+            if (index < std::size(values))
+            {
+                return *std::next(std::begin(values), static_cast<std::ptrdiff_t>(index));
+            }
+            index -= std::size(values);
+            for (const auto& child : currentNode->getChildren())
+            {
+                if (nullptr == child)
+                {
+                    continue;
+                }
+                if (index < child->subtreeSize())
+                {
+                    currentNode = child.get();
+                    break;
+                }
+                index -= child->subtreeSize();
+            }
         }
     }
 
     /**
-     * @brief   Determines whether the quadtree contains the specified key.
-     *
-     * @param   key The key to locate in the quadtree.
-     * @return  true if the quadtree contains an element with the specified key; otherwise, false.
+     * @internal
+     * @brief   Computes the fraction of the bounds area overlapped by the key, the degenerate
+     *          dimensions of the bounds are considered fully overlapped.
      */
-    [[nodiscard]]
-    bool contains(const TKey& key) const
+    template <typename TBounds>
+    static double overlappedFraction(const TKey& key, const TBounds& bounds) noexcept
     {
-        const auto pNode = findNode(key);
-        if (nullptr == pNode)
+        const auto[x1, y1] = space::util::bottomLeftOf(bounds);
+        const auto[x2, y2] = space::util::topRightOf(bounds);
+        const auto[keyX1, keyY1] = space::util::bottomLeftOf(key);
+        const auto[keyX2, keyY2] = space::util::topRightOf(key);
+        auto fraction = [](auto first, auto last, auto overlapFirst, auto overlapLast) noexcept
         {
-            return false;
-        }
-        const auto& values = (*pNode)->getValues();
-        return values.end() != values.find(key);
+            if (first == last)
+            {
+                return 1.0;
+            }
+            return (static_cast<double>(overlapLast) - static_cast<double>(overlapFirst))
+                   / (static_cast<double>(last) - static_cast<double>(first));
+        };
+        return fraction(x1, x2, std::max(x1, keyX1), std::min(x2, keyX2))
+               * fraction(y1, y2, std::max(y1, keyY1), std::min(y2, keyY2));
     }
 
     /**
-     * @brief  Checks the container empty or not.
-     *
-     * @return true if the container is empty, otherwise false.
+     * @internal
+     * @brief   Recomputes the bounds and the subtree sizes of all nodes, the children before
+     *          the parents.
      */
-    [[nodiscard]]
-    bool empty() const noexcept
+    void recomputeSubtreeSummaries()
     {
-        return (nullptr == m_root) || m_root->empty();
+        space::collections::Vector<Node*> nodes;
+        if (nullptr != m_root)
+        {
+            nodes.push_back(m_root.get());
+        }
+        // The pre-order list reversed has every child before its parent.
+        for (std::size_t i = 0; i < std::size(nodes); ++i)
+        {
+            for (const auto& child : nodes[i]->getChildren())
+            {
+                if (nullptr != child)
+                {
+                    nodes.push_back(child.get());
+                }
+            }
+        }
+        for (auto it = std::rbegin(nodes); it != std::rend(nodes); ++it)
+        {
+            (*it)->recomputeBounds();
+            (*it)->recomputeSubtreeSize();
+        }
     }
 
     /**
-     * @brief Removes all values stored in the container.
+     * @internal
+     * @brief   The unit of work for the overlapping pairs search: the node and the values
+     *          of its ancestors which have an intersection with the node region.
      */
-    void clear()
+    struct OverlapTask
     {
-        m_root.reset();
-    }
+        const Node* node;
+        space::collections::Vector<TKey> ancestorValues;
+    };
 
     /**
-     * @brief   Get the number of values stored in the index.
+     * @internal
+     * @brief           Reports the overlapping pairs formed by the node values with each other
+     *                  and with the ancestor values.
      *
-     * @return  The number of values stored in the index.
+     * @param task      The task.
+     * @param callback  The callback.
      */
-    [[nodiscard]]
-    size_type size() const noexcept
+    template <typename TCallback>
+    static void reportNodeOverlappingPairs(const OverlapTask& task, TCallback& callback)
     {
-        return m_size;
+        const auto& values = task.node->getValues();
+        for (auto it = std::begin(values); it != std::end(values); ++it)
+        {
+            const TKey& value = *it;
+            for (const auto& ancestorValue : task.ancestorValues)
+            {
+                if (space::util::hasIntersect(ancestorValue, value))
+                {
+                    callback(ancestorValue, value);
+                }
+            }
+            for (auto nextIt = std::next(it); nextIt != std::end(values); ++nextIt)
+            {
+                const TKey& nextValue = *nextIt;
+                if (space::util::hasIntersect(value, nextValue))
+                {
+                    callback(value, nextValue);
+                }
+            }
+        }
     }
 
-private:
-
     /**
      * @internal
-     * @brief   Returns node for the given key.
+     * @brief           Creates the tasks for the node children.
      *
-     * @param   key The key.
-     * @return  The pointer to node unique_ptr if that exists, otherwise null.
+     * @details         Only the ancestor and node values which have an intersection with the
+     *                  child region are passed to the child task.
+     *
+     * @param task      The parent task.
+     * @param outTasks  The container for new tasks.
      */
-    const TNodePtr* findNode(const TKey& key) const
+    static void pushChildOverlapTasks(const OverlapTask& task, space::collections::Vector<OverlapTask>& outTasks)
     {
-        if (nullptr == m_root)
+        for (const auto& child : task.node->getChildren())
         {
-            return nullptr;
-        }
-        auto* currentNode = std::addressof(m_root);
-        while (!hasIntersectionWithRegionSplitLines(key, (*currentNode)->region()))
-        {
-            const auto zOrderPos = getZOrderPos((*currentNode)->region(), key);
-            auto& child = (*currentNode)->getChild(zOrderPos);
-
             if (nullptr == child)
             {
-                return nullptr;
+                continue;
             }
-            currentNode = std::addressof(child);
+            OverlapTask childTask {child.get(), {}};
+            for (const auto& ancestorValue : task.ancestorValues)
+            {
+                if (space::util::hasIntersect(ancestorValue, child->region()))
+                {
+                    childTask.ancestorValues.push_back(ancestorValue);
+                }
+            }
+            for (const auto& value : task.node->getValues())
+            {
+                if (space::util::hasIntersect(value, child->region()))
+                {
+                    childTask.ancestorValues.push_back(value);
+                }
+            }
+            outTasks.push_back(std::move(childTask));
         }
-        return currentNode;
-    }
-
-    TNodePtr* findNode(const TKey& key)
-    {
-        return const_cast<TNodePtr*>(std::as_const(*this).findNode(key));
     }
 
     /**
      * @internal
-     * @brief       Creates new root.
+     * @brief           Reports the overlapping pairs for the whole subtree of the task node.
      *
-     * @details     The new root region can contain the given key.
-     * @param key   The key for computing region size.
+     * @param task      The root task of subtree.
+     * @param callback  The callback.
      */
-    void creatRoot(const TKey& key)
+    template <typename TCallback>
+    static void reportSubtreeOverlappingPairs(const OverlapTask& task, TCallback& callback)
     {
-        const auto[x, y] = space::util::topRightOf(key);
-        auto regionSize = static_cast<int32_t>(std::pow(2, static_cast<int32_t>(std::log2(std::max(x, y))) + 1));
-        if (0 == regionSize)
+        space::collections::Vector<OverlapTask> taskStack;
+        reportNodeOverlappingPairs(task, callback);
+        pushChildOverlapTasks(task, taskStack);
+        while (!taskStack.empty())
         {
-            regionSize = 1;
+            const auto currentTask = std::move(taskStack.back());
+            taskStack.pop_back();
+            reportNodeOverlappingPairs(currentTask, callback);
+            pushChildOverlapTasks(currentTask, taskStack);
         }
-
-        TRegion regionForNewNode {{0, 0}, regionSize};
-        m_root = std::make_unique<Node>(regionForNewNode);
     }
 
     /**
      * @internal
-     * @brief   Grow up the tree if the given key cannot contain in the root.
-     *
-     * @details Creates new root and set old root the child for it.
+     * @brief               Returns node for the given key.
      *
-     * @param   key The rectangle.
+     * @tparam TOnVisit     The type of callback called for every node on the path.
+     * @param key           The key.
+     * @param onNodeVisited The callback.
+     * @return              The pointer to node unique_ptr if that exists, otherwise null.
      */
-    void growUpIfNeeds(const TKey& key)
+    template <typename TOnVisit = void(*)() noexcept>
+    const TNodePtr* findNode(const TKey& key, TOnVisit onNodeVisited = [] () noexcept {}) const
     {
-        while (!space::util::contains(m_root->region(), key))
+        return findNodeImpl(*this, key, [&onNodeVisited](const TNodePtr*)
         {
-            const auto regionSize = m_root->region().size() << 1;
-            TRegion regionSizeForNewRoot {{0, 0}, regionSize};
-            auto newRoot = std::make_unique<Node>(regionSizeForNewRoot);
-            newRoot->setChild(ZOrderPos::LeftBottom, std::move(m_root));
-            m_root = std::move(newRoot);
-        }
+            onNodeVisited();
+        });
     }
 
     /**
      * @internal
-     * @brief       Grow down the tree if the associated node for key not exists.
-     *              Returns associated node for the key.
+     * @brief               Returns node for the given key.
      *
-     * @param key   The rectangle.
-     * @return      The associated node pointer for the key.
+     * @tparam TOnVisit     The type of callback, invocable with (TNodePtr*) for every node on the path.
+     * @param key           The key.
+     * @param onNodeVisited The callback.
+     * @return              The pointer to node unique_ptr if that exists, otherwise null.
      */
-    Node* growDownIfNeedsAndReturnLastNode(const TKey& key)
+    template <typename TOnVisit>
+    TNodePtr* findNode(const TKey& key, TOnVisit onNodeVisited)
     {
-        auto* currentNode = m_root.get();
-        while (!(hasIntersectionWithRegionSplitLines(key, currentNode->region())
-                 || 1 == currentNode->region().size()))
-        {
-            const auto childPosition = getZOrderPos(currentNode->region(), key);
-            auto& child = currentNode->getChild(childPosition);
-            if (nullptr == child)
-            {
-                auto newChildRegion = makeChildRegion(currentNode->region(), childPosition);
-                child = std::make_unique<Node>(newChildRegion);
-            }
-            currentNode = child.get();
-        }
-
-        return currentNode;
+        return findNodeImpl(*this, key, onNodeVisited);
     }
 
-
-private:
+    template <typename TSelf, typename TOnVisit>
+    static auto findNodeImpl(TSelf& self, const TKey& key, TOnVisit&& onNodeVisited)
+        -> decltype(std::addressof(self.m_root))
+    {
+        return TSplit::findNode(self.m_root, key, onNodeVisited);
+    }
 
     /**
      * @internal
-     * @brief       Return the middle x-axis coordinate for the given region.
+     * @brief       Shrinks the bounds of the nodes on the path after the key removing.
      *
-     * @param rect  The region.
-     * @return      The middle x-axis coordinate
+     * @details     The bounds are recomputed only if the key was on the bounds edge, from the
+     *              deepest node up to the first node which bounds are not changed.
+     *
+     * @param path  The path from the root to the node of the removed key.
+     * @param key   The removed key.
      */
-    static auto getRectMiddleX(const TRegion& rect)
+    template <typename TPath>
+    static void shrinkBounds(const TPath& path, const TKey& key)
     {
-        return (rect.pos().x() + (rect.size() / 2));
+        for (auto it = std::rbegin(path); it != std::rend(path); ++it)
+        {
+            auto& node = **it;
+            const auto& bounds = node->bounds();
+            if (bounds.has_value() && isStrictlyInside(key, *bounds))
+            {
+                return;
+            }
+            if (!node->recomputeBounds())
+            {
+                return;
+            }
+        }
     }
 
-    /**
-     * @internal
-     * @brief       Return the middle y-axis coordinate for the given region.
-     *
-     * @param rect  The region.
-     * @return      The middle y-axis coordinate
-     */
-    static auto getRectMiddleY(const TRegion& rect)
+    template <typename TBounds>
+    static bool isStrictlyInside(const TKey& key, const TBounds& bounds) noexcept
     {
-        return (rect.pos().y() + (rect.size() / 2));
+        const auto[x1, y1] = space::util::bottomLeftOf(bounds);
+        const auto[x2, y2] = space::util::topRightOf(bounds);
+        const auto[keyX1, keyY1] = space::util::bottomLeftOf(key);
+        const auto[keyX2, keyY2] = space::util::topRightOf(key);
+        return x1 < keyX1 && y1 < keyY1 && keyX2 < x2 && keyY2 < y2;
     }
 
     /**
      * @internal
-     * @brief           Checks the given rectangle has an intersection with region split lines.
+     * @brief       Creates new root.
      *
-     * @param rect      The rectangle.
-     * @param region    The region.
-     * @return          true if has intersection, otherwise false.
+     * @details     The new root region can contain the given key.
+     * @param key   The key for computing region size.
      */
-    static bool hasIntersectionWithRegionSplitLines(const TKey& rect, const TRegion& region)
+    void creatRoot(const TKey& key)
     {
-        const auto middleX = getRectMiddleX(region);
-        const auto middleY = getRectMiddleY(region);
-        return ((rect.pos().x() <= middleX) && (middleX <= rect.pos().x() + rect.width()))
-               || ((rect.pos().y() <= middleY) && (middleY <= rect.pos().y() + rect.height()));
+        m_root = std::make_unique<Node>(TSplit::makeRootRegion(key));
     }
 
-
     /**
      * @internal
-     * @brief           Returns the z-order position for the given rectangle.
+     * @brief   Grow up the tree if the given key cannot contain in the root.
      *
-     * @param region    The region.
-     * @param key       The key.
-     * @return          The z-order position.
+     * @details Creates new root and set old root the child for it.
+     *
+     * @param   key The rectangle.
      */
-    static ZOrderPos getZOrderPos(const TRegion& region, const TKey& key)
+    void growUpIfNeeds(const TKey& key)
     {
-        const auto middleX = getRectMiddleX(region);
-        const auto middleY = getRectMiddleY(region);
-        const auto[x, y] = key.pos();
-        if (x < middleX)
-        {
-            if (y > middleY)
-            {
-                return ZOrderPos::LeftTop;
-            }
-            return ZOrderPos::LeftBottom;
-        }
-        if (y > middleY)
+        TSplit::growUp(m_root, key, [](Node& newRoot, const Node& oldRoot)
         {
-            return ZOrderPos::RightTop;
-        }
-        return ZOrderPos::RightBottom;
+            newRoot.setBounds(oldRoot.bounds());
+            newRoot.setSubtreeSize(oldRoot.subtreeSize());
+        });
     }
 
-
     /**
      * @internal
-     * @brief           Makes this region for the child.
+     * @brief       Grow down the tree if the associated node for key not exists.
+     *              Returns associated node for the key.
      *
-     * @param region    The parent region.
-     * @param zOrderPos The z-order position.
-     * @return          The new region for child.
+     * @details     The bounds of all nodes on the path are extended by the key.
+     *
+     * @tparam TPath    The type of path container.
+     * @param key       The rectangle.
+     * @param path      The container for the nodes from the root to the associated node.
+     * @return          The associated node pointer for the key.
      */
-    static TRegion makeChildRegion(const TRegion& region, ZOrderPos zOrderPos)
+    template <typename TPath>
+    Node* growDownIfNeedsAndReturnLastNode(const TKey& key, TPath& path)
     {
-        const auto middleX = getRectMiddleX(region);
-        const auto middleY = getRectMiddleY(region);
-        const auto size = static_cast<typename TRegion::TCoordinate>(std::round(region.size() / 2.0));
-
-        switch (zOrderPos)
+        return TSplit::growDown(*m_root, key, [&key, &path](Node& node)
         {
-            case ZOrderPos::LeftTop:
-                return TRegion {{region.pos().x(), middleY}, size};
-            case ZOrderPos::LeftBottom:
-                return TRegion {region.pos(), size};
-            case ZOrderPos::RightTop:
-                return TRegion {{middleX, middleY}, size};
-            case ZOrderPos::RightBottom:
-                return TRegion {{middleX, region.pos().y()}, size};
-            default:
-                assert(false && "404");
-        }
+            node.extendBounds(key);
+            path.push_back(std::addressof(node));
+        });
     }
 
+
 private:
 
     /**
@@ -504,5 +1828,13 @@ private:
     size_type m_size;
 };
 
+/**
+ * @brief   The quadtree which stores the node values in the quantized form.
+ *
+ * @tparam  TKey The type of values (space::Rect with integral coordinates).
+ */
+template <typename TKey>
+using CompactQuadTree = QuadTree<TKey, space::QuantizedNodeStorage<TKey>>;
+
 } // namespace space
 
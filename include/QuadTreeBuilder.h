@@ -0,0 +1,606 @@
+/**
+ * @file        QuadTreeBuilder.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the QuadTreeBuilder class.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "Definitions.h"
+#include "QuadTree.h"
+#include "Serialization.h"
+
+namespace space
+{
+
+/**
+ * @brief   The statistics of the external quadtree build.
+ */
+struct QuadTreeBuildStatistics
+{
+    /**
+     * @brief The number of keys passed to the builder.
+     */
+    std::uint64_t keysRead {0};
+
+    /**
+     * @brief The number of sorted runs spilled to the disk.
+     */
+    std::uint64_t runsSpilled {0};
+
+    /**
+     * @brief The number of bytes spilled to the disk.
+     */
+    std::uint64_t bytesSpilled {0};
+
+    /**
+     * @brief The number of unique keys merged to the output.
+     */
+    std::uint64_t keysMerged {0};
+
+    /**
+     * @brief The number of nodes written to the output.
+     */
+    std::uint64_t nodesWritten {0};
+
+    /**
+     * @brief The number of bytes written to the output.
+     */
+    std::uint64_t bytesWritten {0};
+
+    /**
+     * @brief The time elapsed from the builder creation.
+     */
+    std::chrono::nanoseconds elapsed {0};
+
+    /**
+     * @brief   Returns the number of processed (read and merged) keys per second.
+     */
+    [[nodiscard]]
+    double keysPerSecond() const noexcept
+    {
+        if (0 == elapsed.count())
+        {
+            return 0.0;
+        }
+        return static_cast<double>(keysRead + keysMerged) / std::chrono::duration<double>(elapsed).count();
+    }
+};
+
+/**
+ * @brief   The external-memory builder of serialized quadtree for data larger than RAM.
+ *
+ * @details The keys are accumulated in memory until the memory limit, then sorted by
+ *          the quadtree node path in DFS post-order and spilled to the disk as a run.
+ *          The finish merges the runs and emits the tree node by node in the format
+ *          of QuadTree::save, so the result can be opened by MappedQuadTree.
+ *          The memory usage is bounded by the configured limit.
+ *
+ *          The keys must have non-negative coordinates and the top-right corner less than
+ *          the biggest power of two representable by the coordinate type.
+ *
+ * @tparam  TKey The type of values.
+ */
+template <typename TKey>
+class QuadTreeBuilder
+{
+    using TLayout = space::io::QuadTreeLayout<TKey>;
+    using TSplit = impl::QuadTreeSplit<TKey>;
+    using TRegion = typename TSplit::TRegion;
+    using TCoordinate = typename TKey::TCoordinate;
+
+    static_assert(std::is_integral_v<TCoordinate>, "Only integral coordinates are supported.");
+
+    static constexpr auto s_maxRootSize = static_cast<TCoordinate>(
+        std::bit_floor(static_cast<std::make_unsigned_t<TCoordinate>>(std::numeric_limits<TCoordinate>::max())));
+    static constexpr std::size_t s_maxDepth = static_cast<std::size_t>(
+        std::countr_zero(static_cast<std::make_unsigned_t<TCoordinate>>(s_maxRootSize)));
+    static constexpr std::size_t s_levelBits = 3;
+    static constexpr std::size_t s_levelsPerWord = 64 / s_levelBits;
+    static constexpr std::uint64_t s_endOfPath = 4;
+
+    /**
+     * @internal
+     * @brief   The node path: the z-order positions from the biggest possible root,
+     *          the levels after the node are filled by s_endOfPath, so the node is ordered
+     *          after its descendants (DFS post-order).
+     */
+    using TPathCode = space::collections::Array<std::uint64_t, (s_maxDepth + s_levelsPerWord - 1) / s_levelsPerWord>;
+
+    struct Entry
+    {
+        TPathCode path;
+        TKey key;
+
+        auto operator<=>(const Entry&) const noexcept = default;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Entry>);
+
+public:
+
+    /**
+     * @brief   The builder configuration.
+     */
+    struct Config
+    {
+        /**
+         * @brief The memory limit in bytes for keys buffering and merging.
+         */
+        std::size_t memoryLimit {std::size_t {2} << 30};
+
+        /**
+         * @brief The directory for the temporary run files.
+         */
+        std::filesystem::path tempDirectory {std::filesystem::temp_directory_path()};
+
+        /**
+         * @brief The number of processed keys between the progress callback calls.
+         */
+        std::uint64_t progressInterval {1 << 20};
+
+        /**
+         * @brief The progress callback.
+         */
+        std::function<void(const QuadTreeBuildStatistics&)> onProgress {};
+    };
+
+    /**
+     * @brief   Initializes a new instance of builder with the given configuration.
+     *
+     * @param   config The configuration.
+     */
+    explicit QuadTreeBuilder(Config config = {})
+        : m_config(std::move(config))
+        , m_startTime(std::chrono::steady_clock::now())
+    {
+        m_runCapacity = std::max<std::size_t>(1, m_config.memoryLimit / sizeof(Entry));
+    }
+
+    QuadTreeBuilder(const QuadTreeBuilder&) = delete;
+
+    QuadTreeBuilder& operator=(const QuadTreeBuilder&) = delete;
+
+    ~QuadTreeBuilder()
+    {
+        removeRuns();
+    }
+
+    /**
+     * @brief   Adds the key to the building tree.
+     *
+     * @param   key The key.
+     * @throws  std::out_of_range if the key cannot be stored in the quadtree.
+     */
+    void insert(const TKey& key)
+    {
+        const auto[x, y] = space::util::topRightOf(key);
+        if constexpr (std::is_signed_v<TCoordinate>)
+        {
+            if (key.pos().x() < 0 || key.pos().y() < 0 || key.width() < 0 || key.height() < 0)
+            {
+                throw std::out_of_range {"The key is out of the quadtree bounds."};
+            }
+        }
+        if (x >= s_maxRootSize || y >= s_maxRootSize)
+        {
+            throw std::out_of_range {"The key is out of the quadtree bounds."};
+        }
+        m_maxCoordinate = std::max({m_maxCoordinate, x, y});
+
+        if (std::size(m_buffer) == m_buffer.capacity())
+        {
+            m_buffer.reserve(std::min(std::max<std::size_t>(std::size(m_buffer) * 2, 1024), m_runCapacity));
+        }
+        m_buffer.push_back({pathOf(key), key});
+        if (std::size(m_buffer) == m_runCapacity)
+        {
+            spillRun();
+        }
+        ++m_statistics.keysRead;
+        reportProgressIfNeeds();
+    }
+
+    /**
+     * @brief   Adds all keys from the binary stream, the keys are encoded in the same way
+     *          as the values in serialized quadtree.
+     *
+     * @param   is The input stream.
+     * @throws  std::out_of_range if the key cannot be stored in the quadtree.
+     */
+    void insert(std::istream& is)
+    {
+        space::collections::Array<std::byte, TLayout::s_keySize> buffer {};
+        while (is.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(std::size(buffer))))
+        {
+            insert(TLayout::readKey(buffer.data()));
+        }
+    }
+
+    /**
+     * @brief   Merges all added keys and writes the quadtree to the output stream.
+     *
+     * @param   os The output stream (must be opened in binary mode).
+     * @throws  std::runtime_error if reading runs or writing failed.
+     */
+    void finish(std::ostream& os)
+    {
+        // Only one source of memory is used during the merge: either the runs buffers
+        // or the in-memory buffer if nothing was spilled.
+        if (!m_runs.empty())
+        {
+            if (!m_buffer.empty())
+            {
+                spillRun();
+            }
+            m_buffer = {};
+        }
+        std::ranges::sort(m_buffer);
+
+        space::io::QuadTreeWriter<TKey> writer {os};
+        RunMerger merger {*this};
+        EmitState state {writer, rootRegion()};
+
+        Entry previous {};
+        Entry current {};
+        bool hasPrevious = false;
+        while (merger.next(current))
+        {
+            // The duplicates have the same path, so they are adjacent.
+            if (hasPrevious && previous.key == current.key)
+            {
+                continue;
+            }
+            emit(state, current);
+            previous = current;
+            hasPrevious = true;
+
+            ++m_statistics.keysMerged;
+            m_statistics.nodesWritten = writer.nodeCount();
+            m_statistics.bytesWritten = writer.offset();
+            reportProgressIfNeeds();
+        }
+
+        std::uint64_t rootOffset = 0;
+        while (!state.frames.empty())
+        {
+            rootOffset = closeFrame(state);
+        }
+        writer.finish(rootOffset);
+
+        m_statistics.nodesWritten = writer.nodeCount();
+        m_statistics.bytesWritten = writer.offset() + TLayout::s_trailerSize;
+        m_statistics.elapsed = std::chrono::steady_clock::now() - m_startTime;
+        m_buffer.clear();
+        removeRuns();
+    }
+
+    /**
+     * @brief   Merges all added keys and writes the quadtree to the file.
+     *
+     * @param   path The file path.
+     * @throws  std::runtime_error if reading runs or writing failed.
+     */
+    void finish(const std::filesystem::path& path)
+    {
+        std::ofstream os {path, std::ios::binary | std::ios::trunc};
+        if (!os)
+        {
+            throw std::runtime_error {"Failed to open the file " + path.string()};
+        }
+        finish(os);
+    }
+
+    /**
+     * @brief   Gets the build statistics.
+     */
+    [[nodiscard]]
+    QuadTreeBuildStatistics statistics() const noexcept
+    {
+        auto statistics = m_statistics;
+        statistics.elapsed = std::chrono::steady_clock::now() - m_startTime;
+        return statistics;
+    }
+
+private:
+
+    /**
+     * @internal
+     * @brief   The open node during the emitting.
+     */
+    struct Frame
+    {
+        std::size_t level;
+        std::size_t zOrderPos;
+        TRegion region;
+        typename TLayout::TChildOffsets children;
+    };
+
+    struct EmitState
+    {
+        space::io::QuadTreeWriter<TKey>& writer;
+        TRegion rootRegion;
+        space::collections::Vector<Frame> frames {};
+    };
+
+    /**
+     * @internal
+     * @brief   Merges the spilled runs and the in-memory buffer.
+     */
+    class RunMerger
+    {
+    public:
+        explicit RunMerger(QuadTreeBuilder& builder)
+            : m_builder(builder)
+        {
+            const auto numOfRuns = std::size(builder.m_runs) + 1;
+            const auto bufferSize = std::max<std::size_t>(64, builder.m_runCapacity / numOfRuns);
+            m_runs.reserve(numOfRuns);
+            for (const auto& path : builder.m_runs)
+            {
+                auto& run = m_runs.emplace_back();
+                run.stream.open(path, std::ios::binary);
+                if (!run.stream)
+                {
+                    throw std::runtime_error {"Failed to open the run " + path.string()};
+                }
+                run.buffer.resize(bufferSize);
+                refill(run);
+            }
+            m_runs.emplace_back();
+            m_memoryRunIndex = std::size(m_runs) - 1;
+
+            for (std::size_t i = 0; i < std::size(m_runs); ++i)
+            {
+                pushHead(i);
+            }
+        }
+
+        bool next(Entry& entry)
+        {
+            if (m_heads.empty())
+            {
+                return false;
+            }
+            const auto head = m_heads.top();
+            m_heads.pop();
+            entry = head.first;
+            pushHead(head.second);
+            return true;
+        }
+
+    private:
+        struct Run
+        {
+            std::ifstream stream {};
+            space::collections::Vector<Entry> buffer {};
+            std::size_t pos {0};
+            std::size_t size {0};
+        };
+
+        void refill(Run& run)
+        {
+            run.stream.read(reinterpret_cast<char*>(run.buffer.data())
+                , static_cast<std::streamsize>(std::size(run.buffer) * sizeof(Entry)));
+            run.size = static_cast<std::size_t>(run.stream.gcount()) / sizeof(Entry);
+            run.pos = 0;
+        }
+
+        void pushHead(std::size_t runIndex)
+        {
+            if (runIndex == m_memoryRunIndex)
+            {
+                if (m_memoryPos < std::size(m_builder.m_buffer))
+                {
+                    m_heads.emplace(m_builder.m_buffer[m_memoryPos++], runIndex);
+                }
+                return;
+            }
+
+            auto& run = m_runs[runIndex];
+            if (run.pos == run.size)
+            {
+                refill(run);
+                if (0 == run.size)
+                {
+                    return;
+                }
+            }
+            m_heads.emplace(run.buffer[run.pos++], runIndex);
+        }
+
+    private:
+        using THead = std::pair<Entry, std::size_t>;
+
+        QuadTreeBuilder& m_builder;
+        space::collections::Vector<Run> m_runs {};
+        std::size_t m_memoryRunIndex {0};
+        std::size_t m_memoryPos {0};
+        std::priority_queue<THead, space::collections::Vector<THead>, std::greater<>> m_heads {};
+    };
+
+    /**
+     * @internal
+     * @brief   Returns the z-order position of the given level in path (s_endOfPath
+     *          if the path is shorter).
+     */
+    static std::uint64_t digitOf(const TPathCode& path, std::size_t level) noexcept
+    {
+        const auto shift = (s_levelsPerWord - 1 - level % s_levelsPerWord) * s_levelBits;
+        return (path[level / s_levelsPerWord] >> shift) & ((1u << s_levelBits) - 1);
+    }
+
+    static void setDigit(TPathCode& path, std::size_t level, std::uint64_t digit) noexcept
+    {
+        const auto shift = (s_levelsPerWord - 1 - level % s_levelsPerWord) * s_levelBits;
+        auto& word = path[level / s_levelsPerWord];
+        word &= ~(std::uint64_t {(1u << s_levelBits) - 1} << shift);
+        word |= digit << shift;
+    }
+
+    /**
+     * @internal
+     * @brief   Computes the node path for the key from the biggest possible root,
+     *          using the same rules as QuadTree::insert.
+     */
+    static TPathCode pathOf(const TKey& key) noexcept
+    {
+        TPathCode path {};
+        for (std::size_t level = 0; level < s_maxDepth; ++level)
+        {
+            setDigit(path, level, s_endOfPath);
+        }
+
+        TRegion region {{0, 0}, s_maxRootSize};
+        std::size_t level = 0;
+        while (!TSplit::isAssociatedRegion(key, region))
+        {
+            const auto zOrderPos = TSplit::getZOrderPos(region, key);
+            setDigit(path, level++, static_cast<std::uint64_t>(zOrderPos));
+            region = TSplit::makeChildRegion(region, zOrderPos);
+        }
+        return path;
+    }
+
+    /**
+     * @internal
+     * @brief   Returns the smallest root region which contains all added keys.
+     *
+     * @details The keys never touch the split lines of the bigger roots, so their paths
+     *          from the biggest root start with the left-bottom positions down to this region.
+     */
+    TRegion rootRegion() const noexcept
+    {
+        if (0 == m_maxCoordinate)
+        {
+            return TRegion {{0, 0}, 1};
+        }
+        const auto maxCoordinate = static_cast<std::make_unsigned_t<TCoordinate>>(m_maxCoordinate);
+        return TRegion {{0, 0}, static_cast<TCoordinate>(std::bit_floor(maxCoordinate) << 1)};
+    }
+
+    /**
+     * @internal
+     * @brief   Writes the node of the top frame and links it to the parent.
+     *
+     * @return  The offset of the written node.
+     */
+    static std::uint64_t closeFrame(EmitState& state)
+    {
+        const auto frame = state.frames.back();
+        state.frames.pop_back();
+        const auto offset = state.writer.writeNodeFooter(frame.region, frame.children);
+        if (!state.frames.empty())
+        {
+            state.frames.back().children[frame.zOrderPos] = offset;
+        }
+        return offset;
+    }
+
+    /**
+     * @internal
+     * @brief   Writes the entry to the output, closes the finished nodes and opens the
+     *          nodes on the entry path.
+     */
+    static void emit(EmitState& state, const Entry& entry)
+    {
+        const auto rootLevel = s_maxDepth - static_cast<std::size_t>(
+            std::countr_zero(static_cast<std::make_unsigned_t<TCoordinate>>(state.rootRegion.size())));
+        if (state.frames.empty())
+        {
+            state.frames.push_back({rootLevel, 0, state.rootRegion, {}});
+        }
+
+        std::size_t nodeLevel = rootLevel;
+        while (nodeLevel < s_maxDepth && s_endOfPath != digitOf(entry.path, nodeLevel))
+        {
+            ++nodeLevel;
+        }
+
+        std::size_t onPath = 1;
+        while (onPath < std::size(state.frames)
+               && state.frames[onPath].level <= nodeLevel
+               && state.frames[onPath].zOrderPos == digitOf(entry.path, state.frames[onPath].level - 1))
+        {
+            ++onPath;
+        }
+        while (std::size(state.frames) > onPath)
+        {
+            closeFrame(state);
+        }
+
+        for (auto level = state.frames.back().level; level < nodeLevel; ++level)
+        {
+            const auto zOrderPos = digitOf(entry.path, level);
+            const auto region = TSplit::makeChildRegion(state.frames.back().region
+                , static_cast<typename TSplit::ZOrderPos>(zOrderPos));
+            state.frames.push_back({level + 1, static_cast<std::size_t>(zOrderPos), region, {}});
+        }
+        state.writer.writeValue(entry.key);
+    }
+
+    void spillRun()
+    {
+        std::ranges::sort(m_buffer);
+
+        auto path = m_config.tempDirectory / ("space_quadtree_run_" + std::to_string(::getpid()) + "_"
+                                              + std::to_string(reinterpret_cast<std::uintptr_t>(this)) + "_"
+                                              + std::to_string(std::size(m_runs)));
+        std::ofstream os {path, std::ios::binary | std::ios::trunc};
+        m_runs.push_back(path);
+        const auto size = std::size(m_buffer) * sizeof(Entry);
+        os.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(size));
+        if (!os.flush())
+        {
+            throw std::runtime_error {"Failed to write the run " + path.string()};
+        }
+
+        ++m_statistics.runsSpilled;
+        m_statistics.bytesSpilled += size;
+        m_buffer.clear();
+    }
+
+    void removeRuns() noexcept
+    {
+        for (const auto& path : m_runs)
+        {
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+        m_runs.clear();
+    }
+
+    void reportProgressIfNeeds()
+    {
+        const auto processed = m_statistics.keysRead + m_statistics.keysMerged;
+        if (m_config.onProgress && 0 != m_config.progressInterval && 0 == processed % m_config.progressInterval)
+        {
+            m_config.onProgress(statistics());
+        }
+    }
+
+private:
+    Config m_config;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::size_t m_runCapacity {0};
+    space::collections::Vector<Entry> m_buffer {};
+    space::collections::Vector<std::filesystem::path> m_runs {};
+    TCoordinate m_maxCoordinate {0};
+    QuadTreeBuildStatistics m_statistics {};
+};
+
+} // namespace space
@@ -0,0 +1,584 @@
+/**
+ * @file        QuadTreeNodeStorage.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the storages of the quadtree node values.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Definitions.h"
+#include "Point.h"
+#include "Rect.h"
+#include "Square.h"
+#include "Utility.h"
+
+namespace space
+{
+
+/**
+ * @class   FlatNodeStorage
+ * @brief   The default storage of the quadtree node values, the values are stored as is
+ *          in the sorted contiguous container.
+ *
+ * @details Every node storage provides the same interface: insert, erase, contains, size,
+ *          empty, the iteration over the values in the ascending order, forEachIntersecting,
+ *          adopt (takes the sorted unique values), usedBytes and allocatedBytes (the heap
+ *          memory of values).
+ *
+ * @tparam  TKey The type of values.
+ */
+template <typename TKey>
+class FlatNodeStorage
+{
+public:
+    using TValue = TKey;
+    using TRegion = space::Square<typename TKey::TCoordinate>;
+    using TValueContainer = space::collections::FlatSet<TValue>;
+    using sequence_type = typename TValueContainer::sequence_type;
+    using const_iterator = typename TValueContainer::const_iterator;
+
+    FlatNodeStorage() = delete;
+
+    /**
+     * @brief   Creates the empty storage for the node with the given region.
+     */
+    explicit FlatNodeStorage(const TRegion&) noexcept
+    {
+    }
+
+    bool insert(const TValue& value)
+    {
+        return m_values.insert(value).second;
+    }
+
+    bool erase(const TValue& value)
+    {
+        return 0 != m_values.erase(value);
+    }
+
+    [[nodiscard]]
+    bool contains(const TValue& value) const
+    {
+        return m_values.end() != m_values.find(value);
+    }
+
+    /**
+     * @brief       Calls the function for every value which has an intersection with the query.
+     *
+     * @tparam TFunc The type of function, invocable with (const TKey&).
+     * @param query The query rectangle.
+     * @param func  The function.
+     */
+    template <typename TFunc>
+    void forEachIntersecting(const TKey& query, TFunc&& func) const
+    {
+        for (const auto& value : m_values)
+        {
+            if (space::util::hasIntersect(query, value))
+            {
+                func(value);
+            }
+        }
+    }
+
+    /**
+     * @brief           Replaces the values with the given ones.
+     *
+     * @param values    The sorted unique values.
+     */
+    void adopt(sequence_type&& values)
+    {
+        m_values.adopt_sequence(boost::container::ordered_unique_range, std::move(values));
+    }
+
+    [[nodiscard]]
+    const_iterator begin() const noexcept
+    {
+        return m_values.begin();
+    }
+
+    [[nodiscard]]
+    const_iterator end() const noexcept
+    {
+        return m_values.end();
+    }
+
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return m_values.size();
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return m_values.empty();
+    }
+
+    /**
+     * @brief   Gets the number of bytes occupied by the values.
+     */
+    [[nodiscard]]
+    std::size_t usedBytes() const noexcept
+    {
+        return m_values.size() * sizeof(TValue);
+    }
+
+    /**
+     * @brief   Gets the number of bytes allocated for the values (the capacity).
+     */
+    [[nodiscard]]
+    std::size_t allocatedBytes() const noexcept
+    {
+        return m_values.capacity() * sizeof(TValue);
+    }
+
+private:
+    TValueContainer m_values;
+}; // class FlatNodeStorage
+
+/**
+ * @class   QuantizedNodeStorage
+ * @brief   The compact storage of the quadtree node values.
+ *
+ * @details Every value lies within the node region, so it is stored as the offsets of its
+ *          corners from the region origin in 16 bits per coordinate. The regions larger than
+ *          2^16 are quantized: the offsets are scaled down by 2^shift, the lower corner is
+ *          rounded down and the upper one up, so the quantized box always contains the
+ *          value and the quantized intersection test has no false negatives.
+ *
+ *          In the nodes without scaling (all the dense deep levels) the quantized box is the
+ *          value itself and takes 8 bytes instead of sizeof(TKey). The scaled nodes keep the
+ *          full-precision values in the parallel out-of-line array, which is read only for
+ *          the values passed the quantized test, so they take 8 bytes per value more than
+ *          the plain storage (24 bytes for the 32-bit coordinates). The scaled nodes are
+ *          only the shallow ones with the regions larger than 2^16, which keep the few values
+ *          crossing their split lines, so the overhead is small for the usual data.
+ *
+ * @tparam  TKey The type of values (space::Rect with integral coordinates).
+ */
+template <typename TKey>
+class QuantizedNodeStorage
+{
+    using TCrt = typename TKey::TCoordinate;
+    static_assert(std::is_integral_v<TCrt>, "Only integral coordinates can be quantized.");
+    static_assert(std::is_same_v<TKey, space::Rect<TCrt>>, "Only rectangles can be quantized.");
+
+    using TQuantized = std::uint16_t;
+
+    /**
+     * @internal
+     * @brief   The quantized corners relative to the region origin. Without scaling the
+     *          order matches the order of the values.
+     */
+    struct QuantizedKey
+    {
+        TQuantized x1;
+        TQuantized y1;
+        TQuantized x2;
+        TQuantized y2;
+
+        constexpr auto operator<=>(const QuantizedKey&) const noexcept = default;
+    };
+
+public:
+    using TValue = TKey;
+    using TRegion = space::Square<TCrt>;
+    using sequence_type = space::collections::Vector<TValue>;
+
+    /**
+     * @brief   The iterator over the values in the ascending order, yields the values by value.
+     */
+    class const_iterator
+    {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = TValue;
+        using difference_type = std::ptrdiff_t;
+        using reference = TValue;
+        using pointer = void;
+
+        const_iterator() = default;
+
+        [[nodiscard]]
+        reference operator*() const noexcept
+        {
+            return m_storage->valueAt(m_index);
+        }
+
+        const_iterator& operator++() noexcept
+        {
+            ++m_index;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        [[nodiscard]]
+        bool operator==(const const_iterator& other) const noexcept
+        {
+            return m_index == other.m_index;
+        }
+
+    private:
+        friend class QuantizedNodeStorage;
+
+        const_iterator(const QuantizedNodeStorage* storage, std::size_t index) noexcept
+            : m_storage {storage}
+            , m_index {index}
+        {
+        }
+
+    private:
+        const QuantizedNodeStorage* m_storage {nullptr};
+        std::size_t m_index {0};
+    };
+
+public:
+
+    QuantizedNodeStorage() = delete;
+
+    /**
+     * @brief   Creates the empty storage for the node with the given region.
+     */
+    explicit QuantizedNodeStorage(const TRegion& region) noexcept
+        : m_origin {region.pos()}
+        , m_shift {shiftOf(region.size())}
+    {
+    }
+
+    bool insert(const TValue& value)
+    {
+        assert(isInRange(value) && "The value must be within the node region.");
+        if (isExact())
+        {
+            const auto quantized = quantize(value);
+            const auto it = std::ranges::lower_bound(m_quantized, quantized);
+            if (std::end(m_quantized) != it && *it == quantized)
+            {
+                return false;
+            }
+            m_quantized.insert(it, quantized);
+            return true;
+        }
+
+        const auto it = std::ranges::lower_bound(m_exact, value);
+        if (std::end(m_exact) != it && *it == value)
+        {
+            return false;
+        }
+        const auto index = std::distance(std::begin(m_exact), it);
+        m_exact.insert(it, value);
+        m_quantized.insert(std::next(std::begin(m_quantized), index), quantize(value));
+        return true;
+    }
+
+    bool erase(const TValue& value)
+    {
+        const auto index = find(value);
+        if (s_npos == index)
+        {
+            return false;
+        }
+        const auto offset = static_cast<std::ptrdiff_t>(index);
+        m_quantized.erase(std::next(std::begin(m_quantized), offset));
+        if (!isExact())
+        {
+            m_exact.erase(std::next(std::begin(m_exact), offset));
+        }
+        return true;
+    }
+
+    [[nodiscard]]
+    bool contains(const TValue& value) const
+    {
+        return s_npos != find(value);
+    }
+
+    /**
+     * @brief       Calls the function for every value which has an intersection with the query.
+     *
+     * @details     The quantized boxes are tested first. In the scaled nodes the quantized
+     *              test is exact when the quantized box is disjoint with the query bounds
+     *              rounded outwards or lies within the query bounds rounded inwards, only the
+     *              remaining values are refined against the full-precision ones.
+     *
+     * @tparam TFunc The type of function, invocable with (const TKey&).
+     * @param query The query rectangle.
+     * @param func  The function.
+     */
+    template <typename TFunc>
+    void forEachIntersecting(const TKey& query, TFunc&& func) const
+    {
+        const auto[x1, y1] = space::util::bottomLeftOf(query);
+        const auto[x2, y2] = space::util::topRightOf(query);
+        const auto qx1 = lowerOf(offsetOf(x1, m_origin.x()));
+        const auto qy1 = lowerOf(offsetOf(y1, m_origin.y()));
+        const auto qx2 = upperOf(offsetOf(x2, m_origin.x()));
+        const auto qy2 = upperOf(offsetOf(y2, m_origin.y()));
+        // The scaled cells which are entirely covered by the query.
+        const auto innerX1 = upperOf(offsetOf(x1, m_origin.x()));
+        const auto innerY1 = upperOf(offsetOf(y1, m_origin.y()));
+        const auto innerX2 = lowerOf(offsetOf(x2, m_origin.x()));
+        const auto innerY2 = lowerOf(offsetOf(y2, m_origin.y()));
+
+        for (std::size_t i = 0; i < std::size(m_quantized); ++i)
+        {
+            const auto& quantized = m_quantized[i];
+            if (quantized.x2 < qx1 || qx2 < quantized.x1 || quantized.y2 < qy1 || qy2 < quantized.y1)
+            {
+                continue;
+            }
+            if (isExact())
+            {
+                func(decode(quantized));
+            }
+            else if ((innerX1 <= quantized.x1 && quantized.x2 <= innerX2
+                      && innerY1 <= quantized.y1 && quantized.y2 <= innerY2)
+                     || space::util::hasIntersect(query, m_exact[i]))
+            {
+                func(m_exact[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief           Replaces the values with the given ones.
+     *
+     * @param values    The sorted unique values.
+     * @throws          std::out_of_range if any value is not within the node region.
+     */
+    void adopt(sequence_type&& values)
+    {
+        space::collections::Vector<QuantizedKey> quantized;
+        quantized.reserve(std::size(values));
+        for (const auto& value : values)
+        {
+            if (!isInRange(value))
+            {
+                throw std::out_of_range {"The value is out of the node region."};
+            }
+            quantized.push_back(quantize(value));
+        }
+        m_quantized = std::move(quantized);
+        if (isExact())
+        {
+            m_exact.clear();
+        }
+        else
+        {
+            m_exact = std::move(values);
+        }
+    }
+
+    [[nodiscard]]
+    const_iterator begin() const noexcept
+    {
+        return {this, 0};
+    }
+
+    [[nodiscard]]
+    const_iterator end() const noexcept
+    {
+        return {this, size()};
+    }
+
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return std::size(m_quantized);
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept
+    {
+        return m_quantized.empty();
+    }
+
+    /**
+     * @brief   Gets the number of bytes occupied by the quantized and full-precision values.
+     */
+    [[nodiscard]]
+    std::size_t usedBytes() const noexcept
+    {
+        return std::size(m_quantized) * sizeof(QuantizedKey) + std::size(m_exact) * sizeof(TValue);
+    }
+
+    /**
+     * @brief   Gets the number of bytes allocated for the values (the capacity).
+     */
+    [[nodiscard]]
+    std::size_t allocatedBytes() const noexcept
+    {
+        return m_quantized.capacity() * sizeof(QuantizedKey) + m_exact.capacity() * sizeof(TValue);
+    }
+
+private:
+
+    /**
+     * @internal
+     * @brief   The index of absent value.
+     */
+    static constexpr std::size_t s_npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @internal
+     * @brief   Gets the scaling of offsets, so the largest one fits into 16 bits.
+     */
+    [[nodiscard]]
+    static std::uint8_t shiftOf(TCrt regionSize) noexcept
+    {
+        constexpr auto s_bits = std::numeric_limits<TQuantized>::digits;
+        const auto width = std::bit_width(static_cast<std::uint64_t>(regionSize));
+        return static_cast<std::uint8_t>(width > s_bits ? width - s_bits : 0);
+    }
+
+    [[nodiscard]]
+    static std::int64_t offsetOf(TCrt coordinate, TCrt origin) noexcept
+    {
+        return static_cast<std::int64_t>(coordinate) - static_cast<std::int64_t>(origin);
+    }
+
+    [[nodiscard]]
+    bool isExact() const noexcept
+    {
+        return 0 == m_shift;
+    }
+
+    /**
+     * @internal
+     * @brief   Scales the offset rounding down (the right shift of signed value is floor).
+     */
+    [[nodiscard]]
+    std::int64_t lowerOf(std::int64_t offset) const noexcept
+    {
+        return offset >> m_shift;
+    }
+
+    /**
+     * @internal
+     * @brief   Scales the offset rounding up.
+     */
+    [[nodiscard]]
+    std::int64_t upperOf(std::int64_t offset) const noexcept
+    {
+        return (offset + (std::int64_t {1} << m_shift) - 1) >> m_shift;
+    }
+
+    /**
+     * @internal
+     * @brief   Checks the value corners can be stored (the value is within the node region).
+     */
+    [[nodiscard]]
+    bool isInRange(const TValue& value) const noexcept
+    {
+        constexpr auto s_max = std::int64_t {std::numeric_limits<TQuantized>::max()};
+        const auto[x1, y1] = space::util::bottomLeftOf(value);
+        const auto[x2, y2] = space::util::topRightOf(value);
+        return 0 <= offsetOf(x1, m_origin.x()) && 0 <= offsetOf(y1, m_origin.y())
+               && upperOf(offsetOf(x2, m_origin.x())) <= s_max && upperOf(offsetOf(y2, m_origin.y())) <= s_max;
+    }
+
+    [[nodiscard]]
+    QuantizedKey quantize(const TValue& value) const noexcept
+    {
+        const auto[x1, y1] = space::util::bottomLeftOf(value);
+        const auto[x2, y2] = space::util::topRightOf(value);
+        return QuantizedKey {static_cast<TQuantized>(lowerOf(offsetOf(x1, m_origin.x())))
+                             , static_cast<TQuantized>(lowerOf(offsetOf(y1, m_origin.y())))
+                             , static_cast<TQuantized>(upperOf(offsetOf(x2, m_origin.x())))
+                             , static_cast<TQuantized>(upperOf(offsetOf(y2, m_origin.y())))};
+    }
+
+    /**
+     * @internal
+     * @brief   Restores the value from the quantized key of the node without scaling.
+     */
+    [[nodiscard]]
+    TValue decode(const QuantizedKey& quantized) const noexcept
+    {
+        const auto x = m_origin.x();
+        const auto y = m_origin.y();
+        return TValue {space::Point<TCrt> {static_cast<TCrt>(x + quantized.x1), static_cast<TCrt>(y + quantized.y1)}
+                       , space::Point<TCrt> {static_cast<TCrt>(x + quantized.x2), static_cast<TCrt>(y + quantized.y2)}};
+    }
+
+    [[nodiscard]]
+    TValue valueAt(std::size_t index) const noexcept
+    {
+        return isExact() ? decode(m_quantized[index]) : m_exact[index];
+    }
+
+    /**
+     * @internal
+     * @brief   Gets the index of the given value or s_npos if it is absent.
+     */
+    [[nodiscard]]
+    std::size_t find(const TValue& value) const noexcept
+    {
+        if (isExact())
+        {
+            if (!isInRange(value))
+            {
+                return s_npos;
+            }
+            const auto quantized = quantize(value);
+            const auto it = std::ranges::lower_bound(m_quantized, quantized);
+            if (std::end(m_quantized) == it || *it != quantized)
+            {
+                return s_npos;
+            }
+            return static_cast<std::size_t>(std::distance(std::begin(m_quantized), it));
+        }
+
+        const auto it = std::ranges::lower_bound(m_exact, value);
+        if (std::end(m_exact) == it || *it != value)
+        {
+            return s_npos;
+        }
+        return static_cast<std::size_t>(std::distance(std::begin(m_exact), it));
+    }
+
+private:
+
+    /**
+     * @brief   The region origin.
+     */
+    space::Point<TCrt> m_origin;
+
+    /**
+     * @brief   The scaling of offsets (0 if the quantized keys are exact).
+     */
+    std::uint8_t m_shift;
+
+    /**
+     * @brief   The quantized keys in the order of values.
+     */
+    space::collections::Vector<QuantizedKey> m_quantized;
+
+    /**
+     * @brief   The full-precision values (empty if the quantized keys are exact).
+     */
+    space::collections::Vector<TValue> m_exact;
+}; // class QuantizedNodeStorage
+
+} // namespace space
@@ -0,0 +1,350 @@
+/**
+ * @file        QuadTreeTrace.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the binary trace of index operations and the recording wrapper.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+
+#include "Definitions.h"
+#include "Serialization.h"
+
+namespace space::io
+{
+
+/**
+ * @brief   The operations stored in the trace.
+ */
+enum class TraceOperation : std::uint8_t
+{
+    Insert = 1
+    , Remove = 2
+    , Query = 3
+    , Contains = 4
+};
+
+/**
+ * @brief   The traced operation.
+ *
+ * @tparam  TKey The type of keys.
+ */
+template <typename TKey>
+struct TraceRecord
+{
+    TraceOperation operation;
+
+    /**
+     * @brief   The nanoseconds from the trace start.
+     */
+    std::uint64_t timestamp;
+
+    TKey key;
+
+    constexpr bool operator==(const TraceRecord&) const noexcept = default;
+};
+
+/**
+ * @brief   The binary layout of the trace.
+ *
+ * @details The layout is:
+ *              - header (16 bytes): magic "SPACETR\0", version (uint32), coordinate size
+ *                (uint8), coordinate kind (uint8), reserved (uint16);
+ *              - records: operation (uint8), timestamp delta from the previous record in
+ *                nanoseconds (LEB128), key (as in the serialized quadtree).
+ *          All numbers are in little-endian byte order. The trace has no trailer, so it can
+ *          be appended while the service is running and read up to the last complete record.
+ *
+ * @tparam  TKey The type of keys.
+ */
+template <typename TKey>
+struct TraceLayout
+{
+    using TKeyLayout = QuadTreeLayout<TKey>;
+
+    static constexpr space::collections::Array<char, 8> s_magic {'S', 'P', 'A', 'C', 'E', 'T', 'R', '\0'};
+    static constexpr std::uint32_t s_version = 1;
+    static constexpr std::size_t s_headerSize = 16;
+    static constexpr std::size_t s_maxVarIntSize = 10;
+    static constexpr std::size_t s_maxRecordSize = 1 + s_maxVarIntSize + TKeyLayout::s_keySize;
+
+    static void writeHeader(std::byte* dst) noexcept
+    {
+        std::memcpy(dst, s_magic.data(), std::size(s_magic));
+        storeLittleEndian<std::uint32_t>(dst + 8, s_version);
+        storeLittleEndian<std::uint8_t>(dst + 12, static_cast<std::uint8_t>(TKeyLayout::s_coordinateSize));
+        storeLittleEndian<std::uint8_t>(dst + 13, TKeyLayout::coordinateKind());
+        storeLittleEndian<std::uint16_t>(dst + 14, 0);
+    }
+
+    /**
+     * @brief   Checks the header is compatible with the layout.
+     *
+     * @throws  space::io::FormatError if the header is not compatible.
+     */
+    static void validateHeader(const std::byte* src)
+    {
+        if (0 != std::memcmp(src, s_magic.data(), std::size(s_magic)))
+        {
+            throw FormatError {"The data is not a trace."};
+        }
+        if (s_version != loadLittleEndian<std::uint32_t>(src + 8))
+        {
+            throw FormatError {"Unsupported trace format version."};
+        }
+        if (TKeyLayout::s_coordinateSize != loadLittleEndian<std::uint8_t>(src + 12)
+            || TKeyLayout::coordinateKind() != loadLittleEndian<std::uint8_t>(src + 13))
+        {
+            throw FormatError {"The trace coordinate type mismatch."};
+        }
+    }
+
+    /**
+     * @brief   Writes the record, the timestamp is the delta from the previous record.
+     *
+     * @return  The number of written bytes (at most s_maxRecordSize).
+     */
+    static std::size_t writeRecord(std::byte* dst, TraceOperation operation, std::uint64_t timestampDelta, const TKey& key) noexcept
+    {
+        std::size_t size = 0;
+        dst[size++] = static_cast<std::byte>(operation);
+        do
+        {
+            const auto byte = static_cast<std::uint8_t>(timestampDelta & 0x7f);
+            timestampDelta >>= 7;
+            dst[size++] = static_cast<std::byte>(0 == timestampDelta ? byte : byte | 0x80);
+        }
+        while (0 != timestampDelta);
+        TKeyLayout::writeKey(dst + size, key);
+        return size + TKeyLayout::s_keySize;
+    }
+};
+
+/**
+ * @brief   Writes the trace records to the output stream.
+ *
+ * @tparam  TKey The type of keys.
+ */
+template <typename TKey>
+class TraceWriter
+{
+    using TLayout = TraceLayout<TKey>;
+
+public:
+
+    /**
+     * @brief   Writes the header to the stream.
+     *
+     * @param   os The output stream (must be opened in binary mode).
+     * @throws  std::runtime_error if writing failed.
+     */
+    explicit TraceWriter(std::ostream& os)
+        : m_os {os}
+    {
+        space::collections::Array<std::byte, TLayout::s_headerSize> header {};
+        TLayout::writeHeader(header.data());
+        write(header.data(), std::size(header));
+    }
+
+    /**
+     * @brief   Writes the record, the timestamps must not decrease.
+     *
+     * @param   record The record.
+     * @throws  std::runtime_error if writing failed.
+     */
+    void write(const TraceRecord<TKey>& record)
+    {
+        // The concurrently recorded operations can come slightly out of order.
+        const auto delta = record.timestamp > m_lastTimestamp ? record.timestamp - m_lastTimestamp : 0;
+        m_lastTimestamp = std::max(m_lastTimestamp, record.timestamp);
+        space::collections::Array<std::byte, TLayout::s_maxRecordSize> buffer {};
+        write(buffer.data(), TLayout::writeRecord(buffer.data(), record.operation, delta, record.key));
+    }
+
+    void flush()
+    {
+        m_os.flush();
+    }
+
+private:
+
+    void write(const std::byte* data, std::size_t size)
+    {
+        m_os.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!m_os)
+        {
+            throw std::runtime_error {"Failed to write the trace."};
+        }
+    }
+
+private:
+    std::ostream& m_os;
+    std::uint64_t m_lastTimestamp {0};
+};
+
+/**
+ * @brief   Reads the trace records.
+ *
+ * @tparam  TKey The type of keys.
+ * @tparam  TFunc The type of function, invocable with (const TraceRecord<TKey>&).
+ * @param   data The trace.
+ * @param   func The function called for every record.
+ * @param   allowTruncated Whether to ignore the incomplete last record (the trace is
+ *          still being written).
+ * @return  The number of records.
+ * @throws  space::io::FormatError if the data is malformed.
+ */
+template <typename TKey, typename TFunc>
+std::size_t forEachTraceRecord(space::collections::Span<const std::byte> data, TFunc&& func, bool allowTruncated = false)
+{
+    using TLayout = TraceLayout<TKey>;
+    using TKeyLayout = typename TLayout::TKeyLayout;
+
+    if (std::size(data) < TLayout::s_headerSize)
+    {
+        throw FormatError {"The trace is truncated."};
+    }
+    TLayout::validateHeader(data.data());
+
+    std::size_t count = 0;
+    std::size_t pos = TLayout::s_headerSize;
+    std::uint64_t timestamp = 0;
+    while (pos < std::size(data))
+    {
+        const auto operation = static_cast<TraceOperation>(data[pos++]);
+        if (operation < TraceOperation::Insert || operation > TraceOperation::Contains)
+        {
+            throw FormatError {"Unknown trace operation."};
+        }
+
+        std::uint64_t delta = 0;
+        bool complete = false;
+        for (unsigned shift = 0; pos < std::size(data) && !complete; shift += 7)
+        {
+            if (shift >= 64)
+            {
+                throw FormatError {"The trace timestamp is malformed."};
+            }
+            const auto byte = static_cast<std::uint8_t>(data[pos++]);
+            delta |= std::uint64_t {byte & 0x7fu} << shift;
+            complete = 0 == (byte & 0x80);
+        }
+        if (!complete || std::size(data) - pos < TKeyLayout::s_keySize)
+        {
+            if (allowTruncated)
+            {
+                break;
+            }
+            throw FormatError {"The trace is truncated."};
+        }
+        timestamp += delta;
+        func(TraceRecord<TKey> {operation, timestamp, TKeyLayout::readKey(data.data() + pos)});
+        pos += TKeyLayout::s_keySize;
+        ++count;
+    }
+    return count;
+}
+
+} // namespace space::io
+
+namespace space
+{
+
+/**
+ * @brief   The wrapper of the index which records every operation to the trace.
+ *
+ * @details The timestamps are measured from the recorder construction. The wrapper is
+ *          thread-safe as long as the wrapped operations are (the concurrent queries), the
+ *          trace writes are serialized.
+ *
+ * @tparam  TIndex The type of index (space::QuadTree).
+ */
+template <typename TIndex, typename TKey = typename TIndex::key_type>
+class IndexRecorder
+{
+public:
+
+    /**
+     * @brief   Starts the trace.
+     *
+     * @param   index The recorded index, must outlive the recorder.
+     * @param   os The output stream for the trace.
+     */
+    IndexRecorder(TIndex& index, std::ostream& os)
+        : m_index {index}
+        , m_writer {os}
+        , m_start {std::chrono::steady_clock::now()}
+    {
+    }
+
+    bool insert(const TKey& key)
+    {
+        record(space::io::TraceOperation::Insert, key);
+        return m_index.insert(key);
+    }
+
+    void remove(const TKey& key)
+    {
+        record(space::io::TraceOperation::Remove, key);
+        m_index.remove(key);
+    }
+
+    template <typename TOutIt>
+    void query(const TKey& key, TOutIt outIt) const
+    {
+        record(space::io::TraceOperation::Query, key);
+        m_index.query(key, outIt);
+    }
+
+    [[nodiscard]]
+    bool contains(const TKey& key) const
+    {
+        record(space::io::TraceOperation::Contains, key);
+        return m_index.contains(key);
+    }
+
+    /**
+     * @brief   Gets the recorded index.
+     */
+    [[nodiscard]]
+    TIndex& index() noexcept
+    {
+        return m_index;
+    }
+
+    void flush()
+    {
+        std::lock_guard lock {m_mutex};
+        m_writer.flush();
+    }
+
+private:
+
+    void record(space::io::TraceOperation operation, const TKey& key) const
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - m_start;
+        const auto timestamp = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        std::lock_guard lock {m_mutex};
+        m_writer.write({operation, timestamp, key});
+    }
+
+private:
+    TIndex& m_index;
+    mutable space::io::TraceWriter<TKey> m_writer;
+    mutable std::mutex m_mutex;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace space
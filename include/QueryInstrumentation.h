@@ -0,0 +1,286 @@
+/**
+ * @file        QueryInstrumentation.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the instrumentation policies of the index queries.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+namespace space
+{
+
+/**
+ * @brief   The counters of the work done by the queries.
+ */
+struct QueryCounters
+{
+    /**
+     * @brief   The number of queries (query and contains calls).
+     */
+    std::uint64_t queries {0};
+
+    std::uint64_t nodesVisited {0};
+
+    /**
+     * @brief   The number of visited nodes which region has no intersection with the query.
+     */
+    std::uint64_t nodesPruned {0};
+
+    std::uint64_t valuesTested {0};
+
+    std::uint64_t valuesMatched {0};
+
+    /**
+     * @brief   The maximum size of the traversal stack.
+     */
+    std::uint64_t stackHighWaterMark {0};
+
+    QueryCounters& operator+=(const QueryCounters& other) noexcept
+    {
+        queries += other.queries;
+        nodesVisited += other.nodesVisited;
+        nodesPruned += other.nodesPruned;
+        valuesTested += other.valuesTested;
+        valuesMatched += other.valuesMatched;
+        stackHighWaterMark = std::max(stackHighWaterMark, other.stackHighWaterMark);
+        return *this;
+    }
+
+    constexpr bool operator==(const QueryCounters&) const noexcept = default;
+};
+
+/**
+ * @brief   The ostream operator for working with streams, writes the counters as the JSON object.
+ *
+ * @tparam  TOstream The type of ostream.
+ * @param   os The ostream.
+ * @param   counters The counters.
+ * @return  The reference to ostream.
+ */
+template <typename TOstream>
+TOstream& operator<<(TOstream& os, const QueryCounters& counters)
+{
+    os << "{\"queries\": " << counters.queries
+       << ", \"nodesVisited\": " << counters.nodesVisited
+       << ", \"nodesPruned\": " << counters.nodesPruned
+       << ", \"valuesTested\": " << counters.valuesTested
+       << ", \"valuesMatched\": " << counters.valuesMatched
+       << ", \"stackHighWaterMark\": " << counters.stackHighWaterMark << "}";
+    return os;
+}
+
+/**
+ * @brief   The default instrumentation policy, does nothing.
+ *
+ * @details The instrumentation policy is the static interface called by the index:
+ *          queryStarted, nodeVisited, nodePruned, valuesTested(count), valueMatched
+ *          and stackSize(size).
+ */
+struct NoQueryInstrumentation
+{
+    static constexpr bool s_enabled = false;
+
+    static void queryStarted() noexcept {}
+    static void nodeVisited() noexcept {}
+    static void nodePruned() noexcept {}
+    static void valuesTested(std::size_t) noexcept {}
+    static void valueMatched() noexcept {}
+    static void stackSize(std::size_t) noexcept {}
+};
+
+/**
+ * @brief   The instrumentation policy counting the work in the thread-local counters.
+ *
+ * @details Every thread updates only own counters without synchronization (relaxed atomic
+ *          stores, so the aggregation from other threads is not a data race). The counters
+ *          of the finished threads are kept in the retired total.
+ */
+class CountingQueryInstrumentation
+{
+    /**
+     * @internal
+     * @brief   The counters of one thread, registered in the global list while the thread lives.
+     */
+    struct ThreadCounters
+    {
+        std::atomic<std::uint64_t> queries {0};
+        std::atomic<std::uint64_t> nodesVisited {0};
+        std::atomic<std::uint64_t> nodesPruned {0};
+        std::atomic<std::uint64_t> valuesTested {0};
+        std::atomic<std::uint64_t> valuesMatched {0};
+        std::atomic<std::uint64_t> stackHighWaterMark {0};
+
+        [[nodiscard]]
+        QueryCounters load() const noexcept
+        {
+            return QueryCounters {queries.load(std::memory_order_relaxed)
+                                  , nodesVisited.load(std::memory_order_relaxed)
+                                  , nodesPruned.load(std::memory_order_relaxed)
+                                  , valuesTested.load(std::memory_order_relaxed)
+                                  , valuesMatched.load(std::memory_order_relaxed)
+                                  , stackHighWaterMark.load(std::memory_order_relaxed)};
+        }
+
+        void reset() noexcept
+        {
+            for (auto* counter : {&queries, &nodesVisited, &nodesPruned, &valuesTested, &valuesMatched
+                                  , &stackHighWaterMark})
+            {
+                counter->store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /**
+     * @internal
+     * @brief   The registry of all threads counters.
+     */
+    struct Registry
+    {
+        std::mutex mutex;
+        std::list<ThreadCounters> threads;
+        QueryCounters retired;
+    };
+
+    /**
+     * @internal
+     * @brief   Registers the thread counters on the first use and retires them on the thread exit.
+     */
+    class ThreadRegistration
+    {
+    public:
+        ThreadRegistration()
+        {
+            auto& registry = registryInstance();
+            std::lock_guard lock {registry.mutex};
+            m_pos = registry.threads.emplace(std::end(registry.threads));
+        }
+
+        ~ThreadRegistration()
+        {
+            auto& registry = registryInstance();
+            std::lock_guard lock {registry.mutex};
+            registry.retired += m_pos->load();
+            registry.threads.erase(m_pos);
+        }
+
+        ThreadRegistration(const ThreadRegistration&) = delete;
+        ThreadRegistration& operator=(const ThreadRegistration&) = delete;
+
+        [[nodiscard]]
+        ThreadCounters& counters() noexcept
+        {
+            return *m_pos;
+        }
+
+    private:
+        std::list<ThreadCounters>::iterator m_pos;
+    };
+
+public:
+    static constexpr bool s_enabled = true;
+
+    static void queryStarted() noexcept
+    {
+        increment(local().queries, 1);
+    }
+
+    static void nodeVisited() noexcept
+    {
+        increment(local().nodesVisited, 1);
+    }
+
+    static void nodePruned() noexcept
+    {
+        increment(local().nodesPruned, 1);
+    }
+
+    static void valuesTested(std::size_t count) noexcept
+    {
+        increment(local().valuesTested, count);
+    }
+
+    static void valueMatched() noexcept
+    {
+        increment(local().valuesMatched, 1);
+    }
+
+    static void stackSize(std::size_t size) noexcept
+    {
+        auto& highWaterMark = local().stackHighWaterMark;
+        if (size > highWaterMark.load(std::memory_order_relaxed))
+        {
+            highWaterMark.store(size, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief   Gets the counters of the calling thread.
+     */
+    [[nodiscard]]
+    static QueryCounters threadCounters() noexcept
+    {
+        return local().load();
+    }
+
+    /**
+     * @brief   Gets the counters aggregated over all threads, including the finished ones.
+     */
+    [[nodiscard]]
+    static QueryCounters totalCounters()
+    {
+        auto& registry = registryInstance();
+        std::lock_guard lock {registry.mutex};
+        auto total = registry.retired;
+        for (const auto& threadCounters : registry.threads)
+        {
+            total += threadCounters.load();
+        }
+        return total;
+    }
+
+    /**
+     * @brief   Resets the counters of all threads. The concurrent queries can be partially counted.
+     */
+    static void reset()
+    {
+        auto& registry = registryInstance();
+        std::lock_guard lock {registry.mutex};
+        registry.retired = {};
+        for (auto& threadCounters : registry.threads)
+        {
+            threadCounters.reset();
+        }
+    }
+
+private:
+
+    static void increment(std::atomic<std::uint64_t>& counter, std::size_t count) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    static Registry& registryInstance()
+    {
+        // Never destroyed, so the threads finished after the static destruction can retire.
+        static auto* s_registry = new Registry {};
+        return *s_registry;
+    }
+
+    static ThreadCounters& local()
+    {
+        thread_local ThreadRegistration s_registration;
+        return s_registration.counters();
+    }
+};
+
+} // namespace space
@@ -0,0 +1,292 @@
+/**
+ * @file        RectJoin.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the plane-sweep rectangle intersection join.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <numeric>
+#include <thread>
+
+#include "Definitions.h"
+#include "Rect.h"
+
+namespace space::util
+{
+
+namespace impl
+{
+
+/**
+ * @internal
+ * @brief   The rectangles prepared for the plane sweep: the structure of arrays
+ *          sorted by the lower x-axis coordinate.
+ *
+ * @tparam  TCrt The type of coordinates.
+ */
+template <typename TCrt>
+struct SweepList
+{
+    space::collections::Vector<TCrt> xMin;
+    space::collections::Vector<TCrt> xMax;
+    space::collections::Vector<TCrt> yMin;
+    space::collections::Vector<TCrt> yMax;
+    space::collections::Vector<std::size_t> index;
+
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return std::size(index);
+    }
+};
+
+/**
+ * @internal
+ * @brief           Makes the sweep list from the given rectangles.
+ *
+ * @tparam TCrt     The type of coordinates.
+ * @param rects     The rectangles.
+ * @param indices   The indices of rectangles which must be added to the list.
+ * @return          The sweep list sorted by the lower x-axis coordinate.
+ */
+template <typename TCrt>
+SweepList<TCrt> makeSweepList(space::collections::Span<const space::Rect<TCrt>> rects
+    , space::collections::Vector<std::size_t> indices)
+{
+    std::ranges::sort(indices, [&rects](std::size_t lhs, std::size_t rhs)
+    {
+        return rects[lhs].pos().x() < rects[rhs].pos().x();
+    });
+
+    SweepList<TCrt> list;
+    list.xMin.reserve(std::size(indices));
+    list.xMax.reserve(std::size(indices));
+    list.yMin.reserve(std::size(indices));
+    list.yMax.reserve(std::size(indices));
+    for (const auto index : indices)
+    {
+        const auto[x1, y1] = bottomLeftOf(rects[index]);
+        const auto[x2, y2] = topRightOf(rects[index]);
+        list.xMin.push_back(x1);
+        list.xMax.push_back(x2);
+        list.yMin.push_back(y1);
+        list.yMax.push_back(y2);
+    }
+    list.index = std::move(indices);
+    return list;
+}
+
+/**
+ * @internal
+ * @brief           Reports the rectangles from the other list which have an intersection
+ *                  with the current rectangle, starting from the given position.
+ *
+ * @details         The candidates are the rectangles starting before the end of the current
+ *                  one on the x-axis. The y-axis overlap is checked in blocks without branches,
+ *                  so the compiler can vectorize the inner loop.
+ *
+ * @param current   The list of the current rectangle.
+ * @param pos       The position of the current rectangle.
+ * @param other     The other list.
+ * @param from      The first candidate position in the other list.
+ * @param report    The report function, called with the positions (pos, otherPos).
+ */
+template <typename TCrt, typename TReport>
+void forwardScan(const SweepList<TCrt>& current, std::size_t pos
+    , const SweepList<TCrt>& other, std::size_t from, TReport& report)
+{
+    constexpr std::size_t blockSize = 64;
+
+    const auto xMax = current.xMax[pos];
+    const auto yMin = current.yMin[pos];
+    const auto yMax = current.yMax[pos];
+
+    auto to = from;
+    while (to < other.size() && other.xMin[to] <= xMax)
+    {
+        ++to;
+    }
+
+    const auto* otherYMin = other.yMin.data();
+    const auto* otherYMax = other.yMax.data();
+    space::collections::Array<std::uint8_t, blockSize> hits {};
+    for (auto blockBegin = from; blockBegin < to; blockBegin += blockSize)
+    {
+        const auto count = std::min(blockSize, to - blockBegin);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            hits[i] = static_cast<std::uint8_t>((otherYMin[blockBegin + i] <= yMax)
+                                                & (yMin <= otherYMax[blockBegin + i]));
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (0 != hits[i])
+            {
+                report(pos, blockBegin + i);
+            }
+        }
+    }
+}
+
+/**
+ * @internal
+ * @brief           The forward-scan plane sweep over two sorted lists.
+ *
+ * @param first     The first list.
+ * @param second    The second list.
+ * @param report    The report function, called with the positions (firstPos, secondPos).
+ */
+template <typename TCrt, typename TReport>
+void planeSweep(const SweepList<TCrt>& first, const SweepList<TCrt>& second, TReport report)
+{
+    auto reportReversed = [&report](std::size_t secondPos, std::size_t firstPos)
+    {
+        report(firstPos, secondPos);
+    };
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < first.size() && j < second.size())
+    {
+        if (first.xMin[i] <= second.xMin[j])
+        {
+            forwardScan(first, i, second, j, report);
+            ++i;
+        }
+        else
+        {
+            forwardScan(second, j, first, i, reportReversed);
+            ++j;
+        }
+    }
+}
+
+} // namespace impl
+
+/**
+ * @brief           Finds all pairs of intersecting rectangles from two unsorted batches
+ *                  without building an index.
+ *
+ * @details         Implements the forward-scan plane sweep over the inputs sorted by the
+ *                  lower x-axis coordinate. The algorithm complexity is O(n log n + k),
+ *                  where k is the number of x-axis overlapping candidates.
+ *
+ * @tparam TCrt     The type of coordinates.
+ * @tparam TSink    The type of sink, invocable with (const Rect&, const Rect&).
+ * @param first     The first batch.
+ * @param second    The second batch.
+ * @param sink      The sink, called with the rectangles from the first and second batches.
+ */
+template <typename TCrt, typename TSink>
+void rectJoin(space::collections::Span<const space::Rect<TCrt>> first
+    , space::collections::Span<const space::Rect<TCrt>> second, TSink sink)
+{
+    auto allIndices = [](std::size_t size)
+    {
+        space::collections::Vector<std::size_t> indices(size);
+        std::iota(std::begin(indices), std::end(indices), std::size_t {0});
+        return indices;
+    };
+
+    const auto firstList = impl::makeSweepList(first, allIndices(std::size(first)));
+    const auto secondList = impl::makeSweepList(second, allIndices(std::size(second)));
+    impl::planeSweep(firstList, secondList, [&](std::size_t firstPos, std::size_t secondPos)
+    {
+        sink(first[firstList.index[firstPos]], second[secondList.index[secondPos]]);
+    });
+}
+
+/**
+ * @brief           Finds all pairs of intersecting rectangles from two unsorted batches
+ *                  using the given execution policy.
+ *
+ * @details         The plane is split into vertical stripes with the roughly equal number
+ *                  of rectangles, every rectangle is assigned to all stripes it overlaps and the
+ *                  stripes are joined independently. The pair crossing a stripe boundary is
+ *                  reported only by the stripe containing its reference point (the lower
+ *                  x-axis coordinate of the intersection), so each pair is reported once.
+ *                  The sink must be thread-safe for the parallel policies.
+ *
+ * @tparam TExecutionPolicy The type of execution policy.
+ * @tparam TCrt     The type of coordinates.
+ * @tparam TSink    The type of sink, invocable with (const Rect&, const Rect&).
+ * @param policy    The execution policy.
+ * @param first     The first batch.
+ * @param second    The second batch.
+ * @param sink      The sink, called with the rectangles from the first and second batches.
+ */
+template <typename TExecutionPolicy, typename TCrt, typename TSink>
+    requires std::is_execution_policy_v<std::remove_cvref_t<TExecutionPolicy>>
+void rectJoin(TExecutionPolicy&& policy, space::collections::Span<const space::Rect<TCrt>> first
+    , space::collections::Span<const space::Rect<TCrt>> second, TSink sink)
+{
+    const auto stripeCount = std::max(1u, std::thread::hardware_concurrency()) * 4;
+
+    space::collections::Vector<TCrt> xMinList;
+    xMinList.reserve(std::size(first) + std::size(second));
+    std::ranges::transform(first, std::back_inserter(xMinList), [](const auto& rect) { return rect.pos().x(); });
+    std::ranges::transform(second, std::back_inserter(xMinList), [](const auto& rect) { return rect.pos().x(); });
+    if (xMinList.empty())
+    {
+        return;
+    }
+    std::ranges::sort(xMinList);
+
+    // The stripe i is [bounds[i - 1], bounds[i]), the first and last stripes are unbounded.
+    space::collections::Vector<TCrt> bounds;
+    for (std::size_t i = 1; i < stripeCount; ++i)
+    {
+        const auto bound = xMinList[i * std::size(xMinList) / stripeCount];
+        if (bounds.empty() || bounds.back() < bound)
+        {
+            bounds.push_back(bound);
+        }
+    }
+
+    const auto numOfStripes = std::size(bounds) + 1;
+    auto stripeOf = [&bounds](TCrt x)
+    {
+        return static_cast<std::size_t>(std::ranges::upper_bound(bounds, x) - std::begin(bounds));
+    };
+    auto distribute = [&](space::collections::Span<const space::Rect<TCrt>> rects)
+    {
+        space::collections::Vector<space::collections::Vector<std::size_t>> stripes(numOfStripes);
+        for (std::size_t i = 0; i < std::size(rects); ++i)
+        {
+            const auto lastStripe = stripeOf(topRightOf(rects[i]).x());
+            for (auto stripe = stripeOf(rects[i].pos().x()); stripe <= lastStripe; ++stripe)
+            {
+                stripes[stripe].push_back(i);
+            }
+        }
+        return stripes;
+    };
+
+    auto firstStripes = distribute(first);
+    auto secondStripes = distribute(second);
+
+    space::collections::Vector<std::size_t> stripeIds(numOfStripes);
+    std::iota(std::begin(stripeIds), std::end(stripeIds), std::size_t {0});
+    std::for_each(std::forward<TExecutionPolicy>(policy), std::begin(stripeIds), std::end(stripeIds)
+        , [&](std::size_t stripe)
+        {
+            const auto firstList = impl::makeSweepList(first, std::move(firstStripes[stripe]));
+            const auto secondList = impl::makeSweepList(second, std::move(secondStripes[stripe]));
+            impl::planeSweep(firstList, secondList, [&](std::size_t firstPos, std::size_t secondPos)
+            {
+                const auto referenceX = std::max(firstList.xMin[firstPos], secondList.xMin[secondPos]);
+                if (stripeOf(referenceX) == stripe)
+                {
+                    sink(first[firstList.index[firstPos]], second[secondList.index[secondPos]]);
+                }
+            });
+        });
+}
+
+} // namespace space::util
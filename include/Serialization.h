@@ -0,0 +1,549 @@
+/**
+ * @file        Serialization.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the binary format of serialized spatial indexes.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Definitions.h"
+#include "Point.h"
+#include "Square.h"
+
+namespace space::io
+{
+
+/**
+ * @brief   The error thrown when the serialized data is malformed.
+ */
+class FormatError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief   Stores the value to the given memory in little-endian byte order.
+ *
+ * @tparam  T The type of value (arithmetic).
+ * @param   dst The destination memory, at least sizeof(T) bytes.
+ * @param   value The value.
+ */
+template <typename T>
+void storeLittleEndian(std::byte* dst, T value) noexcept
+{
+    static_assert(std::is_arithmetic_v<T>, "Only arithmetic types are supported.");
+    std::memcpy(dst, std::addressof(value), sizeof(T));
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        std::reverse(dst, dst + sizeof(T));
+    }
+}
+
+/**
+ * @brief   Loads the value stored in little-endian byte order from the given memory.
+ *
+ * @tparam  T The type of value (arithmetic).
+ * @param   src The source memory, at least sizeof(T) bytes, any alignment.
+ * @return  The loaded value.
+ */
+template <typename T>
+[[nodiscard]]
+T loadLittleEndian(const std::byte* src) noexcept
+{
+    static_assert(std::is_arithmetic_v<T>, "Only arithmetic types are supported.");
+    space::collections::Array<std::byte, sizeof(T)> bytes;
+    std::memcpy(bytes.data(), src, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        std::ranges::reverse(bytes);
+    }
+    T value;
+    std::memcpy(std::addressof(value), bytes.data(), sizeof(T));
+    return value;
+}
+
+/**
+ * @brief   The 64-bit FNV-1a checksum.
+ */
+class Checksum
+{
+public:
+
+    /**
+     * @brief   Adds the given bytes to the checksum.
+     *
+     * @param   data The bytes.
+     * @param   size The number of bytes.
+     */
+    void update(const std::byte* data, std::size_t size) noexcept
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            m_value ^= std::to_integer<std::uint64_t>(data[i]);
+            m_value *= s_prime;
+        }
+    }
+
+    /**
+     * @brief   Gets the checksum of all added bytes.
+     *
+     * @return  The checksum.
+     */
+    [[nodiscard]]
+    std::uint64_t value() const noexcept
+    {
+        return m_value;
+    }
+
+private:
+    static constexpr std::uint64_t s_offsetBasis = 14695981039346656037ull;
+    static constexpr std::uint64_t s_prime = 1099511628211ull;
+
+    std::uint64_t m_value {s_offsetBasis};
+};
+
+/**
+ * @brief   Describes the binary layout of the serialized quadtree.
+ *
+ * @details All numbers are stored in little-endian byte order, coordinates are stored with
+ *          their native size. The file consists of the header, the nodes in DFS post-order
+ *          and the trailer:
+ *
+ *          Header:  magic (8 bytes), version (u32), coordinate size (u8),
+ *                   coordinate kind (u8), reserved (u16).
+ *          Node:    values (value count * key size), then the node footer:
+ *                   region x, y, size (coordinates), children offsets (4 * u64, 0 if the
+ *                   child not exists), value count (u64).
+ *          Trailer: node count (u64), value count (u64), root offset (u64, 0 if the tree
+ *                   is empty), checksum (u64) of all previous bytes.
+ *
+ *          The node is addressed by the file offset of its footer, the node values are placed
+ *          right before the footer. The children are always placed before their parent,
+ *          so the whole file can be written in one pass.
+ *
+ * @tparam  TKey The type of keys (space::Rect).
+ */
+template <typename TKey>
+struct QuadTreeLayout
+{
+    using TCoordinate = typename TKey::TCoordinate;
+    using TRegion = space::Square<TCoordinate>;
+    using TChildOffsets = space::collections::Array<std::uint64_t, 4>;
+
+    static constexpr space::collections::Array<char, 8> s_magic {'S', 'P', 'A', 'C', 'E', 'Q', 'T', '\0'};
+    static constexpr std::uint32_t s_version = 1;
+
+    static constexpr std::size_t s_coordinateSize = sizeof(TCoordinate);
+    static constexpr std::size_t s_headerSize = 16;
+    static constexpr std::size_t s_keySize = 4 * s_coordinateSize;
+    static constexpr std::size_t s_nodeFooterSize = 3 * s_coordinateSize + 5 * sizeof(std::uint64_t);
+    static constexpr std::size_t s_trailerSize = 4 * sizeof(std::uint64_t);
+
+    /**
+     * @brief   The decoded node footer.
+     */
+    struct NodeFooter
+    {
+        TRegion region;
+        TChildOffsets children;
+        std::uint64_t valueCount;
+    };
+
+    /**
+     * @brief   The decoded file trailer.
+     */
+    struct Trailer
+    {
+        std::uint64_t nodeCount;
+        std::uint64_t valueCount;
+        std::uint64_t rootOffset;
+        std::uint64_t checksum;
+    };
+
+    /**
+     * @brief   Returns the code of the coordinate kind.
+     */
+    static constexpr std::uint8_t coordinateKind() noexcept
+    {
+        if constexpr (std::is_floating_point_v<TCoordinate>)
+        {
+            return 2;
+        }
+        else if constexpr (std::is_signed_v<TCoordinate>)
+        {
+            return 1;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    static void writeHeader(std::byte* dst) noexcept
+    {
+        std::memcpy(dst, s_magic.data(), std::size(s_magic));
+        storeLittleEndian<std::uint32_t>(dst + 8, s_version);
+        storeLittleEndian<std::uint8_t>(dst + 12, static_cast<std::uint8_t>(s_coordinateSize));
+        storeLittleEndian<std::uint8_t>(dst + 13, coordinateKind());
+        storeLittleEndian<std::uint16_t>(dst + 14, 0);
+    }
+
+    /**
+     * @brief   Checks the header is compatible with the layout.
+     *
+     * @throws  space::io::FormatError if the header is not compatible.
+     */
+    static void validateHeader(const std::byte* src)
+    {
+        if (0 != std::memcmp(src, s_magic.data(), std::size(s_magic)))
+        {
+            throw FormatError {"The data is not a serialized quadtree."};
+        }
+        if (s_version != loadLittleEndian<std::uint32_t>(src + 8))
+        {
+            throw FormatError {"Unsupported quadtree format version."};
+        }
+        if (s_coordinateSize != loadLittleEndian<std::uint8_t>(src + 12)
+            || coordinateKind() != loadLittleEndian<std::uint8_t>(src + 13))
+        {
+            throw FormatError {"The quadtree coordinate type mismatch."};
+        }
+    }
+
+    static void writeKey(std::byte* dst, const TKey& key) noexcept
+    {
+        storeLittleEndian<TCoordinate>(dst, key.pos().x());
+        storeLittleEndian<TCoordinate>(dst + s_coordinateSize, key.pos().y());
+        storeLittleEndian<TCoordinate>(dst + 2 * s_coordinateSize, key.width());
+        storeLittleEndian<TCoordinate>(dst + 3 * s_coordinateSize, key.height());
+    }
+
+    [[nodiscard]]
+    static TKey readKey(const std::byte* src) noexcept
+    {
+        return TKey {{loadLittleEndian<TCoordinate>(src), loadLittleEndian<TCoordinate>(src + s_coordinateSize)}
+                     , loadLittleEndian<TCoordinate>(src + 2 * s_coordinateSize)
+                     , loadLittleEndian<TCoordinate>(src + 3 * s_coordinateSize)};
+    }
+
+    static void writeNodeFooter(std::byte* dst, const NodeFooter& footer) noexcept
+    {
+        storeLittleEndian<TCoordinate>(dst, footer.region.pos().x());
+        storeLittleEndian<TCoordinate>(dst + s_coordinateSize, footer.region.pos().y());
+        storeLittleEndian<TCoordinate>(dst + 2 * s_coordinateSize, footer.region.size());
+        auto* offsets = dst + 3 * s_coordinateSize;
+        for (const auto child : footer.children)
+        {
+            storeLittleEndian<std::uint64_t>(offsets, child);
+            offsets += sizeof(std::uint64_t);
+        }
+        storeLittleEndian<std::uint64_t>(offsets, footer.valueCount);
+    }
+
+    [[nodiscard]]
+    static NodeFooter readNodeFooter(const std::byte* src) noexcept
+    {
+        NodeFooter footer {};
+        footer.region = TRegion {{loadLittleEndian<TCoordinate>(src), loadLittleEndian<TCoordinate>(src + s_coordinateSize)}
+                                 , loadLittleEndian<TCoordinate>(src + 2 * s_coordinateSize)};
+        const auto* offsets = src + 3 * s_coordinateSize;
+        for (auto& child : footer.children)
+        {
+            child = loadLittleEndian<std::uint64_t>(offsets);
+            offsets += sizeof(std::uint64_t);
+        }
+        footer.valueCount = loadLittleEndian<std::uint64_t>(offsets);
+        return footer;
+    }
+
+    static void writeTrailer(std::byte* dst, const Trailer& trailer) noexcept
+    {
+        storeLittleEndian<std::uint64_t>(dst, trailer.nodeCount);
+        storeLittleEndian<std::uint64_t>(dst + 8, trailer.valueCount);
+        storeLittleEndian<std::uint64_t>(dst + 16, trailer.rootOffset);
+        storeLittleEndian<std::uint64_t>(dst + 24, trailer.checksum);
+    }
+
+    [[nodiscard]]
+    static Trailer readTrailer(const std::byte* src) noexcept
+    {
+        return Trailer {loadLittleEndian<std::uint64_t>(src)
+                        , loadLittleEndian<std::uint64_t>(src + 8)
+                        , loadLittleEndian<std::uint64_t>(src + 16)
+                        , loadLittleEndian<std::uint64_t>(src + 24)};
+    }
+
+    /**
+     * @brief   Checks the node footer offset points inside the nodes section and the node
+     *          values are placed inside the nodes section.
+     *
+     * @throws  space::io::FormatError if the node is out of the file.
+     */
+    static void validateNodeBounds(std::uint64_t footerOffset, std::uint64_t valueCount, std::uint64_t fileSize)
+    {
+        const auto nodesEnd = fileSize - s_trailerSize;
+        if (footerOffset < s_headerSize || footerOffset > nodesEnd
+            || nodesEnd - footerOffset < s_nodeFooterSize
+            || valueCount > (footerOffset - s_headerSize) / s_keySize)
+        {
+            throw FormatError {"The quadtree node is out of the file bounds."};
+        }
+    }
+
+    /**
+     * @brief   Checks the children are placed before the node values, as they are written
+     *          in the DFS post-order. So the offsets decrease on every path and the traversal
+     *          of a malformed file cannot cycle.
+     *
+     * @throws  space::io::FormatError if the node topology is malformed.
+     */
+    static void validateChildOffsets(std::uint64_t footerOffset, const NodeFooter& footer)
+    {
+        const auto valuesOffset = footerOffset - footer.valueCount * s_keySize;
+        for (const auto child : footer.children)
+        {
+            if (0 != child && child >= valuesOffset)
+            {
+                throw FormatError {"The quadtree node topology is malformed."};
+            }
+        }
+    }
+
+    /**
+     * @brief   Checks the node region is the region which the parent split gives to the child.
+     *          So no node is reachable by two paths and the keys are searched in the nodes
+     *          where the insertion places them.
+     *
+     * @param   footer The child node footer.
+     * @param   childRegion The child region computed from the parent region.
+     * @throws  space::io::FormatError if the region is malformed.
+     */
+    static void validateChildRegion(const NodeFooter& footer, const TRegion& childRegion)
+    {
+        if (footer.region != childRegion)
+        {
+            throw FormatError {"The quadtree node region is malformed."};
+        }
+    }
+};
+
+/**
+ * @brief   Writes the serialized quadtree to the output stream node by node.
+ *
+ * @details The nodes must be written in the DFS post-order (children before parent).
+ *
+ * @tparam  TKey The type of keys.
+ */
+template <typename TKey>
+class QuadTreeWriter
+{
+public:
+    using TLayout = QuadTreeLayout<TKey>;
+    using TRegion = typename TLayout::TRegion;
+    using TChildOffsets = typename TLayout::TChildOffsets;
+
+    /**
+     * @brief   Initializes a new instance of writer and writes the file header.
+     *
+     * @param   os The output stream.
+     */
+    explicit QuadTreeWriter(std::ostream& os)
+        : m_os(os)
+    {
+        space::collections::Array<std::byte, TLayout::s_headerSize> header {};
+        TLayout::writeHeader(header.data());
+        write(header.data(), std::size(header));
+    }
+
+    /**
+     * @brief   Writes the node to the stream.
+     *
+     * @tparam  TValueRange The type of the node values range.
+     * @param   region The node region.
+     * @param   children The offsets of already written children (0 if child not exists).
+     * @param   values The node values.
+     * @return  The offset of the written node.
+     */
+    template <typename TValueRange>
+    std::uint64_t writeNode(const TRegion& region, const TChildOffsets& children, const TValueRange& values)
+    {
+        for (const auto& value : values)
+        {
+            writeValue(value);
+        }
+        return writeNodeFooter(region, children);
+    }
+
+    /**
+     * @brief   Writes the value of the node which footer will be written next.
+     *
+     * @param   value The value.
+     */
+    void writeValue(const TKey& value)
+    {
+        space::collections::Array<std::byte, TLayout::s_keySize> key {};
+        TLayout::writeKey(key.data(), value);
+        write(key.data(), std::size(key));
+        ++m_pendingValueCount;
+    }
+
+    /**
+     * @brief   Writes the node footer, the node values are the values written after
+     *          the previous footer.
+     *
+     * @param   region The node region.
+     * @param   children The offsets of already written children (0 if child not exists).
+     * @return  The offset of the written node.
+     */
+    std::uint64_t writeNodeFooter(const TRegion& region, const TChildOffsets& children)
+    {
+        const auto offset = m_offset;
+        space::collections::Array<std::byte, TLayout::s_nodeFooterSize> footer {};
+        TLayout::writeNodeFooter(footer.data(), {region, children, m_pendingValueCount});
+        write(footer.data(), std::size(footer));
+
+        ++m_nodeCount;
+        m_valueCount += m_pendingValueCount;
+        m_pendingValueCount = 0;
+        return offset;
+    }
+
+    /**
+     * @brief   Gets the number of written nodes.
+     */
+    [[nodiscard]]
+    std::uint64_t nodeCount() const noexcept
+    {
+        return m_nodeCount;
+    }
+
+    /**
+     * @brief   Writes the trailer to the stream.
+     *
+     * @param   rootOffset The offset of root node (0 if the tree is empty).
+     * @throws  std::runtime_error if the stream is failed.
+     */
+    void finish(std::uint64_t rootOffset)
+    {
+        space::collections::Array<std::byte, TLayout::s_trailerSize> trailer {};
+        TLayout::writeTrailer(trailer.data(), {m_nodeCount, m_valueCount, rootOffset, 0});
+        m_checksum.update(trailer.data(), TLayout::s_trailerSize - sizeof(std::uint64_t));
+        TLayout::writeTrailer(trailer.data(), {m_nodeCount, m_valueCount, rootOffset, m_checksum.value()});
+        m_os.write(reinterpret_cast<const char*>(trailer.data()), static_cast<std::streamsize>(std::size(trailer)));
+        m_os.flush();
+        if (!m_os)
+        {
+            throw std::runtime_error {"Failed to write the quadtree."};
+        }
+    }
+
+    /**
+     * @brief   Gets the number of bytes written so far.
+     */
+    [[nodiscard]]
+    std::uint64_t offset() const noexcept
+    {
+        return m_offset;
+    }
+
+private:
+
+    void write(const std::byte* data, std::size_t size)
+    {
+        m_checksum.update(data, size);
+        m_os.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        m_offset += size;
+    }
+
+private:
+    std::ostream& m_os;
+    Checksum m_checksum;
+    std::uint64_t m_offset {0};
+    std::uint64_t m_nodeCount {0};
+    std::uint64_t m_valueCount {0};
+    std::uint64_t m_pendingValueCount {0};
+};
+
+/**
+ * @brief   Reads all remaining bytes of the input stream with one read if the stream is seekable.
+ *
+ * @param   is The input stream.
+ * @return  The bytes.
+ */
+inline space::collections::Vector<std::byte> readAll(std::istream& is)
+{
+    space::collections::Vector<std::byte> data;
+    const auto begin = is.tellg();
+    if (begin != std::istream::pos_type(-1) && is.seekg(0, std::ios::end))
+    {
+        const auto end = is.tellg();
+        is.seekg(begin);
+        data.resize(static_cast<std::size_t>(end - begin));
+        is.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(std::size(data)));
+        data.resize(static_cast<std::size_t>(is.gcount()));
+        return data;
+    }
+
+    is.clear();
+    constexpr std::size_t chunkSize = 1 << 16;
+    while (is)
+    {
+        const auto size = std::size(data);
+        data.resize(size + chunkSize);
+        is.read(reinterpret_cast<char*>(data.data() + size), static_cast<std::streamsize>(chunkSize));
+        data.resize(size + static_cast<std::size_t>(is.gcount()));
+    }
+    return data;
+}
+
+/**
+ * @brief   Validates the header, the trailer and the checksum of the serialized quadtree.
+ *
+ * @tparam  TKey The type of keys.
+ * @param   data The serialized quadtree.
+ * @param   verifyChecksum Whether to compute and compare the checksum of whole data.
+ * @return  The decoded trailer.
+ * @throws  space::io::FormatError if the data is malformed.
+ */
+template <typename TKey>
+typename QuadTreeLayout<TKey>::Trailer validateQuadTree(space::collections::Span<const std::byte> data, bool verifyChecksum = true)
+{
+    using TLayout = QuadTreeLayout<TKey>;
+    if (std::size(data) < TLayout::s_headerSize + TLayout::s_trailerSize)
+    {
+        throw FormatError {"The serialized quadtree is truncated."};
+    }
+    TLayout::validateHeader(data.data());
+
+    const auto trailerOffset = std::size(data) - TLayout::s_trailerSize;
+    const auto trailer = TLayout::readTrailer(data.data() + trailerOffset);
+    if (verifyChecksum)
+    {
+        Checksum checksum;
+        checksum.update(data.data(), std::size(data) - sizeof(std::uint64_t));
+        if (checksum.value() != trailer.checksum)
+        {
+            throw FormatError {"The quadtree checksum mismatch."};
+        }
+    }
+    if (0 != trailer.rootOffset)
+    {
+        TLayout::validateNodeBounds(trailer.rootOffset, 0, std::size(data));
+    }
+    return trailer;
+}
+
+} // namespace space::io
@@ -22,6 +22,11 @@
 namespace space
 {
 
+namespace io::impl
+{
+struct GeometryAccess;
+} // namespace io::impl
+
 /**
  * @class   SimplePolygon
  * @brief   The c++ representation of simple polygon.
@@ -118,6 +123,11 @@ public:
 
 private:
 
+    /**
+     * @brief   The decoders fill the piecewise linear curve in place.
+     */
+    friend struct space::io::impl::GeometryAccess;
+
     /**
      * @brief   The piecewise linear curve representing by a set of points.
      */
@@ -178,71 +188,121 @@ TCrt infinityXAxisFor(const SimplePolygon<TCrt>& poly) noexcept
     space::Rect boundingBox = space::util::boundaryBoxOf(poly);
     return space::util::topRightOf(boundingBox).x() + 1;
 }
-} // namespace impl
 
 /**
- * @brief   Returns true if the given point is inside or on the edge of the Simple Polygon,
- *          otherwise returns false.
+ * @internal
+ * @brief           The even-odd rule over the piecewise linear curve given by the single
+ *                  forward pass, so it works with the decoding iterators as well.
  *
- * @details Calculates whether a point is inside a simple polygon. A polygon is defined by a
- *          sequence of points (boundary curve). Staying inside is determined by the even-odd rule.
- *          If we take a ray that starts at a point and goes off to infinity (in any direction),
- *          we count the number of intersections. If this number is odd, the point is inside;
- *          otherwise, it is outside. The running time linearly depends on the number of vertices
- *          in the polygon.
- * @tparam  TCrt The type of coordinates.
- * @param   poly The given Simple Polygon.
- * @param   point The given point.
- * @return  true if contains, otherwise returns false.
+ * @details         Every edge is checked with the vertex following it, so the first two
+ *                  vertices are kept to close the curve.
+ * @tparam TCrt     The type of coordinates.
+ * @tparam TForwardIt The type of iterator over the curve points.
+ * @param first     The begin of curve.
+ * @param last      The end of curve.
+ * @param point     The given point.
+ * @param infinity  The x-axis coordinate greater than the x-axis coordinates of all vertices.
+ * @return          true if contains, otherwise returns false.
  */
-template <typename TCrt>
+template <typename TCrt, typename TForwardIt>
 [[nodiscard]]
-constexpr bool contains(const SimplePolygon<TCrt>& poly, const Point<TCrt>& point) noexcept
+constexpr bool containsByEvenOddRule(TForwardIt first, TForwardIt last, const Point<TCrt>& point, TCrt infinity)
 {
     // Create a horizontal line from point to infinity.
-    const auto infinity = impl::infinityXAxisFor(poly);
     const Segment<TCrt> horizontalLine { point, Point<TCrt>{infinity, point.y()} };
 
-    // Count intersections of the above line with sides of polygon
-    size_t count = 0;
-    size_t i = 0;
-
-    const auto& boundary = poly.boundaryCurve();
-    auto numOfVertex = std::size(boundary);
-
-    if (numOfVertex < 3)
+    if (first == last)
+    {
+        return false;
+    }
+    const Point<TCrt> firstVertex = *first;
+    if (++first == last)
+    {
+        return false;
+    }
+    const Point<TCrt> secondVertex = *first;
+    if (++first == last)
     {
         return false;
     }
 
-    do
+    // Count intersections of the above line with sides of polygon
+    size_t count = 0;
+    bool onEdge = false;
+    auto checkEdge = [&](const Segment<TCrt>& polygonEdge, const Point<TCrt>& nextVertex)
     {
-        const auto next = (i + 1) % numOfVertex;
-        Segment polygonEdge {boundary[i], boundary[next]};
         if (hasIntersect(polygonEdge, horizontalLine))
         {
             if (impl::EOrientation::collinear
                 == impl::orientation(polygonEdge.first, point, polygonEdge.second))
             {
-                return impl::onSegment(polygonEdge, point);
+                onEdge = impl::onSegment(polygonEdge, point);
+                return true;
             }
             if (impl::onSegment(horizontalLine, polygonEdge.second))
             {
                 if (impl::orientation(point, polygonEdge.second, polygonEdge.first)
-                    == impl::orientation(boundary[(i + 2) % numOfVertex], polygonEdge.second, point))
+                    == impl::orientation(nextVertex, polygonEdge.second, point))
                 {
                     ++count;
                 }
             }
             ++count;
         }
+        return false;
+    };
 
-        i = next;
-    } while (i != 0);
+    Segment polygonEdge {firstVertex, secondVertex};
+    for (; first != last; ++first)
+    {
+        const Point<TCrt> nextVertex = *first;
+        if (checkEdge(polygonEdge, nextVertex))
+        {
+            return onEdge;
+        }
+        polygonEdge = {polygonEdge.second, nextVertex};
+    }
+    if (checkEdge(polygonEdge, firstVertex))
+    {
+        return onEdge;
+    }
+    if (checkEdge({polygonEdge.second, firstVertex}, secondVertex))
+    {
+        return onEdge;
+    }
 
     // Return true if count is odd, false otherwise
     return count & 1;
 }
+} // namespace impl
+
+/**
+ * @brief   Returns true if the given point is inside or on the edge of the Simple Polygon,
+ *          otherwise returns false.
+ *
+ * @details Calculates whether a point is inside a simple polygon. A polygon is defined by a
+ *          sequence of points (boundary curve). Staying inside is determined by the even-odd rule.
+ *          If we take a ray that starts at a point and goes off to infinity (in any direction),
+ *          we count the number of intersections. If this number is odd, the point is inside;
+ *          otherwise, it is outside. The running time linearly depends on the number of vertices
+ *          in the polygon.
+ * @tparam  TCrt The type of coordinates.
+ * @param   poly The given Simple Polygon.
+ * @param   point The given point.
+ * @return  true if contains, otherwise returns false.
+ */
+template <typename TCrt>
+[[nodiscard]]
+constexpr bool contains(const SimplePolygon<TCrt>& poly, const Point<TCrt>& point) noexcept
+{
+    if (std::size(poly.boundaryCurve()) < 3)
+    {
+        return false;
+    }
+
+    return impl::containsByEvenOddRule(std::begin(poly.boundaryCurve()), std::end(poly.boundaryCurve())
+        , point, impl::infinityXAxisFor(poly));
+}
 
 namespace impl
 {
@@ -0,0 +1,500 @@
+/**
+ * @file        Wkb.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the Well-Known Binary (WKB) reader and writer.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "Definitions.h"
+#include "GeometryAccess.h"
+#include "Point.h"
+#include "Polygon.h"
+#include "Segment.h"
+#include "Serialization.h"
+#include "SimplePolygon.h"
+
+namespace space::io
+{
+
+/**
+ * @brief   The WKB byte order marks.
+ */
+enum class WkbByteOrder : std::uint8_t
+{
+    BigEndian = 0,
+    LittleEndian = 1,
+};
+
+/**
+ * @brief   The supported WKB geometry types (2D only).
+ */
+enum class WkbGeometryType : std::uint32_t
+{
+    Point = 1,
+    LineString = 2,
+    Polygon = 3,
+};
+
+namespace impl
+{
+
+/**
+ * @internal
+ * @brief   The bounds-checked cursor over one WKB record.
+ */
+class WkbCursor
+{
+public:
+
+    explicit WkbCursor(space::collections::Span<const std::byte> data) noexcept
+        : m_data {data}
+    {
+    }
+
+    /**
+     * @brief   Reads the byte order mark of the next geometry.
+     */
+    void readByteOrder()
+    {
+        require(1);
+        const auto order = std::to_integer<std::uint8_t>(m_data[m_pos++]);
+        if (order > 1)
+        {
+            throw FormatError {"Invalid WKB byte order mark."};
+        }
+        m_swap = (static_cast<std::uint8_t>(WkbByteOrder::LittleEndian) == order)
+            != (std::endian::native == std::endian::little);
+    }
+
+    [[nodiscard]]
+    std::uint32_t readUInt32()
+    {
+        require(sizeof(std::uint32_t));
+        return read<std::uint32_t>();
+    }
+
+    /**
+     * @brief   Reads the number of items having at least itemSize bytes each, so the
+     *          malformed counts are rejected before allocating memory.
+     */
+    [[nodiscard]]
+    std::size_t readCount(std::size_t itemSize)
+    {
+        const auto count = static_cast<std::size_t>(readUInt32());
+        if (count > remaining() / itemSize)
+        {
+            throw FormatError {"The WKB record is truncated."};
+        }
+        return count;
+    }
+
+    template <typename TCrt>
+    [[nodiscard]]
+    space::Point<TCrt> readPoint()
+    {
+        require(2 * sizeof(double));
+        const auto x = read<double>();
+        const auto y = read<double>();
+        return {impl::toCoordinate<TCrt>(x), impl::toCoordinate<TCrt>(y)};
+    }
+
+    /**
+     * @brief   Reads the given number of points to the given memory.
+     */
+    template <typename TCrt>
+    void readPoints(space::Point<TCrt>* points, std::size_t count)
+    {
+        require(count * 2 * sizeof(double));
+        if constexpr (std::is_same_v<TCrt, double>
+                      && sizeof(space::Point<double>) == 2 * sizeof(double)
+                      && std::is_trivially_copyable_v<space::Point<double>>)
+        {
+            if (!m_swap)
+            {
+                std::memcpy(static_cast<void*>(points), m_data.data() + m_pos, count * sizeof(space::Point<double>));
+                m_pos += count * sizeof(space::Point<double>);
+                return;
+            }
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto x = read<double>();
+            const auto y = read<double>();
+            points[i] = {impl::toCoordinate<TCrt>(x), impl::toCoordinate<TCrt>(y)};
+        }
+    }
+
+    [[nodiscard]]
+    std::size_t position() const noexcept
+    {
+        return m_pos;
+    }
+
+private:
+
+    [[nodiscard]]
+    std::size_t remaining() const noexcept
+    {
+        return std::size(m_data) - m_pos;
+    }
+
+    void require(std::size_t size) const
+    {
+        if (size > remaining())
+        {
+            throw FormatError {"The WKB record is truncated."};
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    T read() noexcept
+    {
+        space::collections::Array<std::byte, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), m_data.data() + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        if (m_swap)
+        {
+            std::ranges::reverse(bytes);
+        }
+        T value;
+        std::memcpy(std::addressof(value), bytes.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    space::collections::Span<const std::byte> m_data;
+    std::size_t m_pos {0};
+    bool m_swap {false};
+};
+
+/**
+ * @internal
+ * @brief   Reads the geometry header and checks the geometry type.
+ */
+inline void readWkbHeader(WkbCursor& cursor, WkbGeometryType expected)
+{
+    cursor.readByteOrder();
+    if (static_cast<std::uint32_t>(expected) != cursor.readUInt32())
+    {
+        throw FormatError {"Unexpected WKB geometry type."};
+    }
+}
+
+/**
+ * @internal
+ * @brief   Reads the linear ring to the given curve, the closing point is dropped.
+ */
+template <typename TCrt>
+void readWkbRing(WkbCursor& cursor, space::collections::Vector<space::Point<TCrt>>& curve)
+{
+    const auto count = cursor.readCount(2 * sizeof(double));
+    curve.resize(count);
+    cursor.readPoints(curve.data(), count);
+    if (count > 1 && curve.front() == curve.back())
+    {
+        curve.pop_back();
+    }
+}
+
+/**
+ * @internal
+ * @brief   The WKB writer appending to the byte buffer.
+ */
+class WkbWriter
+{
+public:
+
+    explicit WkbWriter(space::collections::Vector<std::byte>& buffer, std::size_t size)
+        : m_buffer {buffer}
+        , m_pos {std::size(buffer)}
+    {
+        m_buffer.resize(m_pos + size);
+    }
+
+    void writeHeader(WkbGeometryType type) noexcept
+    {
+        m_buffer[m_pos++] = std::byte {static_cast<std::uint8_t>(WkbByteOrder::LittleEndian)};
+        writeUInt32(static_cast<std::uint32_t>(type));
+    }
+
+    void writeUInt32(std::uint32_t value) noexcept
+    {
+        storeLittleEndian(m_buffer.data() + m_pos, value);
+        m_pos += sizeof(value);
+    }
+
+    template <typename TCrt>
+    void writePoint(const space::Point<TCrt>& point) noexcept
+    {
+        storeLittleEndian(m_buffer.data() + m_pos, static_cast<double>(point.x()));
+        storeLittleEndian(m_buffer.data() + m_pos + sizeof(double), static_cast<double>(point.y()));
+        m_pos += 2 * sizeof(double);
+    }
+
+    /**
+     * @brief   Writes the linear ring, the closing point is added.
+     */
+    template <typename TCrt>
+    void writeRing(const space::collections::Vector<space::Point<TCrt>>& curve) noexcept
+    {
+        writeUInt32(static_cast<std::uint32_t>(ringSize(curve)));
+        for (const auto& point : curve)
+        {
+            writePoint(point);
+        }
+        if (!curve.empty())
+        {
+            writePoint(curve.front());
+        }
+    }
+
+    template <typename TCrt>
+    [[nodiscard]]
+    static std::size_t ringSize(const space::collections::Vector<space::Point<TCrt>>& curve) noexcept
+    {
+        return curve.empty() ? 0 : std::size(curve) + 1;
+    }
+
+private:
+    space::collections::Vector<std::byte>& m_buffer;
+    std::size_t m_pos;
+};
+
+inline constexpr std::size_t s_wkbHeaderSize = 1 + sizeof(std::uint32_t);
+inline constexpr std::size_t s_wkbPointSize = 2 * sizeof(double);
+
+template <typename TCrt>
+[[nodiscard]]
+std::size_t wkbPolygonSize(space::collections::Span<const space::SimplePolygon<TCrt>> contours) noexcept
+{
+    auto size = s_wkbHeaderSize + sizeof(std::uint32_t);
+    for (const auto& contour : contours)
+    {
+        size += sizeof(std::uint32_t)
+            + WkbWriter::ringSize(GeometryAccess::curveOf(contour)) * s_wkbPointSize;
+    }
+    return size;
+}
+
+} // namespace impl
+
+/**
+ * @brief   Reads the WKB Point record.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   data The buffer starting with the record.
+ * @param   point The decoded point.
+ * @throws  space::io::FormatError if the record is malformed or has another type.
+ * @return  The number of consumed bytes.
+ */
+template <typename TCrt>
+std::size_t readWkb(space::collections::Span<const std::byte> data, space::Point<TCrt>& point)
+{
+    impl::WkbCursor cursor {data};
+    impl::readWkbHeader(cursor, WkbGeometryType::Point);
+    point = cursor.readPoint<TCrt>();
+    return cursor.position();
+}
+
+/**
+ * @brief   Reads the WKB LineString record with exactly two points.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   data The buffer starting with the record.
+ * @param   segment The decoded segment.
+ * @throws  space::io::FormatError if the record is malformed, has another type or
+ *          another number of points.
+ * @return  The number of consumed bytes.
+ */
+template <typename TCrt>
+std::size_t readWkb(space::collections::Span<const std::byte> data, space::Segment<TCrt>& segment)
+{
+    impl::WkbCursor cursor {data};
+    impl::readWkbHeader(cursor, WkbGeometryType::LineString);
+    if (2 != cursor.readUInt32())
+    {
+        throw FormatError {"The WKB segment must have exactly two points."};
+    }
+    segment.first = cursor.readPoint<TCrt>();
+    segment.second = cursor.readPoint<TCrt>();
+    return cursor.position();
+}
+
+/**
+ * @brief   Reads the WKB Polygon record without holes.
+ *
+ * @details The memory of the given polygon is reused, so decoding many records into the
+ *          same object does not allocate after the biggest one.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   data The buffer starting with the record.
+ * @param   poly The decoded simple polygon.
+ * @throws  space::io::FormatError if the record is malformed, has another type or has holes.
+ * @return  The number of consumed bytes.
+ */
+template <typename TCrt>
+std::size_t readWkb(space::collections::Span<const std::byte> data, space::SimplePolygon<TCrt>& poly)
+{
+    impl::WkbCursor cursor {data};
+    impl::readWkbHeader(cursor, WkbGeometryType::Polygon);
+    auto& curve = impl::GeometryAccess::curveOf(poly);
+    const auto numOfRings = cursor.readUInt32();
+    if (numOfRings > 1)
+    {
+        throw FormatError {"The WKB simple polygon must not have holes."};
+    }
+    if (0 == numOfRings)
+    {
+        curve.clear();
+    }
+    else
+    {
+        impl::readWkbRing(cursor, curve);
+    }
+    return cursor.position();
+}
+
+/**
+ * @brief   Reads the WKB Polygon record.
+ *
+ * @details The contours are decoded in place: the contour list is sized by the ring count
+ *          and the memory of the given polygon is reused, so decoding many records into the
+ *          same object does not allocate after the biggest one.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   data The buffer starting with the record.
+ * @param   poly The decoded polygon.
+ * @throws  space::io::FormatError if the record is malformed or has another type.
+ * @return  The number of consumed bytes.
+ */
+template <typename TCrt>
+std::size_t readWkb(space::collections::Span<const std::byte> data, space::Polygon<TCrt>& poly)
+{
+    impl::WkbCursor cursor {data};
+    impl::readWkbHeader(cursor, WkbGeometryType::Polygon);
+    auto& contours = impl::GeometryAccess::contoursOf(poly);
+    contours.resize(cursor.readCount(sizeof(std::uint32_t)));
+    for (auto& contour : contours)
+    {
+        impl::readWkbRing(cursor, impl::GeometryAccess::curveOf(contour));
+    }
+    return cursor.position();
+}
+
+/**
+ * @brief   Appends the WKB Point record to the buffer.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   point The point.
+ * @param   buffer The output buffer.
+ */
+template <typename TCrt>
+void writeWkb(const space::Point<TCrt>& point, space::collections::Vector<std::byte>& buffer)
+{
+    impl::WkbWriter writer {buffer, impl::s_wkbHeaderSize + impl::s_wkbPointSize};
+    writer.writeHeader(WkbGeometryType::Point);
+    writer.writePoint(point);
+}
+
+/**
+ * @brief   Appends the segment as the WKB LineString record to the buffer.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   segment The segment.
+ * @param   buffer The output buffer.
+ */
+template <typename TCrt>
+void writeWkb(const space::Segment<TCrt>& segment, space::collections::Vector<std::byte>& buffer)
+{
+    impl::WkbWriter writer {buffer, impl::s_wkbHeaderSize + sizeof(std::uint32_t) + 2 * impl::s_wkbPointSize};
+    writer.writeHeader(WkbGeometryType::LineString);
+    writer.writeUInt32(2);
+    writer.writePoint(segment.first);
+    writer.writePoint(segment.second);
+}
+
+/**
+ * @brief   Appends the simple polygon as the WKB Polygon record to the buffer,
+ *          the ring is closed by repeating the first point.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   poly The simple polygon.
+ * @param   buffer The output buffer.
+ */
+template <typename TCrt>
+void writeWkb(const space::SimplePolygon<TCrt>& poly, space::collections::Vector<std::byte>& buffer)
+{
+    if (poly.empty())
+    {
+        impl::WkbWriter writer {buffer, impl::s_wkbHeaderSize + sizeof(std::uint32_t)};
+        writer.writeHeader(WkbGeometryType::Polygon);
+        writer.writeUInt32(0);
+        return;
+    }
+
+    impl::WkbWriter writer {buffer, impl::wkbPolygonSize<TCrt>({&poly, 1})};
+    writer.writeHeader(WkbGeometryType::Polygon);
+    writer.writeUInt32(1);
+    writer.writeRing(poly.boundaryCurve());
+}
+
+/**
+ * @brief   Appends the WKB Polygon record to the buffer, the rings are closed by repeating
+ *          their first points.
+ *
+ * @tparam  TCrt The type of coordinates.
+ * @param   poly The polygon.
+ * @param   buffer The output buffer.
+ */
+template <typename TCrt>
+void writeWkb(const space::Polygon<TCrt>& poly, space::collections::Vector<std::byte>& buffer)
+{
+    const auto& contours = impl::GeometryAccess::contoursOf(poly);
+    impl::WkbWriter writer {buffer, impl::wkbPolygonSize<TCrt>(contours)};
+    writer.writeHeader(WkbGeometryType::Polygon);
+    writer.writeUInt32(static_cast<std::uint32_t>(std::size(contours)));
+    for (const auto& contour : contours)
+    {
+        writer.writeRing(impl::GeometryAccess::curveOf(contour));
+    }
+}
+
+/**
+ * @brief   Decodes the buffer of concatenated WKB records of the same geometry type.
+ *
+ * @details All records are decoded into the same geometry object, so the memory is allocated
+ *          only while the records grow. The geometry passed to the callback is valid only
+ *          during the call.
+ *
+ * @tparam  TGeometry The type of geometry (Point, Segment, SimplePolygon or Polygon).
+ * @tparam  TFunc The type of callback, invocable with (const TGeometry&).
+ * @param   data The buffer of records.
+ * @param   func The callback.
+ * @throws  space::io::FormatError if a record is malformed.
+ * @return  The number of decoded records.
+ */
+template <typename TGeometry, typename TFunc>
+std::size_t forEachWkb(space::collections::Span<const std::byte> data, TFunc func)
+{
+    TGeometry geometry {};
+    std::size_t count = 0;
+    while (!data.empty())
+    {
+        data = data.subspan(readWkb(data, geometry));
+        func(std::as_const(geometry));
+        ++count;
+    }
+    return count;
+}
+
+} // namespace space::io
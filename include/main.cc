@@ -4,5 +4,16 @@
 #include "Utility.h"
 #include "QuadTree.h"
 #include "SimplePolygon.h"
+#include "CompressedSimplePolygon.h"
 #include "Polygon.h"
 #include "Segment.h"
+#include "RectJoin.h"
+#include "Serialization.h"
+#include "QuadTreeTrace.h"
+#include "Wkb.h"
+#include "GeometryText.h"
+#if !defined(_WIN32)
+#include "MappedQuadTree.h"
+#include "PagedQuadTree.h"
+#include "QuadTreeBuilder.h"
+#endif
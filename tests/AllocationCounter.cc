@@ -0,0 +1,193 @@
+/**
+ * @file        AllocationCounter.cc
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Replaces the global allocation functions with the counting ones.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+
+namespace
+{
+
+// Constant initialized, so it is usable from the allocations made during the static initialization.
+thread_local test_util::impl::AllocationCounters s_counters {};
+
+std::size_t usableSize(void* ptr) noexcept
+{
+#if defined(__GLIBC__)
+    return malloc_usable_size(ptr);
+#else
+    static_cast<void>(ptr);
+    return 0;
+#endif
+}
+
+void* allocate(std::size_t size, std::size_t alignment) noexcept
+{
+    size = std::max<std::size_t>(size, 1);
+    void* ptr = nullptr;
+    if (alignment <= alignof(std::max_align_t))
+    {
+        ptr = std::malloc(size);
+    }
+    else
+    {
+        // The size of aligned_alloc must be the multiple of the alignment.
+        ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    if (nullptr != ptr)
+    {
+        ++s_counters.allocations;
+        s_counters.allocatedBytes += size;
+        s_counters.liveBytes += usableSize(ptr);
+        s_counters.peakLiveBytes = std::max(s_counters.peakLiveBytes, s_counters.liveBytes);
+    }
+    return ptr;
+}
+
+void* allocateOrThrow(std::size_t size, std::size_t alignment)
+{
+    auto* ptr = allocate(size, alignment);
+    if (nullptr == ptr)
+    {
+        throw std::bad_alloc {};
+    }
+    return ptr;
+}
+
+void deallocate(void* ptr) noexcept
+{
+    if (nullptr == ptr)
+    {
+        return;
+    }
+    ++s_counters.deallocations;
+    // The memory can be freed by other thread, so the live bytes are clamped.
+    s_counters.liveBytes -= std::min(s_counters.liveBytes, usableSize(ptr));
+    std::free(ptr);
+}
+
+constexpr auto s_defaultAlignment = alignof(std::max_align_t);
+
+}
+
+namespace test_util::impl
+{
+
+AllocationCounters& threadAllocationCounters() noexcept
+{
+    return s_counters;
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+    return allocateOrThrow(size, s_defaultAlignment);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocateOrThrow(size, s_defaultAlignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size, s_defaultAlignment);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size, s_defaultAlignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    deallocate(ptr);
+}
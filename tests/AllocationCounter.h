@@ -0,0 +1,114 @@
+/**
+ * @file        AllocationCounter.h
+ * @author      Argishti Ayvazyan (ayvazyan.argishti@gmail.com)
+ * @brief       Declaring the counters of the heap allocations for tests and benchmarks.
+ * @date        17-10-2026
+ * @copyright   Copyright (c) 2026
+ */
+
+#pragma once
+
+#include <cstddef>
+
+
+namespace test_util
+{
+
+/**
+ * @brief   The heap allocations made by the thread.
+ */
+struct AllocationStatistics
+{
+    std::size_t allocations {0};
+    std::size_t deallocations {0};
+
+    /**
+     * @brief   The total number of requested bytes.
+     */
+    std::size_t allocatedBytes {0};
+
+    /**
+     * @brief   The maximum number of live bytes above the starting point.
+     */
+    std::size_t peakBytes {0};
+
+    /**
+     * @brief   Adds the allocations of other scope, the peak is the maximum of both.
+     */
+    AllocationStatistics& operator+=(const AllocationStatistics& other) noexcept
+    {
+        allocations += other.allocations;
+        deallocations += other.deallocations;
+        allocatedBytes += other.allocatedBytes;
+        peakBytes = peakBytes > other.peakBytes ? peakBytes : other.peakBytes;
+        return *this;
+    }
+};
+
+namespace impl
+{
+
+/**
+ * @internal
+ * @brief   The raw counters updated by the replaced global operator new and delete.
+ */
+struct AllocationCounters
+{
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t allocatedBytes;
+    std::size_t liveBytes;
+    std::size_t peakLiveBytes;
+};
+
+/**
+ * @internal
+ * @brief   Gets the counters of the calling thread, defined in AllocationCounter.cc with the
+ *          replacements of the global allocation functions.
+ */
+AllocationCounters& threadAllocationCounters() noexcept;
+
+} // namespace impl
+
+/**
+ * @brief   Counts the heap allocations of the calling thread from the construction.
+ *
+ * @details Works only in executables linked with AllocationCounter.cc (the allocation_counter
+ *          library), which replaces the global operator new and delete. The scopes must not
+ *          be nested, every scope restarts the peak tracking.
+ */
+class AllocationScope
+{
+public:
+    AllocationScope() noexcept
+        : m_start {startCounters()}
+    {
+    }
+
+    /**
+     * @brief   Gets the allocations made since the scope construction.
+     */
+    [[nodiscard]]
+    AllocationStatistics statistics() const noexcept
+    {
+        const auto& counters = impl::threadAllocationCounters();
+        return AllocationStatistics {counters.allocations - m_start.allocations
+                                     , counters.deallocations - m_start.deallocations
+                                     , counters.allocatedBytes - m_start.allocatedBytes
+                                     , counters.peakLiveBytes - m_start.liveBytes};
+    }
+
+private:
+
+    static impl::AllocationCounters startCounters() noexcept
+    {
+        auto& counters = impl::threadAllocationCounters();
+        counters.peakLiveBytes = counters.liveBytes;
+        return counters;
+    }
+
+private:
+    impl::AllocationCounters m_start;
+};
+
+}
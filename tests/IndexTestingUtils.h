@@ -6,6 +6,10 @@
 #include <random>
 #include <algorithm>
 #include <iostream>
+#include <execution>
+#include <mutex>
+#include <set>
+#include <sstream>
 
 #include <boost/geometry/geometries/point.hpp>
 #include <boost/geometry/geometries/box.hpp>
@@ -13,7 +17,12 @@
 
 #include "Rect.h"
 #include "Square.h"
+#include "AggregateQuadTree.h"
 #include "QuadTree.h"
+#include "MappedQuadTree.h"
+#include "PagedQuadTree.h"
+#include "QuadTreeBuilder.h"
+#include "QuadTreeTrace.h"
 #include "Utility.h"
 
 namespace test_util
@@ -200,6 +209,7 @@ void clearIndexTest()
     ASSERT_FALSE(index.empty());
     index.clear();
     ASSERT_TRUE(index.empty());
+    ASSERT_EQ(index.size(), 0);
 }
 
 template <typename TIndex, typename TCrt, size_t Count>
@@ -228,4 +238,122 @@ void sizeTest(TCrt maxPos, TCrt maxRectWidth, TCrt maxRectHeight)
     }
 }
 
+template <typename TIndex, typename TCrt, size_t Count, typename TExecutionPolicy>
+void overlappingPairsTest(TExecutionPolicy&& policy, TCrt maxPos, TCrt maxRectWidth, TCrt maxRectHeight)
+{
+    std::set<space::Rect<TCrt>> initialRects;
+    for (size_t i = 0; i < Count; ++i)
+    {
+        initialRects.insert(getRandRect(maxPos, maxRectWidth, maxRectHeight));
+    }
+
+    TIndex index;
+    for (const auto& rect : initialRects)
+    {
+        index.insert(rect);
+    }
+
+    std::set<std::pair<space::Rect<TCrt>, space::Rect<TCrt>>> expectedPairs;
+    for (auto it = initialRects.begin(); it != initialRects.end(); ++it)
+    {
+        for (auto nextIt = std::next(it); nextIt != initialRects.end(); ++nextIt)
+        {
+            if (space::util::hasIntersect(*it, *nextIt))
+            {
+                expectedPairs.emplace(*it, *nextIt);
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<std::pair<space::Rect<TCrt>, space::Rect<TCrt>>> actualPairs;
+    index.forEachOverlappingPair(std::forward<TExecutionPolicy>(policy)
+        , [&](const space::Rect<TCrt>& first, const space::Rect<TCrt>& second)
+        {
+            ASSERT_TRUE(space::util::hasIntersect(first, second));
+            std::lock_guard lock {mutex};
+            actualPairs.push_back(std::minmax(first, second));
+        });
+
+    ASSERT_EQ(std::size(actualPairs), std::size(expectedPairs));
+    std::set<std::pair<space::Rect<TCrt>, space::Rect<TCrt>>> actualPairsSet(actualPairs.begin(), actualPairs.end());
+    ASSERT_EQ(std::size(actualPairsSet), std::size(actualPairs));
+    ASSERT_TRUE(actualPairsSet == expectedPairs);
+}
+
+template <typename TIndex, typename TOtherIndex, typename TCrt>
+void compareQueries(const TIndex& index, const TOtherIndex& otherIndex, size_t count
+    , TCrt maxPos, TCrt maxRectWidth, TCrt maxRectHeight)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        space::Rect<TCrt> queryRect {getRandRect(maxPos, maxRectWidth, maxRectHeight)};
+
+        std::vector<space::Rect<TCrt>> queryRes;
+        index.query(queryRect, std::back_inserter(queryRes));
+        std::vector<space::Rect<TCrt>> otherQueryRes;
+        otherIndex.query(queryRect, std::back_inserter(otherQueryRes));
+
+        std::ranges::sort(queryRes);
+        std::ranges::sort(otherQueryRes);
+        ASSERT_TRUE(queryRes == otherQueryRes);
+    }
+}
+
+template <typename TIndex, typename TCrt, size_t Count>
+void serializationTest(TCrt maxPos, TCrt maxRectWidth, TCrt maxRectHeight)
+{
+    std::vector<space::Rect<TCrt>> initialRects;
+    TIndex index;
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const auto rect = getRandRect(maxPos, maxRectWidth, maxRectHeight);
+        if (index.insert(rect))
+        {
+            initialRects.push_back(rect);
+        }
+    }
+
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    index.save(stream);
+    const auto loadedIndex = TIndex::load(stream);
+
+    ASSERT_EQ(loadedIndex.size(), index.size());
+    for (const auto& rect : initialRects)
+    {
+        ASSERT_TRUE(loadedIndex.contains(rect));
+    }
+    compareQueries(index, loadedIndex, Count, maxPos, maxRectWidth, maxRectHeight);
+}
+
+template <typename TIndex, typename TCrt>
+void nearestTest(const TIndex& index, const std::vector<space::Rect<TCrt>>& rects, TCrt maxPos, size_t count)
+{
+    auto squaredDistance = [](const space::Point<TCrt>& point, const space::Rect<TCrt>& rect)
+    {
+        const auto[x1, y1] = space::util::bottomLeftOf(rect);
+        const auto[x2, y2] = space::util::topRightOf(rect);
+        const auto dx = std::max({int64_t {x1} - point.x(), int64_t {0}, int64_t {point.x()} - x2});
+        const auto dy = std::max({int64_t {y1} - point.y(), int64_t {0}, int64_t {point.y()} - y2});
+        return dx * dx + dy * dy;
+    };
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        const auto point = getRandPoint(maxPos);
+        std::vector<space::Rect<TCrt>> nearestRects;
+        index.nearest(point, count, std::back_inserter(nearestRects));
+        ASSERT_EQ(std::size(nearestRects), std::min(count, std::size(rects)));
+
+        std::vector<int64_t> expectedDistances;
+        std::ranges::transform(rects, std::back_inserter(expectedDistances)
+            , [&](const auto& rect) { return squaredDistance(point, rect); });
+        std::ranges::sort(expectedDistances);
+        for (size_t j = 0; j < std::size(nearestRects); ++j)
+        {
+            ASSERT_EQ(squaredDistance(point, nearestRects[j]), expectedDistances[j]);
+        }
+    }
+}
+
 } // namespace test_util
@@ -9,7 +9,10 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
 
+
+#include "AllocationCounter.h"
 #include "IndexTestingUtils.h"
 
 
@@ -68,6 +71,940 @@ TEST(space_QuadTree, QuadTreeSize)
     test_util::sizeTest<space::QuadTree<space::Rect<value_type>>, value_type, 10'000>(1'000, 1'000, 1'000);
 }
 
+TEST(space_QuadTree, QuadTreeOverlappingPairs)
+{
+    using value_type = int32_t;
+    using index_type = space::QuadTree<space::Rect<value_type>>;
+    test_util::overlappingPairsTest<index_type, value_type, 2'000>(std::execution::seq, 1'000, 50, 50);
+    test_util::overlappingPairsTest<index_type, value_type, 2'000>(std::execution::seq, 1'000, 1, 1'000);
+    test_util::overlappingPairsTest<index_type, value_type, 2'000>(std::execution::par, 1'000, 50, 50);
+    test_util::overlappingPairsTest<index_type, value_type, 2'000>(std::execution::par, 100'000, 1'000, 1'000);
+}
+
+TEST(space_QuadTree, QuadTreeSerialization)
+{
+    using value_type = int32_t;
+    using index_type = space::QuadTree<space::Rect<value_type>>;
+    test_util::serializationTest<index_type, value_type, 2'000>(1'000, 1'000, 1'000);
+    test_util::serializationTest<index_type, value_type, 10'000>(1'000'000, 1, 1);
+    test_util::serializationTest<index_type, value_type, 1'000>(1'000, 1'000'000, 1'000'000);
+}
+
+TEST(space_QuadTree, QuadTreeSerializationEmpty)
+{
+    using value_type = int32_t;
+    using index_type = space::QuadTree<space::Rect<value_type>>;
+
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    index_type {}.save(stream);
+    const auto index = index_type::load(stream);
+    ASSERT_TRUE(index.empty());
+    ASSERT_EQ(index.size(), 0);
+}
+
+TEST(space_QuadTree, QuadTreeSerializationFile)
+{
+    using value_type = int32_t;
+    using index_type = space::QuadTree<space::Rect<value_type>>;
+
+    index_type index;
+    for (size_t i = 0; i < 1'000; ++i)
+    {
+        index.insert(test_util::getRandRect(1'000, 100, 100));
+    }
+    const auto path = std::filesystem::temp_directory_path() / "space_QuadTreeSerializationFile.qt";
+    index.save(path);
+    const auto loadedIndex = index_type::load(path);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(loadedIndex.size(), index.size());
+    test_util::compareQueries(index, loadedIndex, 1'000, 1'000, 100, 100);
+}
+
+TEST(space_QuadTree, QuadTreeSerializationCorrupted)
+{
+    using value_type = int32_t;
+    using index_type = space::QuadTree<space::Rect<value_type>>;
+
+    index_type index;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        index.insert(test_util::getRandRect(1'000, 100, 100));
+    }
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    index.save(stream);
+    const auto data = stream.str();
+
+    auto corrupted = data;
+    corrupted[corrupted.size() / 2] ^= 0x5A;
+    std::stringstream corruptedStream {corrupted, std::ios::in | std::ios::binary};
+    ASSERT_THROW(index_type::load(corruptedStream), space::io::FormatError);
+
+    std::stringstream truncatedStream {data.substr(0, data.size() - 1), std::ios::in | std::ios::binary};
+    ASSERT_THROW(index_type::load(truncatedStream), space::io::FormatError);
+
+    std::stringstream otherTypeStream {data, std::ios::in | std::ios::binary};
+    ASSERT_THROW(space::QuadTree<space::Rect<int64_t>>::load(otherTypeStream), space::io::FormatError);
+}
+
+TEST(space_CompactQuadTree, CompactQuadTreeQuery)
+{
+    using value_type = int32_t;
+    using index_type = space::CompactQuadTree<space::Rect<value_type>>;
+    test_util::queryTest<index_type, value_type, 10'000>(1'000, 1'000, 1'000);
+    test_util::queryTest<index_type, value_type, 1'000>(1'000, 1'000'000, 1'000'000);
+    test_util::removeTest<index_type, value_type, 1'000>(1'000, 1'000, 1'000);
+    test_util::removeTest<index_type, value_type, 1'000>(1'000, 1'000'000, 1'000'000);
+    test_util::overlappingPairsTest<index_type, value_type, 2'000>(std::execution::seq, 100'000, 1'000, 1'000);
+    test_util::serializationTest<index_type, value_type, 2'000>(1'000'000, 1'000, 1'000);
+}
+
+TEST(space_CompactQuadTree, CompactQuadTreeMatchesQuadTree)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+
+    // The large coordinates make the upper nodes quantized with the scaling.
+    space::QuadTree<key_type> index;
+    space::CompactQuadTree<key_type> compactIndex;
+    std::vector<key_type> rects;
+    for (size_t i = 0; i < 5'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(100'000'000, 100'000, 100'000);
+        rects.push_back(rect);
+        ASSERT_EQ(index.insert(rect), compactIndex.insert(rect));
+        ASSERT_TRUE(compactIndex.contains(rect));
+    }
+    ASSERT_EQ(compactIndex.size(), index.size());
+    ASSERT_FALSE(compactIndex.contains({{100'000'001, 100'000'001}, 1, 1}));
+    test_util::compareQueries(index, compactIndex, 5'000, 100'000'000, 10'000'000, 10'000'000);
+    test_util::compareQueries(index, compactIndex, 1'000, 100'000'000, 1, 1);
+    // The windows covering the whole scaled cells and the ones bounded by the values themselves.
+    test_util::compareQueries(index, compactIndex, 100, 100'000'000, 100'000'000, 100'000'000);
+    for (const auto& rect : rects)
+    {
+        std::vector<key_type> result;
+        compactIndex.query(rect, std::back_inserter(result));
+        ASSERT_NE(std::ranges::find(result, rect), std::end(result));
+    }
+
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    compactIndex.save(stream);
+    const auto loadedIndex = space::QuadTree<key_type>::load(stream);
+    test_util::compareQueries(index, loadedIndex, 1'000, 100'000'000, 10'000'000, 10'000'000);
+}
+
+TEST(space_CompactQuadTree, CompactQuadTreeValueOutOfRegion)
+{
+    using key_type = space::Rect<int32_t>;
+    using layout_type = space::io::QuadTreeLayout<key_type>;
+
+    space::CompactQuadTree<key_type> index;
+    // The rect contains the center of the root region, so it is kept by the root.
+    index.insert({{10, 10}, 100, 100});
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    index.save(stream);
+    auto data = stream.str();
+    auto* bytes = reinterpret_cast<std::byte*>(data.data());
+    const auto trailer = layout_type::readTrailer(bytes + data.size() - layout_type::s_trailerSize);
+
+    // Moves the only value of the root far outside of the root region and restores the checksum.
+    const auto valueOffset = trailer.rootOffset - layout_type::s_keySize;
+    space::io::storeLittleEndian<int32_t>(bytes + valueOffset, 1'000'000'000);
+    space::io::Checksum checksum;
+    checksum.update(bytes, data.size() - sizeof(std::uint64_t));
+    space::io::storeLittleEndian<std::uint64_t>(bytes + data.size() - sizeof(std::uint64_t), checksum.value());
+
+    std::stringstream malformedStream {data, std::ios::in | std::ios::binary};
+    ASSERT_THROW(space::CompactQuadTree<key_type>::load(malformedStream), space::io::FormatError);
+}
+
+TEST(space_QuadTree, QuadTreeMemoryUsage)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+
+    space::QuadTree<key_type> index;
+    space::CompactQuadTree<key_type> compactIndex;
+    ASSERT_EQ(index.memoryUsage().total(), 0);
+    for (size_t i = 0; i < 10'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(10'000, 100, 100);
+        index.insert(rect);
+        compactIndex.insert(rect);
+    }
+
+    const auto usage = index.memoryUsage();
+    ASSERT_EQ(usage.valueBytes, index.size() * sizeof(key_type));
+    ASSERT_GT(usage.nodeBytes, 0);
+    ASSERT_EQ(usage.total(), usage.nodeBytes + usage.valueBytes + usage.slackBytes);
+    // The region of every node is smaller than 2^16, so all values are quantized without scaling.
+    ASSERT_EQ(compactIndex.memoryUsage().valueBytes * 2, usage.valueBytes);
+
+    index.clear();
+    ASSERT_EQ(index.memoryUsage().total(), 0);
+}
+
+TEST(space_QuadTree, QuadTreeStatistics)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+
+    space::QuadTree<key_type> index;
+    ASSERT_EQ(index.stats().nodeCount, 0);
+    index.insert({{0, 0}, 1'000, 1'000});
+    for (size_t i = 0; i < 2'000; ++i)
+    {
+        index.insert(test_util::getRandRect(1'000, 10, 10));
+    }
+
+    const auto stats = index.stats();
+    ASSERT_EQ(stats.valueCount, index.size());
+    ASSERT_GE(stats.rootValueCount, 1);
+    ASSERT_LE(stats.straddlingValueCount, stats.valueCount);
+    ASSERT_EQ(std::accumulate(std::begin(stats.depthHistogram), std::end(stats.depthHistogram), size_t {0})
+              , stats.nodeCount);
+    ASSERT_EQ(std::accumulate(std::begin(stats.valuesPerNodeHistogram), std::end(stats.valuesPerNodeHistogram)
+                              , size_t {0}), stats.nodeCount);
+    ASSERT_EQ(stats.valuesPerNodeHistogram[0], stats.emptyNodeCount);
+    ASSERT_GT(stats.averageFanOut, 0.0);
+    ASSERT_LE(stats.averageFanOut, 4.0);
+
+    std::stringstream svg;
+    index.writeSvg(svg);
+    const auto text = svg.str();
+    ASSERT_TRUE(text.starts_with("<svg"));
+    size_t rectCount = 0;
+    for (auto pos = text.find("<rect"); std::string::npos != pos; pos = text.find("<rect", pos + 1))
+    {
+        ++rectCount;
+    }
+    ASSERT_EQ(rectCount, stats.nodeCount);
+}
+
+TEST(space_QuadTree, QuadTreeQueryInstrumentation)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+    using instrumentation_type = space::CountingQueryInstrumentation;
+    using index_type = space::QuadTree<key_type, space::FlatNodeStorage<key_type>, instrumentation_type>;
+
+    index_type index;
+    std::vector<key_type> rects;
+    for (size_t i = 0; i < 1'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(1'000, 50, 50);
+        if (index.insert(rect))
+        {
+            rects.push_back(rect);
+        }
+    }
+
+    instrumentation_type::reset();
+    std::vector<key_type> result;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        index.query(test_util::getRandRect(1'000, 100, 100), std::back_inserter(result));
+    }
+    auto counters = instrumentation_type::threadCounters();
+    ASSERT_EQ(counters.queries, 100);
+    ASSERT_EQ(counters.valuesMatched, std::size(result));
+    ASSERT_GE(counters.valuesTested, counters.valuesMatched);
+    ASSERT_GT(counters.nodesPruned, 0);
+    ASSERT_GT(counters.nodesVisited, counters.nodesPruned);
+    ASSERT_GT(counters.stackHighWaterMark, 0);
+
+    // The whole tree is covered, so no value is tested.
+    instrumentation_type::reset();
+    result.clear();
+    index.query(key_type {{0, 0}, 10'000, 10'000}, std::back_inserter(result));
+    counters = instrumentation_type::threadCounters();
+    ASSERT_EQ(std::size(result), index.size());
+    ASSERT_EQ(counters.valuesMatched, index.size());
+    ASSERT_EQ(counters.valuesTested, 0);
+
+    instrumentation_type::reset();
+    std::thread thread {[&]()
+    {
+        for (const auto& rect : rects)
+        {
+            ASSERT_TRUE(index.contains(rect));
+        }
+    }};
+    thread.join();
+    ASSERT_TRUE(instrumentation_type::threadCounters() == space::QueryCounters {});
+    counters = instrumentation_type::totalCounters();
+    ASSERT_EQ(counters.queries, std::size(rects));
+    ASSERT_EQ(counters.valuesMatched, std::size(rects));
+    ASSERT_GE(counters.nodesVisited, std::size(rects));
+}
+
+TEST(space_QuadTree, QuadTreeContentBounds)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+    using instrumentation_type = space::CountingQueryInstrumentation;
+    using index_type = space::QuadTree<key_type, space::FlatNodeStorage<key_type>, instrumentation_type>;
+
+    index_type index;
+    for (size_t i = 0; i < 1'000; ++i)
+    {
+        index.insert(test_util::getRandRect(1'000, 50, 50));
+    }
+    const key_type farRect {{100'000, 100'000}, 1, 1};
+    const key_type emptyWindow {{50'000, 50'000}, 100, 100};
+    ASSERT_TRUE(index.insert(farRect));
+
+    // The window is inside the root region and bounds, but no node below contains values there.
+    instrumentation_type::reset();
+    std::vector<key_type> result;
+    index.query(emptyWindow, std::back_inserter(result));
+    ASSERT_TRUE(result.empty());
+    ASSERT_GT(instrumentation_type::threadCounters().nodesVisited, 1);
+
+    // The bounds shrink after the removing, so the window is pruned at the root.
+    index.remove(farRect);
+    instrumentation_type::reset();
+    index.query(emptyWindow, std::back_inserter(result));
+    ASSERT_TRUE(result.empty());
+    auto counters = instrumentation_type::threadCounters();
+    ASSERT_EQ(counters.nodesVisited, 1);
+    ASSERT_EQ(counters.nodesPruned, 1);
+
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    index.save(stream);
+    const auto loadedIndex = index_type::load(stream);
+    instrumentation_type::reset();
+    loadedIndex.query(emptyWindow, std::back_inserter(result));
+    ASSERT_TRUE(result.empty());
+    ASSERT_EQ(instrumentation_type::threadCounters().nodesVisited, 1);
+    test_util::compareQueries(index, loadedIndex, 1'000, 1'000, 100, 100);
+}
+
+TEST(space_QuadTree, QuadTreeCount)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+    using index_type = space::QuadTree<key_type>;
+
+    index_type index;
+    std::vector<key_type> rects;
+    for (size_t i = 0; i < 2'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(10'000, 100, 100);
+        if (index.insert(rect))
+        {
+            rects.push_back(rect);
+        }
+    }
+    for (size_t i = 0; i < std::size(rects); i += 3)
+    {
+        index.remove(rects[i]);
+    }
+
+    std::vector<key_type> result;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        const auto window = test_util::getRandRect(10'000, 3'000, 3'000);
+        result.clear();
+        index.query(window, std::back_inserter(result));
+        ASSERT_EQ(index.count(window), std::size(result));
+        ASSERT_GE(index.estimateCount(window, 0), 0.0);
+        ASSERT_DOUBLE_EQ(index.estimateCount(window, std::numeric_limits<std::size_t>::max())
+                         , static_cast<double>(std::size(result)));
+    }
+
+    const key_type everything {{0, 0}, 20'000, 20'000};
+    ASSERT_EQ(index.count(everything), index.size());
+    ASSERT_DOUBLE_EQ(index.estimateCount(everything, 0), static_cast<double>(index.size()));
+
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    index.save(stream);
+    ASSERT_EQ(index_type::load(stream).count(everything), index.size());
+    ASSERT_EQ(index_type {}.count(everything), 0);
+}
+
+TEST(space_QuadTree, QuadTreeSample)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+    using index_type = space::QuadTree<key_type>;
+
+    index_type index;
+    for (size_t i = 0; i < 5'000; ++i)
+    {
+        index.insert(test_util::getRandRect(10'000, 100, 100));
+    }
+    std::mt19937_64 engine {42};
+
+    const key_type window {{2'000, 2'000}, 5'000, 5'000};
+    std::vector<key_type> matches;
+    index.query(window, std::back_inserter(matches));
+    std::map<key_type, size_t> frequencies;
+    std::map<key_type, size_t> firstFrequencies;
+    constexpr size_t sampleSize = 10;
+    constexpr size_t runCount = 2'000;
+    for (size_t run = 0; run < runCount; ++run)
+    {
+        std::vector<key_type> samples;
+        ASSERT_EQ(index.sample(window, sampleSize, engine, std::back_inserter(samples)), sampleSize);
+        ASSERT_EQ(std::size(samples), sampleSize);
+        ASSERT_EQ(std::set<key_type>(std::begin(samples), std::end(samples)).size(), sampleSize);
+        for (const auto& value : samples)
+        {
+            ASSERT_TRUE(space::util::hasIntersect(window, value));
+            ++frequencies[value];
+        }
+        ++firstFrequencies[samples.front()];
+    }
+    // Every match is expected to be sampled about runCount * sampleSize / matches times.
+    const auto expected = static_cast<double>(runCount * sampleSize) / static_cast<double>(std::size(matches));
+    ASSERT_GT(std::size(frequencies), std::size(matches) * 9 / 10);
+    for (const auto&[value, frequency] : frequencies)
+    {
+        ASSERT_LT(static_cast<double>(frequency), expected + 6 * std::sqrt(expected) + 1);
+    }
+    // The order is random, so the first sample alone is uniform too.
+    const auto expectedFirst = static_cast<double>(runCount) / static_cast<double>(std::size(matches));
+    for (const auto&[value, frequency] : firstFrequencies)
+    {
+        ASSERT_LT(static_cast<double>(frequency), expectedFirst + 6 * std::sqrt(expectedFirst) + 1);
+    }
+
+    // Not enough matches, so all of them are reported.
+    const key_type smallWindow {{5'000, 5'000}, 200, 200};
+    matches.clear();
+    index.query(smallWindow, std::back_inserter(matches));
+    std::vector<key_type> samples;
+    ASSERT_EQ(index.sample(smallWindow, std::size(matches) + 5, engine, std::back_inserter(samples))
+              , std::size(matches));
+    std::ranges::sort(matches);
+    std::ranges::sort(samples);
+    ASSERT_EQ(samples, matches);
+
+    samples.clear();
+    ASSERT_EQ(index.sample(key_type {{20'000, 20'000}, 10, 10}, 5, engine, std::back_inserter(samples)), 0);
+    ASSERT_EQ(index.sample(window, 0, engine, std::back_inserter(samples)), 0);
+    ASSERT_EQ(index_type {}.sample(window, 5, engine, std::back_inserter(samples)), 0);
+    ASSERT_TRUE(samples.empty());
+}
+
+template <typename TMonoid>
+void aggregateTest()
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+    using index_type = space::AggregateQuadTree<key_type, int64_t, TMonoid>;
+
+    index_type index;
+    std::map<key_type, int64_t> values;
+    for (size_t i = 0; i < 2'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(10'000, 100, 100);
+        const auto value = static_cast<int64_t>(test_util::rand(-1'000, 1'000));
+        ASSERT_EQ(index.insert(rect, value), values.emplace(rect, value).second);
+    }
+    for (auto it = std::begin(values); it != std::end(values); )
+    {
+        ASSERT_TRUE(index.remove(it->first));
+        it = values.erase(it);
+        std::advance(it, std::min<std::ptrdiff_t>(2, std::distance(it, std::end(values))));
+    }
+    ASSERT_FALSE(index.remove(key_type {{20'000, 20'000}, 1, 1}));
+    ASSERT_EQ(index.size(), std::size(values));
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        const auto window = test_util::getRandRect(10'000, 3'000, 3'000);
+        auto expected = TMonoid::identity();
+        for (const auto&[rect, value] : values)
+        {
+            if (space::util::hasIntersect(window, rect))
+            {
+                expected = TMonoid::combine(expected, value);
+            }
+        }
+        ASSERT_EQ(index.aggregate(window), expected);
+    }
+
+    auto total = TMonoid::identity();
+    for (const auto&[rect, value] : values)
+    {
+        ASSERT_EQ(*index.find(rect), value);
+        total = TMonoid::combine(total, value);
+    }
+    ASSERT_EQ(index.total(), total);
+    ASSERT_EQ(index.aggregate(key_type {{0, 0}, 20'000, 20'000}), total);
+    ASSERT_EQ(index_type {}.aggregate(key_type {{0, 0}, 20'000, 20'000}), TMonoid::identity());
+}
+
+TEST(space_AggregateQuadTree, AggregateQuadTreeAggregate)
+{
+    aggregateTest<space::SumMonoid<int64_t>>();
+    aggregateTest<space::MinMonoid<int64_t>>();
+    aggregateTest<space::MaxMonoid<int64_t>>();
+}
+
+template <typename TIndex>
+void queryAllocationFreeTest()
+{
+    using key_type = typename TIndex::key_type;
+
+    TIndex index;
+    std::vector<key_type> rects;
+    std::size_t insertAllocations = 0;
+    for (size_t i = 0; i < 10'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(1'000'000, 1'000, 1'000);
+        const test_util::AllocationScope scope;
+        if (index.insert(rect))
+        {
+            rects.push_back(rect);
+        }
+        insertAllocations += scope.statistics().allocations;
+    }
+    // Checks the counting works, otherwise the check below proves nothing.
+    ASSERT_GT(insertAllocations, 0);
+
+    std::vector<key_type> result;
+    result.reserve(std::size(rects));
+    const test_util::AllocationScope scope;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        result.clear();
+        index.query(test_util::getRandRect(1'000'000, 100'000, 100'000), std::back_inserter(result));
+    }
+    for (const auto& rect : rects)
+    {
+        ASSERT_TRUE(index.contains(rect));
+    }
+    const auto statistics = scope.statistics();
+    ASSERT_EQ(statistics.allocations, 0);
+    ASSERT_EQ(statistics.peakBytes, 0);
+}
+
+TEST(space_QuadTree, QuadTreeLargeCoordinates)
+{
+    using key_type = space::Rect<int64_t>;
+    constexpr auto maxCoordinate = std::numeric_limits<int64_t>::max();
+
+    // The root region is grown up to the largest coordinate.
+    const std::vector<key_type> keys {{{int64_t {1} << 40, int64_t {1} << 40}, 10, 10}
+                                      , {{int64_t {1} << 61, 5}, 1'000, 1'000}
+                                      , {{maxCoordinate - 10, maxCoordinate - 10}, 10, 10}
+                                      , {{3, 3}, 0, 0}};
+    space::QuadTree<key_type> index;
+    space::AggregateQuadTree<key_type, int64_t> aggregateIndex;
+    for (const auto& key : keys)
+    {
+        ASSERT_TRUE(index.insert(key));
+        ASSERT_TRUE(aggregateIndex.insert(key, 1));
+    }
+    for (const auto& key : keys)
+    {
+        ASSERT_TRUE(index.contains(key));
+        ASSERT_TRUE(aggregateIndex.contains(key));
+    }
+    std::vector<key_type> result;
+    index.query({{0, 0}, maxCoordinate, maxCoordinate}, std::back_inserter(result));
+    ASSERT_EQ(std::size(result), std::size(keys));
+    ASSERT_EQ(aggregateIndex.aggregate({{0, 0}, maxCoordinate, maxCoordinate}), std::ssize(keys));
+
+    // The rejected key does not change the tree, even the empty one.
+    space::QuadTree<key_type> emptyIndex;
+    ASSERT_THROW(emptyIndex.insert({{-10, 0}, 1, 1}), std::out_of_range);
+    ASSERT_EQ(emptyIndex.stats().nodeCount, 0);
+    space::AggregateQuadTree<key_type, int64_t> emptyAggregateIndex;
+    ASSERT_THROW(emptyAggregateIndex.insert({{-10, 0}, 1, 1}, 1), std::out_of_range);
+    ASSERT_TRUE(emptyAggregateIndex.empty());
+    ASSERT_EQ(emptyAggregateIndex.aggregate({{0, 0}, maxCoordinate, maxCoordinate}), 0);
+
+    ASSERT_THROW(index.insert({{-10, 0}, 1, 1}), std::out_of_range);
+    ASSERT_THROW(aggregateIndex.insert({{-10, 0}, 1, 1}, 1), std::out_of_range);
+    ASSERT_EQ(index.size(), std::size(keys));
+    ASSERT_EQ(aggregateIndex.size(), std::size(keys));
+}
+
+TEST(space_QuadTree, QuadTreeQueryAllocationFree)
+{
+    queryAllocationFreeTest<space::QuadTree<space::Rect<int32_t>>>();
+    queryAllocationFreeTest<space::CompactQuadTree<space::Rect<int32_t>>>();
+}
+
+TEST(space_io, TraceRoundTrip)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+    using record_type = space::io::TraceRecord<key_type>;
+
+    space::QuadTree<key_type> index;
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    std::vector<std::pair<space::io::TraceOperation, key_type>> operations;
+    {
+        space::IndexRecorder recorder {index, stream};
+        std::vector<key_type> result;
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const auto rect = test_util::getRandRect(1'000, 100, 100);
+            recorder.insert(rect);
+            operations.emplace_back(space::io::TraceOperation::Insert, rect);
+            recorder.query(rect, std::back_inserter(result));
+            operations.emplace_back(space::io::TraceOperation::Query, rect);
+            ASSERT_TRUE(recorder.contains(rect));
+            operations.emplace_back(space::io::TraceOperation::Contains, rect);
+            if (0 == i % 2)
+            {
+                recorder.remove(rect);
+                operations.emplace_back(space::io::TraceOperation::Remove, rect);
+            }
+        }
+        recorder.flush();
+    }
+    const auto data = space::io::readAll(stream);
+
+    std::vector<record_type> records;
+    const auto count = space::io::forEachTraceRecord<key_type>(data, [&](const record_type& record)
+    {
+        records.push_back(record);
+    });
+    ASSERT_EQ(count, std::size(operations));
+    ASSERT_EQ(std::size(records), std::size(operations));
+    for (size_t i = 0; i < std::size(records); ++i)
+    {
+        ASSERT_EQ(records[i].operation, operations[i].first);
+        ASSERT_EQ(records[i].key, operations[i].second);
+        ASSERT_TRUE(0 == i || records[i - 1].timestamp <= records[i].timestamp);
+    }
+
+    auto noop = [](const auto&) {};
+    const space::collections::Span<const std::byte> truncated {data.data(), data.size() - 1};
+    ASSERT_THROW(space::io::forEachTraceRecord<key_type>(truncated, noop), space::io::FormatError);
+    ASSERT_EQ(space::io::forEachTraceRecord<key_type>(truncated, noop, true), std::size(operations) - 1);
+
+    auto corrupted = data;
+    corrupted[16] = std::byte {0x7F};
+    ASSERT_THROW(space::io::forEachTraceRecord<key_type>(corrupted, noop), space::io::FormatError);
+    ASSERT_THROW(space::io::forEachTraceRecord<space::Rect<int64_t>>(data, noop), space::io::FormatError);
+}
+
+TEST(space_MappedQuadTree, MappedQuadTreeQuery)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+
+    std::vector<key_type> rects;
+    space::QuadTree<key_type> index;
+    for (size_t i = 0; i < 5'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(100'000, 1'000, 1'000);
+        if (index.insert(rect))
+        {
+            rects.push_back(rect);
+        }
+    }
+    const auto path = std::filesystem::temp_directory_path() / "space_MappedQuadTreeQuery.qt";
+    index.save(path);
+
+    {
+        const space::MappedQuadTree<key_type> mappedIndex {path, true};
+        ASSERT_EQ(mappedIndex.size(), index.size());
+        ASSERT_FALSE(mappedIndex.empty());
+        for (const auto& rect : rects)
+        {
+            ASSERT_TRUE(mappedIndex.contains(rect));
+        }
+        ASSERT_FALSE(mappedIndex.contains({{100'001, 100'001}, 1, 1}));
+        test_util::compareQueries(index, mappedIndex, 5'000, 100'000, 1'000, 1'000);
+        test_util::nearestTest(mappedIndex, rects, 100'000, 10);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(space_MappedQuadTree, MappedQuadTreeEmpty)
+{
+    using key_type = space::Rect<int32_t>;
+
+    const auto path = std::filesystem::temp_directory_path() / "space_MappedQuadTreeEmpty.qt";
+    space::QuadTree<key_type> {}.save(path);
+    {
+        const space::MappedQuadTree<key_type> mappedIndex {path};
+        ASSERT_TRUE(mappedIndex.empty());
+        ASSERT_FALSE(mappedIndex.contains({{1, 1}, 1, 1}));
+        std::vector<key_type> result;
+        mappedIndex.query({{0, 0}, 100, 100}, std::back_inserter(result));
+        mappedIndex.nearest({0, 0}, 10, std::back_inserter(result));
+        ASSERT_TRUE(result.empty());
+    }
+    std::filesystem::remove(path);
+
+    ASSERT_THROW(space::MappedQuadTree<key_type> {path}, std::system_error);
+}
+
+template <template <typename> typename TIndex>
+void malformedChildOffsetTest(const std::string& fileName)
+{
+    using key_type = space::Rect<int32_t>;
+    using layout_type = space::io::QuadTreeLayout<key_type>;
+
+    space::QuadTree<key_type> index;
+    index.insert({{10, 10}, 1, 1});
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    index.save(stream);
+    const auto data = stream.str();
+    const auto trailer = layout_type::readTrailer(
+        reinterpret_cast<const std::byte*>(data.data() + data.size() - layout_type::s_trailerSize));
+
+    // The offset of the first child of the root.
+    const auto childPos = trailer.rootOffset + 3 * layout_type::s_coordinateSize;
+    const auto path = std::filesystem::temp_directory_path() / fileName;
+    for (const auto childOffset : {trailer.rootOffset, std::uint64_t {data.size() * 2}})
+    {
+        auto malformed = data;
+        space::io::storeLittleEndian<std::uint64_t>(reinterpret_cast<std::byte*>(malformed.data() + childPos), childOffset);
+        std::ofstream {path, std::ios::binary} << malformed;
+
+        const TIndex<key_type> fileIndex {path};
+        std::vector<key_type> result;
+        ASSERT_THROW(fileIndex.query({{0, 0}, 100, 100}, std::back_inserter(result)), space::io::FormatError);
+        ASSERT_THROW(static_cast<void>(fileIndex.contains({{10, 10}, 1, 1})), space::io::FormatError);
+        const space::Point<int32_t> point {0, 0};
+        if constexpr (requires { fileIndex.nearest(point, 1, std::back_inserter(result)); })
+        {
+            ASSERT_THROW(fileIndex.nearest(point, 1, std::back_inserter(result)), space::io::FormatError);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(space_MappedQuadTree, MappedQuadTreeMalformed)
+{
+    malformedChildOffsetTest<space::MappedQuadTree>("space_MappedQuadTreeMalformed.qt");
+}
+
+TEST(space_MappedQuadTree, MappedQuadTreeUnitRegionKeys)
+{
+    using key_type = space::Rect<int32_t>;
+
+    // The point is kept by the unit region {{3, 3}, 1} without touching its split lines.
+    const key_type unitRegionKey {{4, 4}, 0, 0};
+    space::QuadTree<key_type> index;
+    index.insert({{0, 0}, 3, 3});
+    index.insert(unitRegionKey);
+    ASSERT_TRUE(index.contains(unitRegionKey));
+
+    const auto path = std::filesystem::temp_directory_path() / "space_MappedQuadTreeUnitRegionKeys.qt";
+    index.save(path);
+    {
+        const space::MappedQuadTree<key_type> mappedIndex {path};
+        ASSERT_TRUE(mappedIndex.contains(unitRegionKey));
+        const space::PagedQuadTree<key_type> pagedIndex {path};
+        ASSERT_TRUE(pagedIndex.contains(unitRegionKey));
+    }
+    std::filesystem::remove(path);
+
+    index.remove(unitRegionKey);
+    ASSERT_FALSE(index.contains(unitRegionKey));
+    ASSERT_EQ(index.size(), 1);
+}
+
+TEST(space_PagedQuadTree, PagedQuadTreeQuery)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+
+    std::vector<key_type> rects;
+    space::QuadTree<key_type> index;
+    for (size_t i = 0; i < 5'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(100'000, 1'000, 1'000);
+        if (index.insert(rect))
+        {
+            rects.push_back(rect);
+        }
+    }
+    const auto path = std::filesystem::temp_directory_path() / "space_PagedQuadTreeQuery.qt";
+    index.save(path);
+
+    {
+        space::PagedQuadTree<key_type>::Config config;
+        config.pageSize = 4096;
+        config.maxResidentPages = 8;
+        const space::PagedQuadTree<key_type> pagedIndex {path, config};
+        ASSERT_EQ(pagedIndex.size(), index.size());
+        ASSERT_FALSE(pagedIndex.empty());
+        for (const auto& rect : rects)
+        {
+            ASSERT_TRUE(pagedIndex.contains(rect));
+        }
+        ASSERT_FALSE(pagedIndex.contains({{100'001, 100'001}, 1, 1}));
+        test_util::compareQueries(index, pagedIndex, 1'000, 100'000, 1'000, 1'000);
+
+        const auto& statistics = pagedIndex.cacheStatistics();
+        ASSERT_GT(statistics.hits, 0);
+        ASSERT_GT(statistics.misses, 0);
+        ASSERT_GT(statistics.evictions, 0);
+        ASSERT_LE(pagedIndex.residentPages(), config.maxResidentPages);
+    }
+    {
+        // The values cross the boundaries of the pages which size is not a multiple of the value size.
+        space::PagedQuadTree<key_type>::Config config;
+        config.pageSize = 100;
+        config.maxResidentPages = 8;
+        const space::PagedQuadTree<key_type> pagedIndex {path, config};
+        test_util::compareQueries(index, pagedIndex, 1'000, 100'000, 10'000, 10'000);
+    }
+    std::filesystem::remove(path);
+
+    ASSERT_THROW(space::PagedQuadTree<key_type> {path}, std::system_error);
+}
+
+TEST(space_PagedQuadTree, PagedQuadTreeMalformed)
+{
+    malformedChildOffsetTest<space::PagedQuadTree>("space_PagedQuadTreeMalformed.qt");
+}
+
+TEST(space_QuadTree, QuadTreeMalformedTopology)
+{
+    using key_type = space::Rect<int32_t>;
+    using layout_type = space::io::QuadTreeLayout<key_type>;
+
+    space::QuadTree<key_type> index;
+    index.insert({{10, 10}, 1, 1});
+    index.insert({{90, 90}, 1, 1});
+    std::stringstream stream {std::ios::in | std::ios::out | std::ios::binary};
+    index.save(stream);
+    const auto data = stream.str();
+    const auto* bytes = reinterpret_cast<const std::byte*>(data.data());
+    const auto trailer = layout_type::readTrailer(bytes + data.size() - layout_type::s_trailerSize);
+    const auto root = layout_type::readNodeFooter(bytes + trailer.rootOffset);
+
+    std::vector<std::size_t> childPositions;
+    for (std::size_t i = 0; i < std::size(root.children); ++i)
+    {
+        if (0 != root.children[i])
+        {
+            childPositions.push_back(i);
+        }
+    }
+    ASSERT_EQ(childPositions.size(), 2);
+    const auto first = root.children[childPositions[0]];
+    const auto second = root.children[childPositions[1]];
+
+    const auto childrenOffset = trailer.rootOffset + 3 * layout_type::s_coordinateSize;
+    const auto malform = [&](std::uint64_t offset, auto value)
+    {
+        auto malformed = data;
+        auto* malformedBytes = reinterpret_cast<std::byte*>(malformed.data());
+        space::io::storeLittleEndian(malformedBytes + offset, value);
+        space::io::Checksum checksum;
+        checksum.update(malformedBytes, malformed.size() - sizeof(std::uint64_t));
+        space::io::storeLittleEndian<std::uint64_t>(malformedBytes + malformed.size() - sizeof(std::uint64_t), checksum.value());
+        return malformed;
+    };
+    const std::vector<std::string> malformedFiles {
+        // Both children of the root point to the same node.
+        malform(childrenOffset + childPositions[1] * sizeof(std::uint64_t), first)
+        // The child region is not the quadrant of the root region.
+        , malform(first, int32_t {1})
+        // The value of the first child is placed at the second child.
+        , malform(first - layout_type::s_keySize, int32_t {90})
+        // The value of the second child is outside of the root region.
+        , malform(second - layout_type::s_keySize, int32_t {1'000'000'000})
+    };
+
+    const auto path = std::filesystem::temp_directory_path() / "space_QuadTreeMalformedTopology.qt";
+    for (const auto& malformed : malformedFiles)
+    {
+        std::stringstream malformedStream {malformed, std::ios::in | std::ios::binary};
+        ASSERT_THROW(space::QuadTree<key_type>::load(malformedStream), space::io::FormatError);
+
+        std::ofstream {path, std::ios::binary} << malformed;
+        const space::MappedQuadTree<key_type> mappedIndex {path};
+        const space::PagedQuadTree<key_type> pagedIndex {path};
+        std::vector<key_type> result;
+        ASSERT_THROW(mappedIndex.query({{0, 0}, 100, 100}, std::back_inserter(result)), space::io::FormatError);
+        ASSERT_THROW(pagedIndex.query({{0, 0}, 100, 100}, std::back_inserter(result)), space::io::FormatError);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(space_QuadTreeBuilder, QuadTreeBuilderExternalSort)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+
+    std::vector<key_type> rects;
+    space::QuadTree<key_type> index;
+    std::stringstream input {std::ios::in | std::ios::out | std::ios::binary};
+    for (size_t i = 0; i < 20'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(100'000, 1'000, 1'000);
+        if (index.insert(rect))
+        {
+            rects.push_back(rect);
+        }
+        std::array<std::byte, space::io::QuadTreeLayout<key_type>::s_keySize> buffer {};
+        space::io::QuadTreeLayout<key_type>::writeKey(buffer.data(), rect);
+        input.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+
+    size_t progressCalls = 0;
+    space::QuadTreeBuilder<key_type>::Config config;
+    config.memoryLimit = 64 << 10;
+    config.progressInterval = 1'000;
+    config.onProgress = [&progressCalls](const space::QuadTreeBuildStatistics&) { ++progressCalls; };
+    space::QuadTreeBuilder<key_type> builder {config};
+    builder.insert(input);
+
+    const auto path = std::filesystem::temp_directory_path() / "space_QuadTreeBuilderExternalSort.qt";
+    builder.finish(path);
+
+    const auto statistics = builder.statistics();
+    ASSERT_EQ(statistics.keysRead, 20'000);
+    ASSERT_EQ(statistics.keysMerged, index.size());
+    ASSERT_GT(statistics.runsSpilled, 1);
+    ASSERT_EQ(statistics.bytesWritten, std::filesystem::file_size(path));
+    ASSERT_GT(progressCalls, 0);
+
+    {
+        const space::MappedQuadTree<key_type> mappedIndex {path, true};
+        ASSERT_EQ(mappedIndex.size(), index.size());
+        for (const auto& rect : rects)
+        {
+            ASSERT_TRUE(mappedIndex.contains(rect));
+        }
+        test_util::compareQueries(index, mappedIndex, 2'000, 100'000, 1'000, 1'000);
+    }
+
+    const auto loadedIndex = space::QuadTree<key_type>::load(path);
+    test_util::compareQueries(index, loadedIndex, 2'000, 100'000, 1'000, 1'000);
+    std::filesystem::remove(path);
+}
+
+TEST(space_QuadTreeBuilder, QuadTreeBuilderInMemory)
+{
+    using value_type = int32_t;
+    using key_type = space::Rect<value_type>;
+
+    space::QuadTree<key_type> index;
+    space::QuadTreeBuilder<key_type> builder;
+    for (size_t i = 0; i < 5'000; ++i)
+    {
+        const auto rect = test_util::getRandRect(1'000, 10, 10);
+        index.insert(rect);
+        builder.insert(rect);
+    }
+    std::stringstream output {std::ios::in | std::ios::out | std::ios::binary};
+    builder.finish(output);
+    ASSERT_EQ(builder.statistics().runsSpilled, 0);
+
+    const auto loadedIndex = space::QuadTree<key_type>::load(output);
+    ASSERT_EQ(loadedIndex.size(), index.size());
+    test_util::compareQueries(index, loadedIndex, 2'000, 1'000, 10, 10);
+
+    ASSERT_THROW(builder.insert({{-1, 0}, 1, 1}), std::out_of_range);
+}
+
 
 int main(int argc, char **argv)
 {
@@ -9,6 +9,8 @@
 
 #include <thread>
 #include <future>
+#include <mutex>
+#include <execution>
 
 #include <gtest/gtest.h>
 
@@ -24,9 +26,13 @@
 #include "Rect.h"
 #include "Square.h"
 #include "SimplePolygon.h"
+#include "CompressedSimplePolygon.h"
 #include "Polygon.h"
 #include "Segment.h"
 #include "Utility.h"
+#include "RectJoin.h"
+#include "Wkb.h"
+#include "GeometryText.h"
 
 
 int rand(int from, int to)
@@ -720,6 +726,387 @@ TEST(space_Segment, hasIntersect_Segment)
     }
 }
 
+template <typename TCrt>
+std::vector<space::Rect<TCrt>> randomRects(size_t count, TCrt maxPos, TCrt maxSize)
+{
+    std::vector<space::Rect<TCrt>> rects;
+    rects.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        rects.push_back({{rand(0, maxPos), rand(0, maxPos)}, rand(0, maxSize), rand(0, maxSize)});
+    }
+    return rects;
+}
+
+template <typename TCrt>
+std::vector<std::pair<size_t, size_t>> bruteForceJoin(const std::vector<space::Rect<TCrt>>& first
+    , const std::vector<space::Rect<TCrt>>& second)
+{
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < first.size(); ++i)
+    {
+        for (size_t j = 0; j < second.size(); ++j)
+        {
+            if (space::util::hasIntersect(first[i], second[j]))
+            {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+    return pairs;
+}
+
+TEST(space_util, RectJoin)
+{
+    using TCrt = int32_t;
+    for (const auto maxSize : {1, 50, 1'000})
+    {
+        const auto first = randomRects<TCrt>(2'000, 10'000, maxSize);
+        const auto second = randomRects<TCrt>(3'000, 10'000, maxSize);
+
+        std::vector<std::pair<size_t, size_t>> pairs;
+        space::util::rectJoin(std::span {first}, std::span {second}
+            , [&](const space::Rect<TCrt>& lhs, const space::Rect<TCrt>& rhs)
+            {
+                pairs.emplace_back(std::addressof(lhs) - first.data(), std::addressof(rhs) - second.data());
+            });
+        std::ranges::sort(pairs);
+        ASSERT_EQ(pairs, bruteForceJoin(first, second));
+    }
+}
+
+TEST(space_util, RectJoinParallel)
+{
+    using TCrt = int32_t;
+    for (const auto maxSize : {1, 50, 5'000})
+    {
+        const auto first = randomRects<TCrt>(2'000, 10'000, maxSize);
+        const auto second = randomRects<TCrt>(3'000, 10'000, maxSize);
+
+        std::mutex mutex;
+        std::vector<std::pair<size_t, size_t>> pairs;
+        space::util::rectJoin(std::execution::par, std::span {first}, std::span {second}
+            , [&](const space::Rect<TCrt>& lhs, const space::Rect<TCrt>& rhs)
+            {
+                std::lock_guard lock {mutex};
+                pairs.emplace_back(std::addressof(lhs) - first.data(), std::addressof(rhs) - second.data());
+            });
+        std::ranges::sort(pairs);
+        ASSERT_EQ(pairs, bruteForceJoin(first, second));
+    }
+
+    const std::vector<space::Rect<TCrt>> empty;
+    const auto rects = randomRects<TCrt>(10, 100, 10);
+    size_t count = 0;
+    space::util::rectJoin(std::execution::par, std::span {empty}, std::span {rects}
+        , [&](const auto&, const auto&) { ++count; });
+    ASSERT_EQ(count, 0);
+}
+
+template <typename TCrt>
+space::SimplePolygon<TCrt> randomSimplePolygon(size_t numOfPoints, TCrt maxPos)
+{
+    std::vector<space::Point<TCrt>> curve;
+    for (size_t i = 0; i < numOfPoints; ++i)
+    {
+        curve.emplace_back(static_cast<TCrt>(rand(0, 1'000)), static_cast<TCrt>(rand(0, 1'000)));
+    }
+    space::util::move(curve.front(), maxPos, maxPos);
+    return space::SimplePolygon<TCrt> {std::move(curve)};
+}
+
+TEST(space_io, WkbRoundTrip)
+{
+    using TCrt = int32_t;
+
+    std::vector<std::byte> buffer;
+    const space::Point<TCrt> point {-7, 42};
+    const space::Segment<TCrt> segment {{1, 2}, {3, 4}};
+    const auto simplePolygon = randomSimplePolygon<TCrt>(10, 5);
+    const space::Polygon<TCrt> polygon {randomSimplePolygon<TCrt>(20, 0)
+        , {randomSimplePolygon<TCrt>(5, 1), randomSimplePolygon<TCrt>(7, 2)}};
+
+    space::io::writeWkb(point, buffer);
+    // byte order + type + x + y
+    ASSERT_EQ(buffer.size(), 21);
+    ASSERT_EQ(buffer[0], std::byte {1});
+    space::io::writeWkb(segment, buffer);
+    space::io::writeWkb(simplePolygon, buffer);
+    space::io::writeWkb(polygon, buffer);
+
+    std::span<const std::byte> data {buffer};
+    space::Point<TCrt> decodedPoint;
+    data = data.subspan(space::io::readWkb(data, decodedPoint));
+    ASSERT_EQ(decodedPoint, point);
+    space::Segment<TCrt> decodedSegment;
+    data = data.subspan(space::io::readWkb(data, decodedSegment));
+    ASSERT_EQ(decodedSegment, segment);
+    space::SimplePolygon<TCrt> decodedSimplePolygon;
+    data = data.subspan(space::io::readWkb(data, decodedSimplePolygon));
+    ASSERT_EQ(decodedSimplePolygon, simplePolygon);
+    space::Polygon<TCrt> decodedPolygon;
+    data = data.subspan(space::io::readWkb(data, decodedPolygon));
+    ASSERT_EQ(decodedPolygon, polygon);
+    ASSERT_TRUE(data.empty());
+
+    // The type mismatch.
+    ASSERT_THROW(space::io::readWkb(std::span {buffer}, decodedSegment), space::io::FormatError);
+}
+
+TEST(space_io, WkbBigEndian)
+{
+    // POINT (1 2) in big-endian byte order.
+    const std::vector<std::byte> record {
+        std::byte {0x00}, std::byte {0x00}, std::byte {0x00}, std::byte {0x00}, std::byte {0x01}
+        , std::byte {0x3f}, std::byte {0xf0}, std::byte {0x00}, std::byte {0x00}
+        , std::byte {0x00}, std::byte {0x00}, std::byte {0x00}, std::byte {0x00}
+        , std::byte {0x40}, std::byte {0x00}, std::byte {0x00}, std::byte {0x00}
+        , std::byte {0x00}, std::byte {0x00}, std::byte {0x00}, std::byte {0x00}};
+
+    space::Point<double> point;
+    ASSERT_EQ(space::io::readWkb(std::span {record}, point), record.size());
+    ASSERT_EQ(point.x(), 1.0);
+    ASSERT_EQ(point.y(), 2.0);
+
+    for (size_t size = 0; size < record.size(); ++size)
+    {
+        ASSERT_THROW(space::io::readWkb(std::span {record}.first(size), point), space::io::FormatError);
+    }
+}
+
+TEST(space_io, WkbBatch)
+{
+    using TCrt = double;
+
+    std::vector<space::Polygon<TCrt>> polygons;
+    std::vector<std::byte> buffer;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        std::vector<space::SimplePolygon<TCrt>> holes;
+        for (size_t j = 0; j < i % 4; ++j)
+        {
+            holes.push_back(randomSimplePolygon<TCrt>(3 + j, 1.5));
+        }
+        polygons.emplace_back(randomSimplePolygon<TCrt>(3 + i, 0.5), std::move(holes));
+        space::io::writeWkb(polygons.back(), buffer);
+    }
+
+    size_t index = 0;
+    const auto count = space::io::forEachWkb<space::Polygon<TCrt>>(std::span {buffer}
+        , [&](const space::Polygon<TCrt>& polygon)
+        {
+            ASSERT_EQ(polygon, polygons[index++]);
+        });
+    ASSERT_EQ(count, polygons.size());
+
+    buffer.pop_back();
+    ASSERT_THROW(space::io::forEachWkb<space::Polygon<TCrt>>(std::span {buffer}, [](const auto&) {})
+        , space::io::FormatError);
+}
+
+TEST(space_io, WktRead)
+{
+    using TCrt = int32_t;
+
+    space::Point<TCrt> point;
+    ASSERT_EQ(space::io::readWkt(" point(-3 +4) tail", point), 13);
+    ASSERT_EQ(point, (space::Point<TCrt> {-3, 4}));
+    ASSERT_NO_THROW(space::io::readWkt("POINT (1.6 2e1)", point));
+    ASSERT_EQ(point, (space::Point<TCrt> {2, 20}));
+
+    space::Rect<TCrt> rect;
+    space::io::readWkt("POLYGON ((0 0, 0 5, 10 5, 10 0, 0 0))", rect);
+    ASSERT_EQ(rect, (space::Rect<TCrt> {{0, 0}, 10, 5}));
+    ASSERT_THROW(space::io::readWkt("POLYGON ((0 0, 0 5, 10 6, 10 0, 0 0))", rect), space::io::FormatError);
+
+    space::SimplePolygon<TCrt> simplePolygon;
+    space::io::readWkt("POLYGON((0 0,0 5,5 5,0 0))", simplePolygon);
+    ASSERT_EQ(simplePolygon, (space::SimplePolygon<TCrt> {{{0, 0}, {0, 5}, {5, 5}}}));
+    space::io::readWkt("POLYGON EMPTY", simplePolygon);
+    ASSERT_TRUE(simplePolygon.empty());
+    ASSERT_THROW(space::io::readWkt("POLYGON ((0 0, 0 5, 5 5), (1 1, 1 2, 2 2))", simplePolygon)
+        , space::io::FormatError);
+
+    space::Polygon<TCrt> polygon;
+    space::io::readWkt("POLYGON ((0 0, 0 9, 9 9, 9 0, 0 0), (1 1, 1 2, 2 2, 1 1))", polygon);
+    ASSERT_EQ(polygon, (space::Polygon<TCrt> {space::SimplePolygon<TCrt> {{{0, 0}, {0, 9}, {9, 9}, {9, 0}}}
+        , {space::SimplePolygon<TCrt> {{{1, 1}, {1, 2}, {2, 2}}}}}));
+
+    for (const auto* text : {"POINT (1)", "POINT (1 2", "POINTS (1 2)", "POINT (a 2)", "POINT (1e20 2)"})
+    {
+        ASSERT_THROW(space::io::readWkt(text, point), space::io::FormatError) << text;
+    }
+
+    // The largest int64 is rounded up to 2^63 as double, which is out of range.
+    space::Point<int64_t> largePoint;
+    ASSERT_THROW(space::io::readWkt("POINT (9223372036854775808.0 0)", largePoint), space::io::FormatError);
+    ASSERT_THROW(space::io::readWkt("POINT (0 -9223372036854777856.0)", largePoint), space::io::FormatError);
+    space::io::readWkt("POINT (9223372036854774784.0 -9223372036854775808.0)", largePoint);
+    ASSERT_EQ(largePoint, (space::Point<int64_t> {9223372036854774784, std::numeric_limits<int64_t>::min()}));
+}
+
+TEST(space_io, GeoJsonRead)
+{
+    using TCrt = double;
+
+    space::Point<TCrt> point;
+    space::io::readGeoJson(R"({"coordinates": [1.5, -2, 100], "bbox": [0, {"a": "\\"}], "type": "Point"})", point);
+    ASSERT_EQ(point.x(), 1.5);
+    ASSERT_EQ(point.y(), -2.0);
+    ASSERT_THROW(space::io::readGeoJson(R"({"type": "Polygon", "coordinates": [1, 2]})", point)
+        , space::io::FormatError);
+    ASSERT_THROW(space::io::readGeoJson(R"({"type": "Point"})", point), space::io::FormatError);
+
+    // The skipped members are nested too deep.
+    const auto nested = R"({"x": )" + std::string(100'000, '[') + R"(, "type": "Point", "coordinates": [1, 2]})";
+    ASSERT_THROW(space::io::readGeoJson(nested, point), space::io::FormatError);
+    const auto shallow = R"({"x": )" + std::string(100, '[') + std::string(100, ']')
+                         + R"(, "type": "Point", "coordinates": [1, 2]})";
+    space::io::readGeoJson(shallow, point);
+    ASSERT_EQ(point.y(), 2.0);
+
+    space::Polygon<TCrt> polygon;
+    space::io::readGeoJson(R"({"type": "Polygon", "coordinates": [[[0, 0], [0, 9], [9, 9], [0, 0]], [[1, 1], [1, 2], [2, 2]]]})"
+        , polygon);
+    ASSERT_EQ(polygon.boundary().boundaryCurve().size(), 3);
+    ASSERT_EQ(polygon.holes().size(), 1);
+    ASSERT_EQ(polygon.holes()[0].boundaryCurve().size(), 3);
+
+    space::Rect<int32_t> rect;
+    space::io::readGeoJson(R"({"type":"Polygon","coordinates":[[[0,0],[10,0],[10,5],[0,5],[0,0]]]})", rect);
+    ASSERT_EQ(rect, (space::Rect<int32_t> {{0, 0}, 10, 5}));
+}
+
+TEST(space_io, TextRoundTrip)
+{
+    using TCrt = int32_t;
+
+    const space::Point<TCrt> point {-7, 42};
+    const space::Rect<TCrt> rect {{1, 2}, 3, 4};
+    const auto simplePolygon = randomSimplePolygon<TCrt>(10, 5);
+    const space::Polygon<TCrt> polygon {randomSimplePolygon<TCrt>(20, 0)
+        , {randomSimplePolygon<TCrt>(5, 1), randomSimplePolygon<TCrt>(7, 2)}};
+
+    std::string text;
+    space::io::writeWkt(point, text);
+    ASSERT_EQ(text, "POINT (-7 42)");
+    text.clear();
+    space::io::writeGeoJson(point, text);
+    ASSERT_EQ(text, R"({"type":"Point","coordinates":[-7,42]})");
+
+    auto roundTrip = [](const auto& geometry)
+    {
+        std::remove_cvref_t<decltype(geometry)> decoded;
+        std::string wkt;
+        space::io::writeWkt(geometry, wkt);
+        ASSERT_EQ(space::io::readWkt(wkt, decoded), wkt.size());
+        ASSERT_EQ(decoded, geometry) << wkt;
+
+        std::string geoJson;
+        space::io::writeGeoJson(geometry, geoJson);
+        ASSERT_EQ(space::io::readGeoJson(geoJson, decoded), geoJson.size());
+        ASSERT_EQ(decoded, geometry) << geoJson;
+    };
+    roundTrip(point);
+    roundTrip(rect);
+    roundTrip(simplePolygon);
+    roundTrip(polygon);
+    roundTrip(space::Point<double> {0.1, -1e-300});
+    roundTrip(space::SimplePolygon<TCrt> {});
+
+    // The empty rings are accepted by the readers, so the writers keep them.
+    space::Polygon<TCrt> emptyRingPolygon;
+    ASSERT_GT(space::io::readGeoJson(R"({"type":"Polygon","coordinates":[[]]})", emptyRingPolygon), 0);
+    roundTrip(emptyRingPolygon);
+    text.clear();
+    space::io::writeWkt(emptyRingPolygon, text);
+    ASSERT_EQ(text, "POLYGON (EMPTY)");
+    roundTrip(space::Polygon<TCrt> {randomSimplePolygon<TCrt>(20, 0), {space::SimplePolygon<TCrt> {}}});
+}
+
+TEST(space_CompressedSimplePolygon, RoundTrip)
+{
+    using TCrt = int32_t;
+
+    ASSERT_TRUE(space::CompressedSimplePolygon<TCrt> {space::SimplePolygon<TCrt> {}}.empty());
+    ASSERT_THROW(space::util::boundaryBoxOf(space::CompressedSimplePolygon<TCrt> {}), std::out_of_range);
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        const auto poly = randomSimplePolygon<TCrt>(3 + i, static_cast<TCrt>(rand(-1'000'000, 1'000'000)));
+        const space::CompressedSimplePolygon<TCrt> compressed {poly};
+        ASSERT_EQ(compressed.size(), poly.boundaryCurve().size());
+        ASSERT_EQ(compressed.toSimplePolygon(), poly);
+        ASSERT_TRUE(std::ranges::equal(compressed, poly.boundaryCurve()));
+    }
+
+    const space::SimplePolygon<int64_t> extremes {{{std::numeric_limits<int64_t>::min(), 0}
+        , {std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()}, {-1, 1}}};
+    ASSERT_EQ(space::CompressedSimplePolygon<int64_t> {extremes}.toSimplePolygon(), extremes);
+
+    // The close vertices take the control byte and one byte per coordinate.
+    std::vector<space::Point<TCrt>> curve;
+    for (TCrt i = 0; i < 1'000; ++i)
+    {
+        curve.emplace_back(1'000'000 + i, 1'000'000 - (i % 7));
+    }
+    const space::CompressedSimplePolygon<TCrt> compressed {space::SimplePolygon<TCrt> {curve}};
+    ASSERT_LE(compressed.bytes().size(), 3 * curve.size() + 8);
+
+    // The last vertices with the zero deltas are decoded from the padding only.
+    const space::SimplePolygon<TCrt> square {{{0, 0}, {10, 0}, {10, 10}, {0, 10}}};
+    ASSERT_EQ(space::CompressedSimplePolygon<TCrt> {square}.toSimplePolygon(), square);
+    const space::SimplePolygon<TCrt> repeated {{{0, 0}, {0, 0}, {10, 0}, {10, 10}, {10, 10}, {0, 10}, {0, 10}}};
+    ASSERT_EQ(space::CompressedSimplePolygon<TCrt> {repeated}.toSimplePolygon(), repeated);
+    const space::SimplePolygon<TCrt> origin {{{0, 0}, {0, 0}, {0, 0}}};
+    ASSERT_EQ(space::CompressedSimplePolygon<TCrt> {origin}.toSimplePolygon(), origin);
+}
+
+TEST(space_CompressedSimplePolygon, ContainsAndBoundaryBox)
+{
+    using TCrt = int32_t;
+
+    for (size_t i = 0; i < 50; ++i)
+    {
+        const auto poly = randomSimplePolygon<TCrt>(3 + i % 10, 0);
+        const space::CompressedSimplePolygon<TCrt> compressed {poly};
+
+        const auto bbox = space::util::boundaryBoxOf(compressed);
+        for (const auto& point : poly.boundaryCurve())
+        {
+            ASSERT_TRUE(space::util::contains(bbox, point));
+        }
+        for (size_t j = 0; j < 100; ++j)
+        {
+            const space::Point<TCrt> point {rand(0, 1'000), rand(0, 1'000)};
+            ASSERT_EQ(space::util::contains(compressed, point), space::util::contains(poly, point));
+        }
+    }
+
+    // The axis-aligned polygons have the zero deltas, including the last vertex.
+    const std::vector<space::SimplePolygon<TCrt>> alignedPolygons {
+        space::SimplePolygon<TCrt> {{{0, 0}, {10, 0}, {10, 10}, {0, 10}}}
+        , space::SimplePolygon<TCrt> {{{0, 0}, {0, 0}, {10, 0}, {10, 10}, {10, 10}, {0, 10}, {0, 10}}}
+        , space::SimplePolygon<TCrt> {{{0, 0}, {20, 0}, {20, 10}, {10, 10}, {10, 20}, {0, 20}}}};
+    for (const auto& poly : alignedPolygons)
+    {
+        const space::CompressedSimplePolygon<TCrt> compressed {poly};
+        const auto bbox = space::util::boundaryBoxOf(compressed);
+        ASSERT_TRUE(std::ranges::all_of(poly.boundaryCurve(), [&bbox](const auto& point)
+        {
+            return space::util::contains(bbox, point);
+        }));
+        for (TCrt x = -1; x <= 21; ++x)
+        {
+            for (TCrt y = -1; y <= 21; ++y)
+            {
+                ASSERT_EQ(space::util::contains(compressed, space::Point<TCrt> {x, y})
+                          , space::util::contains(poly, space::Point<TCrt> {x, y}));
+            }
+        }
+    }
+}
+
 
 int main(int argc, char **argv)
 {